@@ -1,5 +1,9 @@
 #include "GameClient.h"
+#include "MessageFrame.h"
 #include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
 
 namespace DashLine {
@@ -37,10 +41,16 @@ namespace Json {
  * The constructor calls the StartClient() function to initialize the client socket.
  * If the socket creation fails, a std::runtime_error is thrown.
  *
+ * @param protocol        The protocol to ask the server for once connected.
+ * @param is_spectator    True to watch a game instead of playing one.
+ * @param watched_game_id The game to watch, or WireProtocol::LATEST_GAME for the game started last.
+ *
  * @throws std:runtime_error if there is an errorf creating the client socket.
  * ---------------------------------------------------------------------------------
  */
-GameClient::GameClient() {
+GameClient::GameClient(WireProtocol::Protocol protocol, bool is_spectator, uint32_t watched_game_id)
+    : protocol(protocol), letter('O'), is_spectator(is_spectator), watched_game_id(watched_game_id),
+      is_rejoining(false), seat_game_id(0), seat_token(0) {
   if (StartClient() != 0) {
     throw std::runtime_error("Error! Creating a client socket");
   }
@@ -79,7 +89,8 @@ int GameClient::StartClient() {
  *
  * This function configures and establishes a connection to the specified game server.
  * It sets up the server address and port, converts the IP address string to a struct,
- * and then initiates a connection using the created client socket.
+ * and then initiates a connection using the created client socket. Once connected,
+ * it sends the hello that names the protocol of the connection.
  *
  * @throws std::runtime_error if there is an error converting the IP address string
  *                            into the struct in_addr or if there is an error connecting
@@ -99,37 +110,94 @@ int GameClient::StartConnection() {
     throw std::runtime_error("Error! Connecting to server");
   }
   std::cout << "Connected to the server." << std::endl;
+  SendHello();
   
   return EXIT_SUCCESS;
 }
 
+/* -----------------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: SendHello
+ * -----------------------------------------------------------------------------------------------------------
+ * @brief Send the hello that names the protocol of every following message, and the game to watch for a
+ *        spectator or the seat to take back for a rejoining player.
+ * -----------------------------------------------------------------------------------------------------------
+ */
+void GameClient::SendHello() {
+  if (is_rejoining) {
+    std::string hello;
+    WireProtocol::AppendRejoinHello(hello, protocol, seat_game_id, seat_token);
+    SendFrame(hello);
+    return;
+  }
+  if (is_spectator) {
+    std::string hello;
+    WireProtocol::AppendWatchHello(hello, protocol, watched_game_id);
+    SendFrame(hello);
+    return;
+  }
+  SendFrame(std::string(1, static_cast<char>(protocol)));
+}
+
 /* -----------------------------------------------------------------------------------------------------------
  * FUNCTION NAME: SendData
  * -----------------------------------------------------------------------------------------------------------
- * @brief Send an serialized JSON-formatted string to the connected server through the specified socket.
+ * @brief Send a move to the connected server through the specified socket.
  *
  * This function is responsible for sending data to the server, which is expected to be a
- * serialized JSON-formatted string containing information such as row and column numbers.
+ * move, encoded in the protocol of the connection, containing the row and column numbers.
  *
- * @details The function uses the provided socket to send a serialized JSON-formatted string
- *          to the server. If an error occurs during the sending process, a
- *          std::runtime error is thrown.
+ * @details With the JSON protocol the move is a serialized JSON-formatted string whose row and
+ *          column numbers are converted to Network-Byte-Order; the CBOR and MessagePack protocols
+ *          encode the same object in their own format. With the binary protocol it is the single
+ *          byte index of the spot. The move is sent by SendFrame.
  *
- * @param client_move Pointer to an integer array that will be included in the JSON string.
+ * @param row    The 1-based row number of the move.
+ * @param column The 1-based column number of the move.
  *
  * @throws std::runtime_error if an error occurs during data reception.
  *
  * @return No explicit return value.
  * -----------------------------------------------------------------------------------------------------------
  */
-void GameClient::SendData(int *client_move) {
-  Json::json_data["row"]      = client_move[0];
-  Json::json_data["column"]   = client_move[1];
-  std::string serialized_data = Json::json_data.dump();
-  size_t serialized_data_size = serialized_data.size();
-  ssize_t data_bytes_sent     = send(client_socket, serialized_data.c_str(), serialized_data_size ,0);
-  if (data_bytes_sent == -1) {
-    throw std::runtime_error("Error! Sending row and column number of bytes.");
+void GameClient::SendData(const int row, const int column) {
+  std::string serialized_data;
+  if (protocol == WireProtocol::BINARY) {
+    WireProtocol::AppendMove(serialized_data, row, column);
+  } else {
+    // A fresh object, so no keys of the last reply in Json::json_data leak into the move.
+    nlohmann::json move_data;
+    move_data["row"]    = htons(row);     // Convert Host-Byte-Order to Network-Byte-Order
+    move_data["column"] = htons(column);  // Convert Host-Byte-Order to Network-Byte-Order
+    if (protocol == WireProtocol::CBOR) {
+      nlohmann::json::to_cbor(move_data, serialized_data);
+    } else if (protocol == WireProtocol::MSGPACK) {
+      nlohmann::json::to_msgpack(move_data, serialized_data);
+    } else {
+      serialized_data = move_data.dump();
+    }
+  }
+  SendFrame(serialized_data);
+}
+
+/* -----------------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: SendFrame
+ * -----------------------------------------------------------------------------------------------------------
+ * @brief Send a payload to the connected server as a single length-prefixed frame.
+ *
+ * @throws std::runtime_error if an error occurs during sending.
+ * -----------------------------------------------------------------------------------------------------------
+ */
+void GameClient::SendFrame(const std::string& payload) {
+  std::string framed_data;
+  MessageFrame::AppendFrame(framed_data, payload.data(), payload.size());
+  size_t data_bytes_total = 0;
+  while (data_bytes_total < framed_data.size()) {
+    ssize_t data_bytes_sent = send(client_socket, framed_data.data() + data_bytes_total,
+                                   framed_data.size() - data_bytes_total, MSG_NOSIGNAL);
+    if (data_bytes_sent == -1) {
+      throw std::runtime_error("Error! Sending row and column number of bytes.");
+    }
+    data_bytes_total += data_bytes_sent;
   }
 }
 
@@ -143,73 +211,127 @@ void GameClient::SendData(int *client_move) {
  * where the winning message and game board are stored in a JSON oject.
  *
  * @details The function uses the nlohmann json library to parse the combined
- *          data, which is assumed to be a JSON-formatted string. The JSON object
+ *          data, which is assumed to be a JSON-formatted string, or the CBOR or
+ *          MessagePack encoding of it, in the protocol of the connection. The JSON object
  *          is expected to have "status_message" and "game_board" fields. The
- *          winning message and game board are then extracted from the JSON object and
- *          copied to the provided buffers.
+ *          status message is looked up once, here, to get its Reply; the rest of the
+ *          client only deals with the Reply. A seat message has "game_id" and
+ *          "seat_token" fields instead of the board, read into the client's seat.
  *
  * @param received_data The combined data containing winning informaion in JSON format.
- * @param status_messages Buffer to store the winning message.
- * @param status_messages_size Size of the status_message buffer.
- * @param game_board_buffer Buffer to store the game board informaion.
- * @parma game_board_size Size of the game_board_buffer.
+ * @param received_data_size The size of the combined data (in bytes).
+ * @param reply Receives the Reply named by the status message.
+ * @param game_board Receives the displayed game board.
+ *
+ * @return True if the data is a reply with a known status message, false otherwise.
  *
  * @note The winning message and game board are expected to be stored in a JSON object.
  *       The function uses the nlohmann json library to parse the JSON-formatted string
  *       and extracts the neccessary informaion.
  * ------------------------------------------------------------------------------------
  */
-void GameClient::ParseWinningInformation(char* received_data, char* status_messages,
-                                         size_t status_messages_size, char* game_board_buffer,
-                                         size_t game_board_size) {
+bool GameClient::ParseWinningInformation(const char* received_data, size_t received_data_size,
+                                         WireProtocol::Reply& reply, std::string& game_board) {
   try {
-    Json::json_data = nlohmann::json::parse(received_data);
-    std::string status_message  = Json::json_data["status_message"];
-    std::string game_board      = Json::json_data["game_board"];
-    strncpy(status_messages, status_message.c_str(), status_messages_size);
-    strncpy(game_board_buffer, game_board.c_str(), game_board_size);
+    if (protocol == WireProtocol::CBOR) {
+      Json::json_data = nlohmann::json::from_cbor(received_data, received_data + received_data_size);
+    } else if (protocol == WireProtocol::MSGPACK) {
+      Json::json_data = nlohmann::json::from_msgpack(received_data, received_data + received_data_size);
+    } else {
+      Json::json_data = nlohmann::json::parse(received_data, received_data + received_data_size);
+    }
+    std::string status_message = Json::json_data["status_message"];
+    if (!WireProtocol::FindReply(status_message.c_str(), reply)) {
+      return false;
+    }
+    if (reply == WireProtocol::SEAT) {
+      std::string token_digits = Json::json_data["seat_token"];
+      seat_game_id             = Json::json_data["game_id"];
+      seat_token               = strtoull(token_digits.c_str(), nullptr, 16);
+      return true;
+    }
+    game_board = Json::json_data["game_board"];
+    return true;
   } catch (const std::exception &e) {
     std::cerr << "Error parsing JSON: " << e.what() << std::endl;
   }
+  
+  return false;
 }
 
 /* ------------------------------------------------------------------------------------------------
  * FUNCTION NAME: ReceiveData
  * ------------------------------------------------------------------------------------------------
- * @brief Receive a JSON-formatted message from the connected server through the specified socket.
+ * @brief Receive a message from the connected server through the specified socket.
  *
- * This function is responsible for receiving a JSON-formatted message from the server, which can include
+ * This function is responsible for receiving a message from the server, which can include
  * game board updates and various status messages.
  *
  * @details The function uses the provided socket to receive the specified message from the server.
- *          The receive data is expected to be in a JSON format, combining both status messages and
- *          game board updates. The function then utilizes the ParseWinningInformation function to
- *          extract the winning information from the received JSON-formatted string. If an error occurs
- *          during the reception process or parsing process, a std::runtime error is thrown.
- *
- * @param status_messages Buffer to store the received status message.
- * @param status_messages_size Size of the status_messages buffer.
- * @param game_board_buffer Buffer to store the received game board information.
- * @param game_board_size Size of the game_board_buffer.
+ *          Received bytes are collected in the inbound buffer until it holds a complete length-prefixed
+ *          frame; bytes of a following frame stay in the buffer for the next call, so messages that
+ *          arrive together are still read one at a time. With the JSON, CBOR and MessagePack protocols the
+ *          frame combines both status messages and game board updates, and the function utilizes the
+ *          ParseWinningInformation function to extract the winning information from it. With the binary
+ *          protocol the frame is a reply code and a packed game board, which is turned back into the
+ *          displayed game board. A seat message is printed, with how to take the seat back, and the
+ *          next message is received in its place. If an error occurs during the reception process or
+ *          parsing process, or the server disconnects, a std::runtime error is thrown.
+ *
+ * @param game_board Receives the displayed game board.
  *
  * @throws std::runtime_error if an error occurs during the reception process.
  *
- * @return No explicit return value.
+ * @return The reply of the server.
  *
  * @note This function complements the ParseWinningInformation function document above.
  * ------------------------------------------------------------------------------------------------
  */
-void GameClient::ReceiveData(char* status_messages, size_t status_messages_size,
-                             char* game_board_buffer, size_t game_board_size) {
-  // Receive the combined data
-  char received_data[512];
-  ssize_t data_bytes_read = recv(client_socket, received_data, sizeof(received_data), 0);
-  if (data_bytes_read == -1) {
-    throw std::runtime_error("Error! Receiving data from Server");
+WireProtocol::Reply GameClient::ReceiveData(std::string& game_board) {
+  while (1) {
+    // Receive the combined data
+    size_t offset = 0;
+    const char* payload;
+    size_t payload_size;
+    while (!MessageFrame::NextFrame(inbound, offset, payload, payload_size)) {
+      char received_data[512];
+      ssize_t data_bytes_read = recv(client_socket, received_data, sizeof(received_data), 0);
+      if (data_bytes_read == -1) {
+        throw std::runtime_error("Error! Receiving data from Server");
+      }
+      if (data_bytes_read == 0) {
+        throw std::runtime_error("Error! Server disconnected.");
+      }
+      inbound.append(received_data, data_bytes_read);
+    }
+    WireProtocol::Reply reply;
+    bool is_parsed;
+    if (protocol == WireProtocol::BINARY) {
+      uint32_t packed_board;
+      if (WireProtocol::ParseSeat(payload, payload_size, seat_game_id, seat_token)) {
+        reply     = WireProtocol::SEAT;
+        is_parsed = true;
+      } else {
+        is_parsed = WireProtocol::ParseReply(payload, payload_size, reply, packed_board);
+        if (is_parsed) {
+          game_board = WireProtocol::UnpackBoard(packed_board);
+        }
+      }
+    } else {
+      is_parsed = ParseWinningInformation(payload, payload_size, reply, game_board);
+    }
+    inbound.erase(0, offset);
+    if (!is_parsed) {
+      throw std::runtime_error("Error! Parsing reply from Server.");
+    }
+    if (reply != WireProtocol::SEAT) {
+      return reply;
+    }
+    char token_digits[17];
+    snprintf(token_digits, sizeof(token_digits), "%016llx", static_cast<unsigned long long>(seat_token));
+    std::cout << WireProtocol::ReplyMessage(reply) << " game " << seat_game_id << ". If the server goes down, "
+              << "rejoin it with --rejoin " << seat_game_id << " " << token_digits << std::endl;
   }
-  received_data[data_bytes_read] = '\0';
-  ParseWinningInformation(received_data, status_messages, status_messages_size,
-                          game_board_buffer, game_board_size);
 }
 
 /* ---------------------------------------------------------------------------------------
@@ -229,28 +351,35 @@ void GameClient::ReceiveData(char* status_messages, size_t status_messages_size,
  *
  *          If none of the above conditions are met, the serialized updated game board
  *          is receive from the server, and control is given to the client to make a move.
+ *          That includes the start of a game against another client in which the client
+ *          plays X, when there is no move to receive yet.
  *
  * @return True if the game is over (either server won or tied), false otherwise.
  * ---------------------------------------------------------------------------------------
 */
 bool GameClient::IsServerMove() {
-  while (1) {
-    char server_data[256];
-    char game_board[256];
-    ReceiveData(server_data, sizeof(server_data), game_board, sizeof(game_board));
-    if (strcmp(server_data, "Server won") == 0 ||
-        strcmp(server_data, "TIE GAME")   == 0)
-    {
+  std::string game_board;
+  WireProtocol::Reply reply = ReceiveData(game_board);
+  switch (reply) {
+    case WireProtocol::PLAYING_X:
+      letter = 'X';
+      std::cout << WireProtocol::ReplyMessage(reply) << std::endl;
+      std::cout << game_board;
+      break;
+    case WireProtocol::SERVER_WON:
+    case WireProtocol::CLIENT_WON:    // The opponent left the game, or ran out of time.
+    case WireProtocol::TIE_GAME:
+    case WireProtocol::OUT_OF_TIME:
       DashLines();
       std::cout << game_board;
-      std::cout << server_data << std::endl;
+      std::cout << WireProtocol::ReplyMessage(reply) << std::endl;
       DashLines();
       return true;
-    }
-    std::cout << server_data << std::endl;
-    std::cout << game_board;
-    break;
-  }              // End of Server Move.
+    default:
+      std::cout << WireProtocol::ReplyMessage(reply) << std::endl;
+      std::cout << game_board;
+      break;
+  }               // End of Server Move.
   
   return false; // Winner was not declared.
 }
@@ -260,8 +389,8 @@ bool GameClient::IsServerMove() {
  * -----------------------------------------------------------------------------------------
  * @brief Process a move, and send to Server.
  *
- * This function send an integer array representing a move from the client.
- * consisting of two integers representing the row and column. After sending data
+ * This function send a move from the client, consisting of two integers
+ * representing the row and column. After sending data
  * server will validates whether the client's chosen location is available and checks
  * if the client is the winner.
  *
@@ -276,49 +405,110 @@ bool GameClient::IsServerMove() {
  *          If the client is the winner, a game-winning message is received from the server,
  *          the program terminates.
  *
- * @return True if the game is over (client won), false otherwise.
+ * @return True if the game is over (client won, or ran out of time), false otherwise.
  * -----------------------------------------------------------------------------------------
  */
 bool GameClient::IsClientMove() {
   while (1) {
-    prompting.PlayerTurn('O');
+    prompting.PlayerTurn(letter);
     prompting.UserForRowNumber();
     int row_number_to_send      = 0;
     row_number_to_send          = response_manager.GetValidatedUserInput(row_number_to_send, 1, 3, 'R');
-    int converted_row_number    = htons(row_number_to_send);      // Convert Host-Byte-Order to Network-Byte-Order
     prompting.UserForColumnNumber();
     int column_number_to_send   = 0;
     column_number_to_send       = response_manager.GetValidatedUserInput(column_number_to_send, 1, 3, 'C');
-    int converted_column_number = htons(column_number_to_send);  // Convert Host-Byte-Order to Network-Byte-Order
-    int client_move[2]          = { converted_row_number, converted_column_number };
-    SendData(client_move);
+    SendData(row_number_to_send, column_number_to_send);
     // Successfully send row and column intergers to server.
     
     // Receive a status message from Server:
-    char status_message[256];
-    char game_board[256];
-    ReceiveData(status_message, sizeof(status_message), game_board, sizeof(game_board));
-    if (strcmp(status_message,"Spot unavailable. Please try again.") == 0) {
-      std::cerr << status_message << std::endl;
-      std::cout << game_board;
-      continue;                                       // Go back to the user input process.
-    } else if (strcmp(status_message, "You win") == 0) {
-      // Receive The winning game board.
-      DashLines();
-      std::cout << game_board;
-      std::cout << status_message << std::endl;
-      DashLines();
-      return true;
+    std::string game_board;
+    WireProtocol::Reply reply = ReceiveData(game_board);
+    switch (reply) {
+      case WireProtocol::SPOT_UNAVAILABLE:
+        std::cerr << WireProtocol::ReplyMessage(reply) << std::endl;
+        std::cout << game_board;
+        continue;                                     // Go back to the user input process.
+      case WireProtocol::CLIENT_WON:
+      case WireProtocol::TIE_GAME:
+      case WireProtocol::OUT_OF_TIME:
+        // Receive The winning game board.
+        DashLines();
+        std::cout << game_board;
+        std::cout << WireProtocol::ReplyMessage(reply) << std::endl;
+        DashLines();
+        return true;
+      default:
+        // Receive Successful Move Message
+        std::cout << WireProtocol::ReplyMessage(reply) << std::endl;
+        std::cout << game_board;
+        break;
     }
-    // Receive Successful Move Message
-    std::cout << status_message << std::endl;
-    std::cout << game_board;
     break;
   }               // End of Client Move.
   
   return false;  // Winner was not declared.
 }
 
+/* ---------------------------------------------------------------------------------------
+ * FUNCTION NAME: UseSeat
+ * ---------------------------------------------------------------------------------------
+ * @brief Take a seat back instead of starting a new game: the game's ID and the seat
+ *        token the server sent when the game started. Call before StartConnection.
+ * ---------------------------------------------------------------------------------------
+ */
+void GameClient::UseSeat(uint32_t game_id, uint64_t token) {
+  is_rejoining = true;
+  seat_game_id = game_id;
+  seat_token   = token;
+}
+
+/* ---------------------------------------------------------------------------------------
+ * FUNCTION NAME: RejoinGame
+ * ---------------------------------------------------------------------------------------
+ * @brief Go on with the game of the seat the server gave back, from the board as it is,
+ *        until the game is over.
+ *
+ * @details The side to move is read off the board: X moves whenever both letters have
+ *          been played as often. An opponent that never comes back forfeits the game.
+ *
+ * @throws std::runtime_error if the server answers the rejoin hello with anything but
+ *                            the seat, or the connection fails during the game.
+ *
+ * @return False if the server closed the connection without giving the seat back: the
+ *         connection landed on a server shard that does not host the game, or the seat
+ *         is not there to take back.
+ * ---------------------------------------------------------------------------------------
+ */
+bool GameClient::RejoinGame() {
+  std::string game_board;
+  WireProtocol::Reply reply;
+  try {
+    reply = ReceiveData(game_board);
+  } catch (const std::runtime_error&) {
+    return false;
+  }
+  if (reply != WireProtocol::REJOINED_X && reply != WireProtocol::REJOINED_O) {
+    throw std::runtime_error("Error! Rejoining the game.");
+  }
+  letter = reply == WireProtocol::REJOINED_X ? 'X' : 'O';
+  std::cout << WireProtocol::ReplyMessage(reply) << std::endl;
+  std::cout << game_board;
+  const bool is_x_to_move = std::count(game_board.begin(), game_board.end(), 'X') ==
+                            std::count(game_board.begin(), game_board.end(), 'O');
+  if (is_x_to_move != (letter == 'X') && IsServerMove()) {
+    return true;
+  }
+  while (1) {
+    if (IsClientMove()) {
+      break;
+    }
+    if (IsServerMove()) {
+      break;
+    }
+  }
+  return true;
+}
+
 void GameClient::LaunchGame() {
   while (1) {
     if (IsServerMove()) {
@@ -329,3 +519,34 @@ void GameClient::LaunchGame() {
     }
   }
 }
+
+/* ---------------------------------------------------------------------------------------
+ * FUNCTION NAME: WatchGame
+ * ---------------------------------------------------------------------------------------
+ * @brief Print every update of the watched game until it is over.
+ *
+ * @details The server may skip updates for a spectator that reads slowly; every update
+ *          holds the whole board, so the board printed is always current. A game abandoned
+ *          by its players, or one the server does not know, ends with the server
+ *          disconnecting.
+ * ---------------------------------------------------------------------------------------
+ */
+void GameClient::WatchGame() {
+  try {
+    while (1) {
+      std::string game_board;
+      WireProtocol::Reply reply = ReceiveData(game_board);
+      if (reply == WireProtocol::X_WON || reply == WireProtocol::O_WON || reply == WireProtocol::TIE_GAME) {
+        DashLines();
+        std::cout << game_board;
+        std::cout << WireProtocol::ReplyMessage(reply) << std::endl;
+        DashLines();
+        return;
+      }
+      std::cout << WireProtocol::ReplyMessage(reply) << std::endl;
+      std::cout << game_board;
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+  }
+}
@@ -2,10 +2,12 @@
 #define GameClient_h
 #include "ResponseManager.h"
 #include "PromptingUser.h"
+#include "WireProtocol.h"
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <string>
 
 /* -------------------------------------------------------------------------------------
  * CLASS NAME: GameClient
@@ -17,15 +19,32 @@
  * server and client send-receive data over the network to determine the winner
  * of the Tic-Tac-Toe game.
  *
+ * Right after connecting, the client sends a hello naming the protocol of every
+ * following message: the compact binary protocol, or JSON for debugging.
+ *
+ * The client plays O and the server moves first, unless a matchmaking server pairs
+ * it with another client as X; it is then told so before making the first move.
+ *
+ * A spectator sends a watch hello instead and only prints the board of the watched
+ * game, every time it changes, until the game is over (see WatchGame).
+ *
+ * A server that recovers its games after going down sends each player its seat: the
+ * game's ID and a seat token, which the client prints. A client given a seat with
+ * UseSeat sends a rejoin hello instead and goes on with that game (see RejoinGame).
+ *
  * @note Close server and client socket when Tic-Tac-Toe game terminates.
  * -------------------------------------------------------------------------------------
  */
 class GameClient {
   public:
-    GameClient();
+    explicit GameClient(WireProtocol::Protocol protocol, bool is_spectator = false,
+                        uint32_t watched_game_id = WireProtocol::LATEST_GAME);
     int StartClient();
     int StartConnection();
     void LaunchGame();
+    void WatchGame();
+    void UseSeat(uint32_t game_id, uint64_t token);
+    bool RejoinGame();
     ~GameClient();
   
   private:
@@ -33,12 +52,21 @@ class GameClient {
     struct sockaddr_in server_address;
     ResponseManager response_manager;
     PromptingUser prompting;
+    std::string inbound;
+    WireProtocol::Protocol protocol;
+    char letter;  // 'O', unless the server pairs the client with another client as X.
+    bool is_spectator;
+    uint32_t watched_game_id;
+    bool is_rejoining;
+    uint32_t seat_game_id;  // The game of the last seat received, or of the seat to take back.
+    uint64_t seat_token;
     bool IsServerMove();
     bool IsClientMove();
-    void SendData(int* client_move);
-    void ReceiveData(char* status_messages, size_t status_messages_size,
-                     char* game_board_buffer, size_t game_board_size);
-    void ParseWinningInformation(char* combined_data, char* status_messages, size_t status_messages_size,
-                                 char* game_board_buffer, size_t game_board_size);
+    void SendHello();
+    void SendFrame(const std::string& payload);
+    void SendData(const int row, const int column);
+    WireProtocol::Reply ReceiveData(std::string& game_board);
+    bool ParseWinningInformation(const char* combined_data, size_t combined_data_size,
+                                 WireProtocol::Reply& reply, std::string& game_board);
 };
 #endif /* GameClient_h */
@@ -1,5 +1,6 @@
 #include "ResponseManager.h"
 #include <iostream>
+#include <limits>
 
 /* ----------------------------------------------------------------------
  * FUNCTION NAME: GetValidatedUserInput
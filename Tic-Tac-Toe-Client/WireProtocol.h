@@ -0,0 +1,98 @@
+#ifndef WireProtocol_h
+#define WireProtocol_h
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/* -------------------------------------------------------------------------------------
+ * NAMESPACE NAME: WireProtocol
+ * -------------------------------------------------------------------------------------
+ * @brief The encodings server and client agree on when a connection starts.
+ *
+ * The first frame a client sends is a hello: a single byte naming the protocol of every
+ * following frame, in both directions. A spectator sends a watch hello instead: the
+ * protocol byte followed by the 32-bit big-endian ID of the game to watch, or
+ * LATEST_GAME for the game started last. It then only receives replies: WATCHING with
+ * the board as it is, a PLAYER_X_MOVED or PLAYER_O_MOVED for every move, and X_WON,
+ * O_WON or TIE_GAME at the end.
+ *
+ * A server that can recover its games after going down sends each player a seat
+ * message before the first reply of its game: the game's ID and a 64-bit seat token.
+ * A player whose server went down takes its seat back with a rejoin hello: the
+ * protocol byte, the 32-bit big-endian game ID and the 64-bit big-endian seat token.
+ * It is answered REJOINED_X or REJOINED_O with the board as it is, and the game goes
+ * on; a seat the server cannot give back closes the connection.
+ *
+ *   JSON    Moves are {"row":..,"column":..} and replies are
+ *           {"status_message":..,"game_board":..}. Kept for debugging. A seat
+ *           message is {"status_message":..,"game_id":..,"seat_token":..}, the
+ *           token as 16 hexadecimal digits.
+ *   CBOR    The same objects as JSON, encoded as CBOR.
+ *   MSGPACK The same objects as JSON, encoded as MessagePack.
+ *   BINARY  A move is one byte, the spot's index (row - 1) * 3 + (column - 1).
+ *           A reply is four bytes: the Reply code, then the game board packed
+ *           as a 24-bit big-endian bitboard (X spots in bits 9-17, O spots in
+ *           bits 0-8, spot index i in bit i of each). A seat message is SEAT,
+ *           then the game ID and the seat token, big-endian.
+ *
+ * @note The server and client keep identical copies of this file.
+ * -------------------------------------------------------------------------------------
+ */
+namespace WireProtocol {
+  enum Protocol : uint8_t {
+    JSON    = 0,
+    BINARY  = 1,
+    CBOR    = 2,
+    MSGPACK = 3
+  };
+  
+  const int PROTOCOL_COUNT = 4;
+  
+  /* Every reply the server sends, by meaning rather than by English message. A client
+     paired with another client as X is told so by PLAYING_X, and then hears of its
+     opponent's moves by PLAYER_O_MOVED; SERVER_WON then means that its opponent won.
+     A client that does not move within the server's move time gets OUT_OF_TIME and
+     loses the game. SEAT only names the seat message, which carries no board. */
+  enum Reply : uint8_t {
+    PLAYER_X_MOVED   = 0,
+    MOVE_ACCEPTED    = 1,
+    SPOT_UNAVAILABLE = 2,
+    SERVER_WON       = 3,
+    CLIENT_WON       = 4,
+    TIE_GAME         = 5,
+    PLAYER_O_MOVED   = 6,
+    PLAYING_X        = 7,
+    WATCHING         = 8,
+    X_WON            = 9,
+    O_WON            = 10,
+    OUT_OF_TIME      = 11,
+    SEAT             = 12,
+    REJOINED_X       = 13,
+    REJOINED_O       = 14,
+    REPLY_COUNT      = 15
+  };
+  
+  const size_t MOVE_SIZE         = 1;
+  const size_t REPLY_SIZE        = 4;
+  const size_t WATCH_HELLO_SIZE  = 5;
+  const size_t REJOIN_HELLO_SIZE = 13;
+  const size_t SEAT_SIZE         = 13;
+  const uint32_t LATEST_GAME     = 0xffffffffu;
+  
+  bool IsProtocol(uint8_t value);
+  void AppendWatchHello(std::string& buffer, Protocol protocol, uint32_t game_id);
+  bool ParseWatchHello(const char* payload, size_t payload_size, Protocol& protocol, uint32_t& game_id);
+  void AppendRejoinHello(std::string& buffer, Protocol protocol, uint32_t game_id, uint64_t seat_token);
+  bool ParseRejoinHello(const char* payload, size_t payload_size, Protocol& protocol, uint32_t& game_id,
+                        uint64_t& seat_token);
+  void AppendSeat(std::string& buffer, uint32_t game_id, uint64_t seat_token);
+  bool ParseSeat(const char* payload, size_t payload_size, uint32_t& game_id, uint64_t& seat_token);
+  const char* ReplyMessage(Reply reply);
+  bool FindReply(const char* status_message, Reply& reply);
+  std::string UnpackBoard(uint32_t packed_board);
+  void AppendMove(std::string& buffer, int row, int column);
+  bool ParseMove(const char* payload, size_t payload_size, int& row, int& column);
+  void AppendReply(std::string& buffer, Reply reply, uint32_t packed_board);
+  bool ParseReply(const char* payload, size_t payload_size, Reply& reply, uint32_t& packed_board);
+}
+#endif /* WireProtocol_h */
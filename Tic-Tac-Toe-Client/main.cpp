@@ -1,9 +1,60 @@
 #include <iostream>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
 #include "GameClient.h"
 int main(int argc, const char * argv[]) {
-  GameClient game_client;
+  // The compact binary protocol is used unless another encoding is given:
+  // --json (readable, for debugging), --cbor or --msgpack. --watch [game id]
+  // watches a game, by default the one started last, instead of playing one.
+  // --rejoin <game id> <seat token> takes back a seat of a game the server
+  // recovered after going down.
+  const int REJOIN_ATTEMPTS       = 32;
+  WireProtocol::Protocol protocol = WireProtocol::BINARY;
+  bool is_spectator               = false;
+  uint32_t watched_game_id        = WireProtocol::LATEST_GAME;
+  bool is_rejoining               = false;
+  uint32_t rejoined_game_id       = 0;
+  uint64_t seat_token             = 0;
+  for (int index = 1; index < argc; ++index) {
+    if (strcmp(argv[index], "--json") == 0) {
+      protocol = WireProtocol::JSON;
+    } else if (strcmp(argv[index], "--cbor") == 0) {
+      protocol = WireProtocol::CBOR;
+    } else if (strcmp(argv[index], "--msgpack") == 0) {
+      protocol = WireProtocol::MSGPACK;
+    } else if (strcmp(argv[index], "--watch") == 0) {
+      is_spectator = true;
+      if (index + 1 < argc && isdigit(static_cast<unsigned char>(argv[index + 1][0]))) {
+        watched_game_id = static_cast<uint32_t>(strtoul(argv[++index], nullptr, 10));
+      }
+    } else if (strcmp(argv[index], "--rejoin") == 0 && index + 2 < argc) {
+      is_rejoining     = true;
+      rejoined_game_id = static_cast<uint32_t>(strtoul(argv[++index], nullptr, 10));
+      seat_token       = strtoull(argv[++index], nullptr, 16);
+    }
+  }
+  if (is_rejoining) {
+    // A server with several shards closes a connection that lands on a shard without
+    // the game; the next connection may land on the right one.
+    for (int attempt = 0; attempt < REJOIN_ATTEMPTS; ++attempt) {
+      GameClient game_client(protocol);
+      game_client.UseSeat(rejoined_game_id, seat_token);
+      game_client.StartConnection();
+      if (game_client.RejoinGame()) {
+        return EXIT_SUCCESS;
+      }
+    }
+    std::cerr << "Error! The server did not give the seat back." << std::endl;
+    return EXIT_FAILURE;
+  }
+  GameClient game_client(protocol, is_spectator, watched_game_id);
   game_client.StartConnection();
-  game_client.LaunchGame();
+  if (is_spectator) {
+    game_client.WatchGame();
+  } else {
+    game_client.LaunchGame();
+  }
   
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,331 @@
+#ifndef AlphaBetaSearch_h
+#define AlphaBetaSearch_h
+#include "LineCounters.h"
+#include "Player.h"
+#include "TranspositionTable.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+/* -------------------------------------------------------------------------------------
+ * CLASS NAME: AlphaBetaSearch
+ * -------------------------------------------------------------------------------------
+ * @brief Finds a move on any board variant of BasicGame by a time-budgeted, iteratively
+ *        deepened alpha-beta (negamax) search.
+ *
+ * The search deepens one move at a time until the position is solved or the time
+ * budget runs out, and plays the best move of the deepest search it finished, so a
+ * move is always ready on time. Positions are cached in a TranspositionTable keyed
+ * by the game's Zobrist hash; its best move is tried first, then the other moves in
+ * order of how much they gain on the evaluation. Wins are found through LineCounters.
+ *
+ * Positions the search cannot see to the end are scored by their open lines: a line
+ * held by one side only is worth Weight(spots held) to that side. The score is
+ * kept up to date move by move, from the lines through the spot played.
+ *
+ * On boards of more than 64 spots only the empty spots next to a taken spot are
+ * searched, which is where m,n,k games are decided.
+ *
+ * @note The engine holds no state but its transposition table, which is lock-free, so
+ *       one engine can search for many games on many threads at once.
+ * -------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+class AlphaBetaSearch {
+  public:
+    static constexpr int SPOT_COUNT = GameType::SPOT_COUNT;
+    static constexpr int WIN_SCORE  = 1 << 20;  // Less the number of moves it takes.
+
+    struct Result {
+      int spot;        // -1 when the game is over.
+      int score;       // For the side to move; at least WIN_SCORE - SPOT_COUNT for a forced win.
+      int depth;       // The deepest search that finished.
+      uint64_t nodes;  // Positions searched, over every depth.
+    };
+
+    AlphaBetaSearch(std::chrono::milliseconds time_budget, int table_size_bits = 20)
+        : time_budget(time_budget), table(table_size_bits) {}
+    Result Search(const GameType& game, const char letter) const;
+    Player GetMove(const GameType& game, const char letter) const;
+
+  private:
+    typedef LineCounters<GameType::BOARD_ROWS, GameType::BOARD_COLUMNS, GameType::BOARD_WIN_LENGTH> Counters;
+    typedef typename Counters::Lines Lines;
+    typedef std::chrono::steady_clock Clock;
+
+    static constexpr int WIN_LENGTH       = GameType::BOARD_WIN_LENGTH;
+    static constexpr int COLUMNS          = GameType::BOARD_COLUMNS;
+    static constexpr bool NEIGHBOURS_ONLY = SPOT_COUNT > 64;
+    static constexpr int CLOCK_INTERVAL   = 64;  // Nodes between looks at the clock.
+
+    /* The state of one search, kept on the searching thread's stack. */
+    struct SearchState {
+      GameType game;
+      Counters counters;
+      int empty_count;
+      int evaluation;  // For X.
+      int root_spot;
+      int finished_depth;
+      bool is_stopped;
+      uint64_t nodes;
+      Clock::time_point deadline;
+    };
+
+    std::chrono::milliseconds time_budget;
+    mutable TranspositionTable table;
+
+    int Negamax(SearchState& state, int depth, int alpha, int beta, int ply, int side) const;
+    int OrderMoves(const SearchState& state, int side, int best_spot, int* moves) const;
+    static bool Play(SearchState& state, int spot, int side);
+    static void Undo(SearchState& state, int spot, int side, int evaluation);
+    static int Gain(const SearchState& state, int spot, int side);
+    static int LineValue(int x_count, int o_count);
+    static int Weight(int count);
+};
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Search
+ * ------------------------------------------------------------------------------------
+ * @brief Searches the position for the side playing letter, within the time budget.
+ *
+ * @details The first depth is always finished, whatever the budget, so that there is
+ *          a move to play. Deepening stops early once a win or loss is forced.
+ *
+ * @return The best move found and how it was found.
+ * ------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+typename AlphaBetaSearch<GameType>::Result AlphaBetaSearch<GameType>::Search(const GameType& game,
+                                                                             const char letter) const {
+  SearchState state;
+  state.game           = game;
+  state.empty_count    = SPOT_COUNT;
+  state.evaluation     = 0;
+  state.root_spot      = -1;
+  state.finished_depth = 0;
+  state.is_stopped     = false;
+  state.nodes          = 0;
+  state.deadline       = Clock::now() + time_budget;
+  for (int spot = 0; spot < SPOT_COUNT; ++spot) {
+    for (int side = 0; side < 2; ++side) {
+      if (GameType::Masks::Test(game.GetMask(side == 0 ? 'X' : 'O'), spot)) {
+        state.evaluation += side == 0 ? Gain(state, spot, 0) : -Gain(state, spot, 1);
+        state.counters.InsertMove(spot, side);
+        --state.empty_count;
+      }
+    }
+  }
+  Result result = { -1, 0, 0, 0 };
+  if (state.counters.IsWinner(0) || state.counters.IsWinner(1) || state.empty_count == 0) {
+    return result;
+  }
+  const int side = letter == 'X' ? 0 : 1;
+  for (int depth = 1; depth <= state.empty_count; ++depth) {
+    int score = Negamax(state, depth, -WIN_SCORE, WIN_SCORE, 0, side);
+    if (state.is_stopped) {
+      break;
+    }
+    result.spot          = state.root_spot;
+    result.score         = score;
+    result.depth         = depth;
+    state.finished_depth = depth;
+    if (score >= WIN_SCORE - SPOT_COUNT || score <= -WIN_SCORE + SPOT_COUNT) {
+      break;
+    }
+  }
+  result.nodes = state.nodes;
+  
+  return result;
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: GetMove
+ * ------------------------------------------------------------------------------------
+ * @brief Searches for the best move, as a player.
+ *
+ * @return The 1-based row and column number of the move, or row and column 0 if the
+ *         game is over.
+ * ------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+Player AlphaBetaSearch<GameType>::GetMove(const GameType& game, const char letter) const {
+  Player player = { 0, 0 };
+  Result result = Search(game, letter);
+  if (result.spot >= 0) {
+    player.row    = result.spot / COLUMNS + 1;
+    player.column = result.spot % COLUMNS + 1;
+  }
+  
+  return player;
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Negamax
+ * ------------------------------------------------------------------------------------
+ * @brief Scores the position for the side to move, after a move that did not end the
+ *        game, looking depth moves ahead.
+ *
+ * @details Win scores are stored in the table relative to the position they were
+ *          found in, and turned back into scores from the root on the way out, so
+ *          that a cached win is worth the same wherever the position comes up.
+ *
+ * @return The score; meaningless once the search is stopped by the clock.
+ * ------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+int AlphaBetaSearch<GameType>::Negamax(SearchState& state, int depth, int alpha, int beta, int ply,
+                                       int side) const {
+  if (state.empty_count == 0) {
+    return 0;
+  }
+  if (depth == 0) {
+    return side == 0 ? state.evaluation : -state.evaluation;
+  }
+  if (++state.nodes % CLOCK_INTERVAL == 0 && state.finished_depth > 0 && Clock::now() > state.deadline) {
+    state.is_stopped = true;
+    return 0;
+  }
+  const uint64_t key = state.game.GetHash();
+  TranspositionTable::Entry entry;
+  int best_spot = -1;
+  if (table.Probe(key, entry)) {
+    best_spot = entry.best_spot;
+    if (entry.score >= WIN_SCORE - SPOT_COUNT) {
+      entry.score -= ply;
+    } else if (entry.score <= -WIN_SCORE + SPOT_COUNT) {
+      entry.score += ply;
+    }
+    if (ply > 0 && entry.depth >= depth &&
+        (entry.bound == TranspositionTable::EXACT ||
+         (entry.bound == TranspositionTable::LOWER && entry.score >= beta) ||
+         (entry.bound == TranspositionTable::UPPER && entry.score <= alpha))) {
+      return entry.score;
+    }
+  }
+  int moves[SPOT_COUNT];
+  const int move_count     = OrderMoves(state, side, best_spot, moves);
+  const int original_alpha = alpha;
+  const int evaluation     = state.evaluation;
+  int best_score = -WIN_SCORE - 1;
+  for (int index = 0; index < move_count; ++index) {
+    const int spot = moves[index];
+    int score;
+    if (Play(state, spot, side)) {
+      score = WIN_SCORE - (ply + 1);
+    } else {
+      score = -Negamax(state, depth - 1, -beta, -alpha, ply + 1, 1 - side);
+    }
+    Undo(state, spot, side, evaluation);
+    if (state.is_stopped) {
+      return 0;
+    }
+    if (score > best_score) {
+      best_score = score;
+      best_spot  = spot;
+      if (ply == 0) {
+        state.root_spot = spot;
+      }
+    }
+    alpha = std::max(alpha, score);
+    if (alpha >= beta) {
+      break;
+    }
+  }
+  entry.score     = best_score;
+  entry.depth     = depth;
+  entry.bound     = best_score <= original_alpha ? TranspositionTable::UPPER
+                  : best_score >= beta           ? TranspositionTable::LOWER
+                                                 : TranspositionTable::EXACT;
+  entry.best_spot = best_spot;
+  if (entry.score >= WIN_SCORE - SPOT_COUNT) {
+    entry.score += ply;
+  } else if (entry.score <= -WIN_SCORE + SPOT_COUNT) {
+    entry.score -= ply;
+  }
+  table.Store(key, entry);
+  
+  return best_score;
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: OrderMoves
+ * ------------------------------------------------------------------------------------
+ * @brief Lists the moves to search: the table's best move first, then the others by
+ *        their gain for the side to move, largest first.
+ *
+ * @return The number of moves listed.
+ * ------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+int AlphaBetaSearch<GameType>::OrderMoves(const SearchState& state, int side, int best_spot, int* moves) const {
+  int gains[SPOT_COUNT];
+  int move_count = 0;
+  const typename GameType::Mask& x_mask = state.game.GetMask('X');
+  const typename GameType::Mask& o_mask = state.game.GetMask('O');
+  for (int spot = 0; spot < SPOT_COUNT; ++spot) {
+    if (GameType::Masks::Test(x_mask, spot) || GameType::Masks::Test(o_mask, spot)) {
+      continue;
+    }
+    if (NEIGHBOURS_ONLY && state.empty_count < SPOT_COUNT && !state.game.IsNextToTakenSpot(spot)) {
+      continue;
+    }
+    if (NEIGHBOURS_ONLY && state.empty_count == SPOT_COUNT && spot != SPOT_COUNT / 2) {
+      continue;  // The first move on a large board goes in the middle.
+    }
+    int gain = spot == best_spot ? WIN_SCORE : Gain(state, spot, side);
+    int index = move_count++;
+    // Insertion sort: there are few moves, and they come in nearly sorted from the table.
+    for (; index > 0 && gains[index - 1] < gain; --index) {
+      gains[index] = gains[index - 1];
+      moves[index] = moves[index - 1];
+    }
+    gains[index] = gain;
+    moves[index] = spot;
+  }
+  return move_count;
+}
+
+/* Plays a spot for a side; returns true if the move wins. */
+template <typename GameType>
+bool AlphaBetaSearch<GameType>::Play(SearchState& state, int spot, int side) {
+  state.evaluation += side == 0 ? Gain(state, spot, 0) : -Gain(state, spot, 1);
+  state.game.InsertMove(spot / COLUMNS + 1, spot % COLUMNS + 1, side == 0 ? 'X' : 'O');
+  --state.empty_count;
+  return state.counters.InsertMove(spot, side);
+}
+
+/* Takes back Play, restoring the evaluation from before it. */
+template <typename GameType>
+void AlphaBetaSearch<GameType>::Undo(SearchState& state, int spot, int side, int evaluation) {
+  state.counters.RemoveMove(spot, side);
+  state.game.RemoveMove(spot / COLUMNS + 1, spot % COLUMNS + 1);
+  ++state.empty_count;
+  state.evaluation = evaluation;
+}
+
+/* How much a side's evaluation grows by taking a spot: its lines grow, the other side's close. */
+template <typename GameType>
+int AlphaBetaSearch<GameType>::Gain(const SearchState& state, int spot, int side) {
+  int gain = 0;
+  for (int index = 0; index < Lines::TABLE.line_count[spot]; ++index) {
+    const int line    = Lines::TABLE.lines[spot][index];
+    const int x_count = state.counters.Count(0, line);
+    const int o_count = state.counters.Count(1, line);
+    gain += side == 0 ? LineValue(x_count + 1, o_count) - LineValue(x_count, o_count)
+                      : LineValue(x_count, o_count) - LineValue(x_count, o_count + 1);
+  }
+  return gain;
+}
+
+/* The worth of a line to X. */
+template <typename GameType>
+int AlphaBetaSearch<GameType>::LineValue(int x_count, int o_count) {
+  return (o_count == 0 ? Weight(x_count) : 0) - (x_count == 0 ? Weight(o_count) : 0);
+}
+
+/* The worth of a line to the side holding it: 0 for an empty line, then 1, 4, 16, ... for each spot held. */
+template <typename GameType>
+int AlphaBetaSearch<GameType>::Weight(int count) {
+  return count == 0 ? 0 : 1 << (2 * std::min(count - 1, 8));
+}
+#endif /* AlphaBetaSearch_h */
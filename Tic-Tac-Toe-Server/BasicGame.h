@@ -0,0 +1,393 @@
+#ifndef BasicGame_h
+#define BasicGame_h
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+/* -------------------------------------------------------------------------------------
+ * STRUCT NAME: BoardMask
+ * -------------------------------------------------------------------------------------
+ * @brief The smallest type that holds one bit per spot of a board.
+ *
+ * Boards of up to 64 spots use an unsigned integer, so that a whole line is tested
+ * with one AND and one compare. Larger boards use a std::bitset.
+ * -------------------------------------------------------------------------------------
+ */
+template <int SPOT_COUNT, bool IS_SMALL = (SPOT_COUNT <= 64)>
+struct BoardMask {
+  typedef typename std::conditional<SPOT_COUNT <= 16, uint16_t,
+          typename std::conditional<SPOT_COUNT <= 32, uint32_t, uint64_t>::type>::type type;
+
+  static bool Test(const type& mask, int spot) { return (mask >> spot) & 1u; }
+  static void Set(type& mask, int spot) { mask |= static_cast<type>(type(1) << spot); }
+  static void Reset(type& mask, int spot) { mask &= static_cast<type>(~(type(1) << spot)); }
+  static uint32_t Pack(const type& x_mask, const type& o_mask) {
+    // The shift is kept below 32 so that it stays defined on boards that cannot be packed.
+    return SPOT_COUNT <= 16 ? (static_cast<uint32_t>(x_mask) << (SPOT_COUNT % 32)) | o_mask : 0;
+  }
+};
+
+template <int SPOT_COUNT>
+struct BoardMask<SPOT_COUNT, false> {
+  typedef std::bitset<SPOT_COUNT> type;
+
+  static bool Test(const type& mask, int spot) { return mask.test(spot); }
+  static void Set(type& mask, int spot) { mask.set(spot); }
+  static void Reset(type& mask, int spot) { mask.reset(spot); }
+  static uint32_t Pack(const type&, const type&) { return 0; }
+};
+
+/* -------------------------------------------------------------------------------------
+ * STRUCT NAME: ZobristKeys
+ * -------------------------------------------------------------------------------------
+ * @brief A fixed random 64-bit key per spot and letter, generated at compile time.
+ *
+ * The Zobrist hash of a position is the XOR of the keys of its taken spots, so taking
+ * or freeing a spot updates it with one XOR. The keys come from a splitmix64 sequence
+ * with a fixed seed: every build and every server shard hash a position the same way.
+ * -------------------------------------------------------------------------------------
+ */
+template <int SPOT_COUNT>
+struct ZobristKeys {
+  struct Table {
+    uint64_t keys[2][SPOT_COUNT];
+  };
+
+  static constexpr uint64_t SplitMix64(uint64_t& state) {
+    uint64_t value = (state += 0x9e3779b97f4a7c15ull);
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+  }
+
+  static constexpr Table Generate() {
+    Table table = {};
+    uint64_t state = 0x5a6f627269737421ull;
+    for (int side = 0; side < 2; ++side) {
+      for (int spot = 0; spot < SPOT_COUNT; ++spot) {
+        table.keys[side][spot] = SplitMix64(state);
+      }
+    }
+    return table;
+  }
+
+  static constexpr Table TABLE = Generate();
+};
+
+template <int SPOT_COUNT>
+constexpr typename ZobristKeys<SPOT_COUNT>::Table ZobristKeys<SPOT_COUNT>::TABLE;
+
+/* -------------------------------------------------------------------------------------
+ * STRUCT NAME: LineGeometry
+ * -------------------------------------------------------------------------------------
+ * @brief Every winning line of a board, as its first spot and the step to the next
+ *        spot, generated at compile time.
+ *
+ * A line is WIN_LENGTH spots in a row, column, diagonal or anti-diagonal. On a 3x3
+ * board with 3 in a row these are the classic 8 lines. Lines are numbered in the
+ * order they are found scanning the board row by row, which every table built from
+ * this one shares.
+ * -------------------------------------------------------------------------------------
+ */
+template <int ROWS, int COLUMNS, int WIN_LENGTH>
+struct LineGeometry {
+  // The number of places a line fits along a side of the given length.
+  static constexpr int Fits(int length) { return length >= WIN_LENGTH ? length - WIN_LENGTH + 1 : 0; }
+
+  static constexpr int LINE_COUNT = ROWS * Fits(COLUMNS) + COLUMNS * Fits(ROWS) + 2 * Fits(ROWS) * Fits(COLUMNS);
+
+  struct Table {
+    int first_spot[LINE_COUNT];
+    int step[LINE_COUNT];
+  };
+
+  static constexpr Table Generate() {
+    Table table = {};
+    int count = 0;
+    for (int row = 0; row < ROWS; ++row) {
+      for (int column = 0; column < COLUMNS; ++column) {
+        const int spot = row * COLUMNS + column;
+        if (column + WIN_LENGTH <= COLUMNS) {
+          table.first_spot[count] = spot;
+          table.step[count++]     = 1;
+        }
+        if (row + WIN_LENGTH <= ROWS) {
+          table.first_spot[count] = spot;
+          table.step[count++]     = COLUMNS;
+        }
+        if (row + WIN_LENGTH <= ROWS && column + WIN_LENGTH <= COLUMNS) {
+          table.first_spot[count] = spot;
+          table.step[count++]     = COLUMNS + 1;
+        }
+        if (row + WIN_LENGTH <= ROWS && column - WIN_LENGTH + 1 >= 0) {
+          table.first_spot[count] = spot;
+          table.step[count++]     = COLUMNS - 1;
+        }
+      }
+    }
+    return table;
+  }
+
+  static constexpr Table TABLE = Generate();
+};
+
+template <int ROWS, int COLUMNS, int WIN_LENGTH>
+constexpr typename LineGeometry<ROWS, COLUMNS, WIN_LENGTH>::Table LineGeometry<ROWS, COLUMNS, WIN_LENGTH>::TABLE;
+
+/* -------------------------------------------------------------------------------------
+ * STRUCT NAME: WinLines
+ * -------------------------------------------------------------------------------------
+ * @brief Every winning line of a small board as a mask of its spots, generated at
+ *        compile time from LineGeometry.
+ * -------------------------------------------------------------------------------------
+ */
+template <int ROWS, int COLUMNS, int WIN_LENGTH>
+struct WinLines {
+  typedef LineGeometry<ROWS, COLUMNS, WIN_LENGTH> Geometry;
+  typedef typename BoardMask<ROWS * COLUMNS>::type Mask;
+
+  static constexpr int LINE_COUNT = Geometry::LINE_COUNT;
+
+  struct Table {
+    Mask lines[LINE_COUNT];
+  };
+
+  static constexpr Table Generate() {
+    Table table = {};
+    for (int line = 0; line < LINE_COUNT; ++line) {
+      for (int index = 0; index < WIN_LENGTH; ++index) {
+        table.lines[line] |= Mask(1) << (Geometry::TABLE.first_spot[line] + index * Geometry::TABLE.step[line]);
+      }
+    }
+    return table;
+  }
+
+  static constexpr Table TABLE = Generate();
+};
+
+template <int ROWS, int COLUMNS, int WIN_LENGTH>
+constexpr typename WinLines<ROWS, COLUMNS, WIN_LENGTH>::Table WinLines<ROWS, COLUMNS, WIN_LENGTH>::TABLE;
+
+/* -------------------------------------------------------------------------------------
+ * STRUCT NAME: WinCheck
+ * -------------------------------------------------------------------------------------
+ * @brief Finds out whether a mask holds a winning line, specialized on board size.
+ *
+ * Small boards (up to 64 spots) test the mask against every line of WinLines, one AND
+ * and compare per line. Large boards (e.g. 15x15 Gomoku) count the spots of the mask
+ * outwards from its last spot in the 4 directions, which only looks at the few spots
+ * that the last move can affect.
+ * -------------------------------------------------------------------------------------
+ */
+template <int ROWS, int COLUMNS, int WIN_LENGTH, bool IS_SMALL = (ROWS * COLUMNS <= 64)>
+struct WinCheck {
+  typedef WinLines<ROWS, COLUMNS, WIN_LENGTH> Lines;
+  typedef typename Lines::Mask Mask;
+
+  static bool HasLine(const Mask& mask, int) {
+    bool is_winner = false;
+    for (int index = 0; index < Lines::LINE_COUNT; ++index) {
+      // No early exit: the unrolled checks stay branch-free.
+      is_winner |= (mask & Lines::TABLE.lines[index]) == Lines::TABLE.lines[index];
+    }
+    return is_winner;
+  }
+};
+
+template <int ROWS, int COLUMNS, int WIN_LENGTH>
+struct WinCheck<ROWS, COLUMNS, WIN_LENGTH, false> {
+  typedef BoardMask<ROWS * COLUMNS> Masks;
+  typedef typename Masks::type Mask;
+
+  static bool HasLine(const Mask& mask, int last_spot) {
+    if (last_spot < 0) {
+      return false;
+    }
+    const int row    = last_spot / COLUMNS;
+    const int column = last_spot % COLUMNS;
+    const int directions[4][2] = { { 0, 1 }, { 1, 0 }, { 1, 1 }, { 1, -1 } };
+    for (int direction = 0; direction < 4; ++direction) {
+      int row_step    = directions[direction][0];
+      int column_step = directions[direction][1];
+      int length = 1 + Count(mask, row, column, row_step, column_step) +
+                       Count(mask, row, column, -row_step, -column_step);
+      if (length >= WIN_LENGTH) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /* Counts the mask's consecutive spots after (row, column), 0-based, in one direction. */
+  static int Count(const Mask& mask, int row, int column, int row_step, int column_step) {
+    int count = 0;
+    for (int step = 1; step < WIN_LENGTH; ++step) {
+      int next_row    = row + step * row_step;
+      int next_column = column + step * column_step;
+      if (next_row < 0 || next_row >= ROWS || next_column < 0 || next_column >= COLUMNS ||
+          !Masks::Test(mask, next_row * COLUMNS + next_column)) {
+        break;
+      }
+      ++count;
+    }
+    return count;
+  }
+};
+
+/* -------------------------------------------------------------------------------------
+ * CLASS NAME: BasicGame
+ * -------------------------------------------------------------------------------------
+ * @brief Handles the gaming logic of an m,n,k game: a ROWS x COLUMNS board on which
+ *        WIN_LENGTH spots in a line win. Tic-Tac-Toe is BasicGame<3, 3, 3>.
+ *
+ * The board is kept as one occupancy mask per letter, where spot (row, column) is bit
+ * (row - 1) * COLUMNS + (column - 1). Masks and win detection are picked at compile
+ * time from the board size, see BoardMask and WinCheck.
+ *
+ * Every game also carries the Zobrist hash of its position (see ZobristKeys), kept up
+ * to date by InsertMove and RemoveMove, to key caches and transposition tables
+ * without serializing the board.
+ *
+ * @note Row and column numbers are 1-based, as everywhere else in the server.
+ * -------------------------------------------------------------------------------------
+ */
+template <int ROWS, int COLUMNS, int WIN_LENGTH>
+class BasicGame {
+  static_assert(ROWS > 0 && COLUMNS > 0, "A board needs at least one spot.");
+  static_assert(WIN_LENGTH > 0 && (WIN_LENGTH <= ROWS || WIN_LENGTH <= COLUMNS),
+                "The win length must fit on the board.");
+
+  public:
+    static constexpr int BOARD_ROWS       = ROWS;
+    static constexpr int BOARD_COLUMNS    = COLUMNS;
+    static constexpr int BOARD_WIN_LENGTH = WIN_LENGTH;
+    static constexpr int SPOT_COUNT       = ROWS * COLUMNS;
+    typedef BoardMask<SPOT_COUNT> Masks;
+    typedef typename Masks::type Mask;
+
+    BasicGame() : x_mask(), o_mask(), hash(0), last_spot{ -1, -1 } {}
+    std::string DisplayGameBoard() const;
+    bool IsMoveValid(const int row, const int column) const;
+    void InsertMove(const int row, const int column, const char letter);
+    void RemoveMove(const int row, const int column);
+    bool IsWinner(const char letter) const;
+    const Mask& GetMask(const char letter) const { return letter == 'X' ? x_mask : o_mask; }
+    uint32_t PackBoard() const;
+    uint64_t GetHash() const { return hash; }
+    bool IsNextToTakenSpot(const int spot) const;
+    static int Spot(const int row, const int column) { return (row - 1) * COLUMNS + (column - 1); }
+
+  private:
+    Mask x_mask;
+    Mask o_mask;
+    uint64_t hash;
+    int last_spot[2];  // The last spot taken by X and by O, -1 before their first move.
+
+    static int Side(const char letter) { return letter == 'X' ? 0 : 1; }
+};
+
+template <int ROWS, int COLUMNS, int WIN_LENGTH>
+std::string BasicGame<ROWS, COLUMNS, WIN_LENGTH>::DisplayGameBoard() const {
+  std::string result;
+  for (int spot = 0; spot < SPOT_COUNT; ++spot) {
+    result += Masks::Test(x_mask, spot) ? 'X' : Masks::Test(o_mask, spot) ? 'O' : '*';
+    if (spot % COLUMNS == COLUMNS - 1) {
+      result += '\n';
+    }
+  }
+
+  return result;
+}
+
+template <int ROWS, int COLUMNS, int WIN_LENGTH>
+bool BasicGame<ROWS, COLUMNS, WIN_LENGTH>::IsMoveValid(const int row, const int column) const {
+  int spot = Spot(row, column);
+  return !Masks::Test(x_mask, spot) && !Masks::Test(o_mask, spot);
+}
+
+template <int ROWS, int COLUMNS, int WIN_LENGTH>
+void BasicGame<ROWS, COLUMNS, WIN_LENGTH>::InsertMove(const int row, const int column, const char letter) {
+  int spot = Spot(row, column);
+  int side = Side(letter);
+  Masks::Set(side == 0 ? x_mask : o_mask, spot);
+  hash ^= ZobristKeys<SPOT_COUNT>::TABLE.keys[side][spot];
+  last_spot[side] = spot;
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: RemoveMove
+ * ------------------------------------------------------------------------------------
+ * @brief Takes a letter back off a spot, undoing its InsertMove and its hash update.
+ *
+ * @details Moves are meant to be taken back in the reverse order they were made, as a
+ *          search does. The side that moved forgets its last move, so IsWinner on a
+ *          large board reports no line for it until it moves again; a position with a
+ *          completed line is never played on, so that is the right answer.
+ * ------------------------------------------------------------------------------------
+ */
+template <int ROWS, int COLUMNS, int WIN_LENGTH>
+void BasicGame<ROWS, COLUMNS, WIN_LENGTH>::RemoveMove(const int row, const int column) {
+  int spot = Spot(row, column);
+  int side = Masks::Test(x_mask, spot) ? 0 : Masks::Test(o_mask, spot) ? 1 : -1;
+  if (side < 0) {
+    return;
+  }
+  Masks::Reset(side == 0 ? x_mask : o_mask, spot);
+  hash ^= ZobristKeys<SPOT_COUNT>::TABLE.keys[side][spot];
+  last_spot[side] = -1;
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: IsWinner
+ * ------------------------------------------------------------------------------------
+ * @brief Checks whether a letter owns a complete winning line.
+ *
+ * @details On a large board only the lines through the letter's last move are
+ *          looked at. That assumes IsWinner is asked after every move, as the searches
+ *          do, so an earlier line would already have ended the game.
+ * ------------------------------------------------------------------------------------
+ */
+template <int ROWS, int COLUMNS, int WIN_LENGTH>
+bool BasicGame<ROWS, COLUMNS, WIN_LENGTH>::IsWinner(const char letter) const {
+  return WinCheck<ROWS, COLUMNS, WIN_LENGTH>::HasLine(GetMask(letter), last_spot[Side(letter)]);
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: PackBoard
+ * ------------------------------------------------------------------------------------
+ * @brief Packs the game board into a bitboard: X spots above the O spots, the layout
+ *        of a binary protocol reply on a 3x3 board.
+ *
+ * @return The X mask shifted left by SPOT_COUNT, OR-ed with the O mask, or 0 on a
+ *         board of more than 16 spots, which does not fit.
+ * ------------------------------------------------------------------------------------
+ */
+template <int ROWS, int COLUMNS, int WIN_LENGTH>
+uint32_t BasicGame<ROWS, COLUMNS, WIN_LENGTH>::PackBoard() const {
+  return Masks::Pack(x_mask, o_mask);
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: IsNextToTakenSpot
+ * ------------------------------------------------------------------------------------
+ * @brief Checks whether any of the up to 8 spots around a 0-based spot is taken; the
+ *        moves worth searching on a large board.
+ * ------------------------------------------------------------------------------------
+ */
+template <int ROWS, int COLUMNS, int WIN_LENGTH>
+bool BasicGame<ROWS, COLUMNS, WIN_LENGTH>::IsNextToTakenSpot(const int spot) const {
+  const int row    = spot / COLUMNS;
+  const int column = spot % COLUMNS;
+  for (int next_row = std::max(row - 1, 0); next_row <= std::min(row + 1, ROWS - 1); ++next_row) {
+    for (int next_column = std::max(column - 1, 0); next_column <= std::min(column + 1, COLUMNS - 1); ++next_column) {
+      const int next_spot = next_row * COLUMNS + next_column;
+      if (Masks::Test(x_mask, next_spot) || Masks::Test(o_mask, next_spot)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+#endif /* BasicGame_h */
@@ -0,0 +1,190 @@
+#include "../MoveParser.h"
+#include "../WireProtocol.h"
+#include <arpa/inet.h>
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+/* -------------------------------------------------------------------------------------
+ * PROGRAM NAME: ParseBenchmark
+ * -------------------------------------------------------------------------------------
+ * @brief Counts the heap allocations and time per move of parsing moves of every
+ *        protocol, into a json document as the server used to and through MoveParser
+ *        (or WireProtocol::ParseMove for binary moves) as it does now.
+ *
+ * This program replaces the global operator new and operator delete with versions
+ * over malloc and free that count every allocation, so it is built on its own and
+ * never linked into the server. From the server's directory:
+ *
+ *   g++ -O2 -std=c++14 Benchmarks/ParseBenchmark.cpp MoveParser.cpp WireProtocol.cpp -o parseBenchmark
+ *   ./parseBenchmark <moves>
+ * -------------------------------------------------------------------------------------
+ */
+namespace {
+  uint64_t allocation_count = 0;  // The benchmark runs on one thread.
+
+  /* How the server read a move before MoveParser: into a json document. */
+  bool ParseMoveDocument(WireProtocol::Protocol protocol, const std::string& payload, int& row, int& column) {
+    nlohmann::json json_data;
+    if (protocol == WireProtocol::CBOR) {
+      json_data = nlohmann::json::from_cbor(payload);
+    } else if (protocol == WireProtocol::MSGPACK) {
+      json_data = nlohmann::json::from_msgpack(payload);
+    } else {
+      json_data = nlohmann::json::parse(payload);
+    }
+    row    = json_data["row"].get<int>();
+    column = json_data["column"].get<int>();
+    return true;
+  }
+
+  /* What parsing a move costs, by its allocations and the time taken. */
+  struct ParseCost {
+    double allocations;
+    double nanoseconds;
+  };
+
+  template <typename Parse>
+  ParseCost MeasureParse(size_t move_count, Parse parse) {
+    const uint64_t start_count = allocation_count;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t move = 0; move < move_count; ++move) {
+      if (!parse()) {
+        throw std::runtime_error("Error! A benchmark move was not parsed.");
+      }
+    }
+    ParseCost cost;
+    cost.nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                       move_count;
+    cost.allocations = static_cast<double>(allocation_count - start_count) / move_count;
+    return cost;
+  }
+
+  /* ------------------------------------------------------------------------------------
+   * FUNCTION NAME: RunBenchmark
+   * ------------------------------------------------------------------------------------
+   * @brief Prints the allocations and time per move of parsing move_count moves of every
+   *        protocol, encoded as the client encodes them.
+   *
+   * @throws std::runtime_error if a move is not parsed, or not parsed to what was sent.
+   * ------------------------------------------------------------------------------------
+   */
+  void RunBenchmark(size_t move_count) {
+    const WireProtocol::Protocol protocols[] = {
+      WireProtocol::JSON, WireProtocol::CBOR, WireProtocol::MSGPACK, WireProtocol::BINARY
+    };
+    const char* const protocol_names[] = { "json   ", "cbor   ", "msgpack", "binary " };
+    const int sent_row    = 2;
+    const int sent_column = 3;
+    int row               = 0;
+    int column            = 0;
+
+    std::cout << "Heap allocations and time per move, " << move_count << " moves:" << std::endl;
+    std::cout << "            document             parser" << std::endl;
+    std::cout << std::fixed;
+    for (int index = 0; index < WireProtocol::PROTOCOL_COUNT; ++index) {
+      const WireProtocol::Protocol protocol = protocols[index];
+      std::string payload;
+      std::cout << "  " << protocol_names[index];
+      if (protocol == WireProtocol::BINARY) {
+        WireProtocol::AppendMove(payload, sent_row, sent_column);
+        ParseCost parser = MeasureParse(move_count, [&] {
+          return WireProtocol::ParseMove(payload.data(), payload.size(), row, column);
+        });
+        if (row != sent_row || column != sent_column) {
+          throw std::runtime_error("Error! A benchmark move was parsed wrong.");
+        }
+        std::cout << "   -                 " << std::setprecision(1) << std::setw(5) << parser.allocations
+                  << " allocs " << std::setprecision(0) << std::setw(5) << parser.nanoseconds << "ns" << std::endl;
+        continue;
+      }
+      nlohmann::json move_data;
+      move_data["row"]    = htons(sent_row);
+      move_data["column"] = htons(sent_column);
+      if (protocol == WireProtocol::CBOR) {
+        nlohmann::json::to_cbor(move_data, payload);
+      } else if (protocol == WireProtocol::MSGPACK) {
+        nlohmann::json::to_msgpack(move_data, payload);
+      } else {
+        payload = move_data.dump();
+      }
+      ParseCost document = MeasureParse(move_count, [&] {
+        return ParseMoveDocument(protocol, payload, row, column);
+      });
+      ParseCost parser = MeasureParse(move_count, [&] {
+        return MoveParser::ParseEncodedMove(protocol, payload.data(), payload.size(), row, column);
+      });
+      if (row != htons(sent_row) || column != htons(sent_column)) {
+        throw std::runtime_error("Error! A benchmark move was parsed wrong.");
+      }
+      std::cout << std::setprecision(1) << std::setw(5) << document.allocations << " allocs "
+                << std::setprecision(0) << std::setw(5) << document.nanoseconds << "ns   "
+                << std::setprecision(1) << std::setw(5) << parser.allocations << " allocs "
+                << std::setprecision(0) << std::setw(5) << parser.nanoseconds << "ns" << std::endl;
+    }
+  }
+}
+
+/* As the standard operator new, counting every allocation. */
+void* operator new(std::size_t size) {
+  ++allocation_count;
+  void* memory;
+  while ((memory = std::malloc(size == 0 ? 1 : size)) == nullptr) {
+    std::new_handler handler = std::get_new_handler();
+    if (!handler) {
+      throw std::bad_alloc();
+    }
+    handler();
+  }
+  return memory;
+}
+
+void* operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return operator new(size);
+  } catch (const std::bad_alloc&) {
+    return nullptr;
+  }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return operator new(size, std::nothrow);
+}
+
+/* Never inlined, so that gcc does not see free on a pointer from operator new. */
+__attribute__((noinline)) void operator delete(void* memory) noexcept {
+  std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete[](void* memory) noexcept {
+  std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void* memory, std::size_t) noexcept {
+  std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete[](void* memory, std::size_t) noexcept {
+  std::free(memory);
+}
+
+int main(int argc, const char* argv[]) {
+  const int move_count = argc > 1 ? atoi(argv[1]) : 1000000;
+  if (move_count <= 0) {
+    std::cerr << "Usage: " << argv[0] << " <moves>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  RunBenchmark(static_cast<size_t>(move_count));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,205 @@
+#include "BoardSymmetry.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace BoardSymmetry {
+  namespace {
+    const int BOARD_SIZE = 3;
+    const int SPOT_COUNT = 9;
+    const int MASK_COUNT = 1 << SPOT_COUNT;
+
+    struct Tables {
+      int spots[TRANSFORM_COUNT][SPOT_COUNT];     // Where each spot goes under a transform.
+      uint16_t masks[TRANSFORM_COUNT][MASK_COUNT];  // Every 9-bit mask under a transform.
+      int inverse[TRANSFORM_COUNT];
+    };
+
+    constexpr int Rotate(int spot) {
+      // A quarter turn clockwise takes (row, column) to (column, 2 - row).
+      return (spot % BOARD_SIZE) * BOARD_SIZE + (BOARD_SIZE - 1 - spot / BOARD_SIZE);
+    }
+
+    constexpr int Mirror(int spot) {
+      return (spot / BOARD_SIZE) * BOARD_SIZE + (BOARD_SIZE - 1 - spot % BOARD_SIZE);
+    }
+
+    constexpr Tables Generate() {
+      Tables tables = {};
+      for (int transform = 0; transform < TRANSFORM_COUNT; ++transform) {
+        for (int spot = 0; spot < SPOT_COUNT; ++spot) {
+          int moved = transform >= 4 ? Mirror(spot) : spot;
+          for (int turn = 0; turn < transform % 4; ++turn) {
+            moved = Rotate(moved);
+          }
+          tables.spots[transform][spot] = moved;
+        }
+        for (int mask = 0; mask < MASK_COUNT; ++mask) {
+          uint16_t moved = 0;
+          for (int spot = 0; spot < SPOT_COUNT; ++spot) {
+            if (mask & (1 << spot)) {
+              moved |= static_cast<uint16_t>(1 << tables.spots[transform][spot]);
+            }
+          }
+          tables.masks[transform][mask] = moved;
+        }
+      }
+      for (int transform = 0; transform < TRANSFORM_COUNT; ++transform) {
+        for (int candidate = 0; candidate < TRANSFORM_COUNT; ++candidate) {
+          bool is_inverse = true;
+          for (int spot = 0; spot < SPOT_COUNT; ++spot) {
+            is_inverse = is_inverse && tables.spots[candidate][tables.spots[transform][spot]] == spot;
+          }
+          if (is_inverse) {
+            tables.inverse[transform] = candidate;
+          }
+        }
+      }
+      return tables;
+    }
+
+    constexpr Tables TABLES = Generate();
+  }
+
+  int TransformSpot(int spot, int transform) {
+    return TABLES.spots[transform][spot];
+  }
+
+  int InverseTransform(int transform) {
+    return TABLES.inverse[transform];
+  }
+
+  uint16_t TransformMask(uint16_t mask, int transform) {
+    return TABLES.masks[transform][mask];
+  }
+
+  /* ------------------------------------------------------------------------------------
+   * FUNCTION NAME: Canonicalize
+   * ------------------------------------------------------------------------------------
+   * @brief Finds the canonical form of a position: 16 table lookups and 8 compares.
+   *
+   * @details A move found on the canonical position is played on the original board at
+   *          TransformSpot(spot, InverseTransform(transform)).
+   *
+   * @return The canonical position and the transform that produces it.
+   * ------------------------------------------------------------------------------------
+   */
+  CanonicalPosition Canonicalize(uint16_t x_mask, uint16_t o_mask) {
+    CanonicalPosition best = { x_mask, o_mask, 0 };
+    uint32_t best_packed = (static_cast<uint32_t>(x_mask) << SPOT_COUNT) | o_mask;
+    for (int transform = 1; transform < TRANSFORM_COUNT; ++transform) {
+      uint16_t x = TABLES.masks[transform][x_mask];
+      uint16_t o = TABLES.masks[transform][o_mask];
+      uint32_t packed = (static_cast<uint32_t>(x) << SPOT_COUNT) | o;
+      if (packed < best_packed) {
+        best_packed = packed;
+        best.x_mask = x;
+        best.o_mask = o;
+        best.transform = static_cast<uint8_t>(transform);
+      }
+    }
+
+    return best;
+  }
+
+  CanonicalPosition Canonicalize(const Game& game) {
+    return Canonicalize(game.GetMask('X'), game.GetMask('O'));
+  }
+}
+
+namespace PositionIndex {
+  namespace {
+    const int SPOT_COUNT = 9;
+
+    struct Index {
+      uint16_t x_codes[1 << SPOT_COUNT];  // The base-3 code of an X mask (1 per X spot).
+      uint16_t o_codes[1 << SPOT_COUNT];  // The base-3 code of an O mask (2 per O spot).
+      int16_t index_of_code[BOARD_CODE_COUNT];  // -1 for a board that is not canonical and reachable.
+      BoardSymmetry::CanonicalPosition positions[POSITION_COUNT];
+
+      Index() {
+        for (int mask = 0; mask < (1 << SPOT_COUNT); ++mask) {
+          int code = 0;
+          for (int spot = SPOT_COUNT - 1; spot >= 0; --spot) {
+            code = code * 3 + ((mask >> spot) & 1);
+          }
+          x_codes[mask] = static_cast<uint16_t>(code);
+          o_codes[mask] = static_cast<uint16_t>(2 * code);
+        }
+        std::vector<uint32_t> canonical;
+        Game game;
+        Collect(game, 'X', canonical);
+        std::sort(canonical.begin(), canonical.end());
+        canonical.erase(std::unique(canonical.begin(), canonical.end()), canonical.end());
+        if (canonical.size() != POSITION_COUNT) {
+          throw std::runtime_error("Error! Unexpected number of canonical positions.");
+        }
+        std::fill(index_of_code, index_of_code + BOARD_CODE_COUNT, -1);
+        for (int index = 0; index < POSITION_COUNT; ++index) {
+          uint16_t x_mask = static_cast<uint16_t>(canonical[index] >> SPOT_COUNT);
+          uint16_t o_mask = static_cast<uint16_t>(canonical[index] & ((1 << SPOT_COUNT) - 1));
+          BoardSymmetry::CanonicalPosition position = { x_mask, o_mask, 0 };
+          positions[index] = position;
+          index_of_code[x_codes[x_mask] + o_codes[o_mask]] = static_cast<int16_t>(index);
+        }
+      }
+
+      /* Walks every game from a position, collecting the packed canonical positions. */
+      static void Collect(Game& game, char letter, std::vector<uint32_t>& canonical) {
+        BoardSymmetry::CanonicalPosition position = BoardSymmetry::Canonicalize(game);
+        canonical.push_back((static_cast<uint32_t>(position.x_mask) << SPOT_COUNT) | position.o_mask);
+        if (game.IsWinner('X') || game.IsWinner('O')) {
+          return;
+        }
+        for (int row = 1; row <= 3; ++row) {
+          for (int column = 1; column <= 3; ++column) {
+            if (game.IsMoveValid(row, column)) {
+              game.InsertMove(row, column, letter);
+              Collect(game, letter == 'X' ? 'O' : 'X', canonical);
+              game.RemoveMove(row, column);
+            }
+          }
+        }
+      }
+    };
+
+    const Index& GetIndex() {
+      static const Index index;
+      return index;
+    }
+  }
+
+  /* ------------------------------------------------------------------------------------
+   * FUNCTION NAME: BoardCode
+   * ------------------------------------------------------------------------------------
+   * @brief Numbers a board in base 3, 0 to BOARD_CODE_COUNT - 1, with two lookups.
+   * ------------------------------------------------------------------------------------
+   */
+  int BoardCode(uint16_t x_mask, uint16_t o_mask) {
+    const Index& index = GetIndex();
+    return index.x_codes[x_mask] + index.o_codes[o_mask];
+  }
+
+  /* ------------------------------------------------------------------------------------
+   * FUNCTION NAME: IndexOf
+   * ------------------------------------------------------------------------------------
+   * @brief Finds the dense index of a position, through its canonical form.
+   *
+   * @return The index (0 to POSITION_COUNT - 1), shared with every symmetric position,
+   *         or -1 for a position that cannot come up in a game.
+   * ------------------------------------------------------------------------------------
+   */
+  int IndexOf(uint16_t x_mask, uint16_t o_mask) {
+    const Index& index = GetIndex();
+    BoardSymmetry::CanonicalPosition position = BoardSymmetry::Canonicalize(x_mask, o_mask);
+    return index.index_of_code[index.x_codes[position.x_mask] + index.o_codes[position.o_mask]];
+  }
+
+  int IndexOf(const Game& game) {
+    return IndexOf(game.GetMask('X'), game.GetMask('O'));
+  }
+
+  BoardSymmetry::CanonicalPosition PositionAt(int index) {
+    return GetIndex().positions[index];
+  }
+}
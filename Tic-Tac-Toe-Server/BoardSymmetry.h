@@ -0,0 +1,61 @@
+#ifndef BoardSymmetry_h
+#define BoardSymmetry_h
+#include "Game.h"
+#include <cstdint>
+
+/* -------------------------------------------------------------------------------------
+ * NAMESPACE NAME: BoardSymmetry
+ * -------------------------------------------------------------------------------------
+ * @brief The 8 symmetries of the 3x3 board, and the canonical form of a position.
+ *
+ * Transform t (0-7) mirrors the board left to right when t >= 4 and then turns it
+ * t % 4 quarter turns clockwise; transform 0 leaves it as it is. Positions that are
+ * mirror images or rotations of each other play the same, so analysis is done on one
+ * representative of each: the canonical position, the transform of a position whose
+ * packed board (X mask above O mask, as Game::PackBoard) is the smallest.
+ *
+ * Spots are 0-based, spot (row, column) being (row - 1) * 3 + (column - 1).
+ * -------------------------------------------------------------------------------------
+ */
+namespace BoardSymmetry {
+  const int TRANSFORM_COUNT = 8;
+
+  /* A canonical position, and the transform that took the original position to it. */
+  struct CanonicalPosition {
+    uint16_t x_mask;
+    uint16_t o_mask;
+    uint8_t transform;
+  };
+
+  int TransformSpot(int spot, int transform);
+  int InverseTransform(int transform);
+  uint16_t TransformMask(uint16_t mask, int transform);
+  CanonicalPosition Canonicalize(uint16_t x_mask, uint16_t o_mask);
+  CanonicalPosition Canonicalize(const Game& game);
+}
+
+/* -------------------------------------------------------------------------------------
+ * NAMESPACE NAME: PositionIndex
+ * -------------------------------------------------------------------------------------
+ * @brief A dense index, 0 to POSITION_COUNT - 1, of the canonical 3x3 positions that
+ *        can come up in a game.
+ *
+ * There are 5478 positions reachable from the empty board (stopping at a win), but
+ * only 765 once symmetric ones are counted once. Tables of analysis, caches and
+ * statistics indexed by IndexOf are therefore shared by all 8 symmetric positions and
+ * are a fraction of the size of tables over every board.
+ *
+ * BoardCode numbers every board, symmetric or not, reachable or not, in base 3 (one
+ * digit per spot: 0 empty, 1 X, 2 O), for tables that need an entry per board.
+ * -------------------------------------------------------------------------------------
+ */
+namespace PositionIndex {
+  const int POSITION_COUNT   = 765;
+  const int BOARD_CODE_COUNT = 19683;  // 3^9: every way of filling the board.
+
+  int BoardCode(uint16_t x_mask, uint16_t o_mask);
+  int IndexOf(uint16_t x_mask, uint16_t o_mask);
+  int IndexOf(const Game& game);
+  BoardSymmetry::CanonicalPosition PositionAt(int index);
+}
+#endif /* BoardSymmetry_h */
@@ -1,5 +1,6 @@
 #ifndef Game_h
 #define Game_h
+#include "BasicGame.h"
 #include <iostream>
 
 /* ---------------------------------------------------------------------
@@ -9,19 +10,16 @@
  *
  * The Game class provides functions for initializing the game board,
  * displaying the current state of the board, and determining the winner.
+ *
+ * Game is the 3x3, three in a row instance of BasicGame, the board the
+ * server plays with its clients, compiled once in Game.cpp. The other
+ * variants the engine is specialized for are named below.
  * ---------------------------------------------------------------------
  *
  */
-class Game {
-  public:
-    Game();
-    std::string DisplayGameBoard();
-    bool IsMoveValid(const int row, const int column);
-    void InsertMove(const int row, const int column, const char letter);
-    bool IsWinner(const char letter);
-  
-  private:
-    const int BOARD_SIZE = 3;
-    char game_board[3][3];
-};
+typedef BasicGame<3, 3, 3>   Game;
+typedef BasicGame<4, 4, 4>   FourByFourGame;
+typedef BasicGame<15, 15, 5> GomokuGame;
+
+extern template class BasicGame<3, 3, 3>;
 #endif /* Game_h */
@@ -0,0 +1,408 @@
+#include "GameArchive.h"
+#include "MoveLog.h"
+#include "Status.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+
+constexpr int GameArchive::MOVE_BITS;
+constexpr uint64_t GameArchive::MOVE_MASK;
+constexpr uint32_t GameArchive::BYTE_ORDER_MARK;
+const char GameArchive::FILE_MAGIC[8] = { 'T', 'T', 'T', 'A', 'R', 'C', 'H', '3' };
+
+static_assert(sizeof(GameArchive::Record) == 32, "Two records share a cache line.");
+static_assert(Game::SPOT_COUNT <= (1 << GameArchive::MOVE_BITS), "A spot fits MOVE_BITS bits.");
+
+namespace {
+  bool WriteAll(int file, const char* bytes, size_t size) {
+    while (size > 0) {
+      ssize_t written = write(file, bytes, size);
+      if (written == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return false;
+      }
+      bytes += written;
+      size  -= static_cast<size_t>(written);
+    }
+    return true;
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * CONSTRUCTOR NAME: GameArchive
+ * ------------------------------------------------------------------------------------
+ * @brief Maps an archive into memory, for random access to its records.
+ *
+ * @throws std::runtime_error if the archive cannot be mapped, or is not a whole archive
+ *                            of this machine's byte order.
+ * ------------------------------------------------------------------------------------
+ */
+GameArchive::GameArchive(const std::string& path)
+    : archive_file(-1), mapping(nullptr), mapping_size(0), header(nullptr), records(nullptr), index(nullptr),
+      pending(nullptr) {
+  archive_file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  struct stat status;
+  if (archive_file == -1 || fstat(archive_file, &status) == -1) {
+    if (archive_file != -1) {
+      close(archive_file);
+    }
+    throw std::runtime_error("Error! Opening " + path + ".");
+  }
+  mapping_size = static_cast<size_t>(status.st_size);
+  void* mapped = mapping_size >= sizeof(Header)
+               ? mmap(nullptr, mapping_size, PROT_READ, MAP_SHARED, archive_file, 0) : MAP_FAILED;
+  if (mapped == MAP_FAILED) {
+    close(archive_file);
+    throw std::runtime_error("Error! Mapping " + path + ".");
+  }
+  mapping = static_cast<const char*>(mapped);
+  header  = reinterpret_cast<const Header*>(mapping);
+  if (memcmp(header->magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 || header->byte_order != BYTE_ORDER_MARK ||
+      header->record_size != sizeof(Record) ||
+      header->index_offset != sizeof(Header) + header->record_count * sizeof(Record) ||
+      mapping_size != header->index_offset + header->record_count * sizeof(IndexEntry) +
+                      header->pending_count * sizeof(Record)) {
+    munmap(mapped, mapping_size);
+    close(archive_file);
+    throw std::runtime_error("Error! " + path + " is not a game archive of this machine's byte order.");
+  }
+  records = reinterpret_cast<const Record*>(mapping + sizeof(Header));
+  index   = reinterpret_cast<const IndexEntry*>(mapping + header->index_offset);
+  pending = reinterpret_cast<const Record*>(mapping + header->index_offset +
+                                            header->record_count * sizeof(IndexEntry));
+  madvise(mapped, mapping_size, MADV_RANDOM);
+}
+
+GameArchive::~GameArchive() {
+  munmap(const_cast<char*>(mapping), mapping_size);
+  close(archive_file);
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Compact
+ * ------------------------------------------------------------------------------------
+ * @brief Archives every game a move log holds from its creation to its retirement,
+ *        adding the games finished since the last compaction into path.
+ *
+ * @details The log is read from the archive's log offset (from its start for a new
+ *          archive), keeping the games in progress by shard and game ID, starting from
+ *          the archive's pending records. The archived records are copied over out of
+ *          the mapping in one write, the new ones appended, and the new index entries
+ *          merged into the sorted index. The archive is written to a temporary file,
+ *          synced and renamed over path, so a mapped archive is never seen half written.
+ *
+ * @param log_path The MoveLog to compact; the server may still be appending to it.
+ * @param path     The archive to add to, or to create.
+ *
+ * @throws std::runtime_error if the log cannot be read, is shorter than the part of it
+ *                            already archived, or the archive cannot be written.
+ *
+ * @return The number of games archived by this compaction.
+ * ------------------------------------------------------------------------------------
+ */
+uint64_t GameArchive::Compact(const std::string& log_path, const std::string& path) {
+  MoveLog::Reader reader(log_path);
+  struct stat log_status;
+  if (!reader.IsOpen() || stat(log_path.c_str(), &log_status) == -1) {
+    throw std::runtime_error("Error! There is no move log at " + log_path + ".");
+  }
+  std::unique_ptr<GameArchive> archive;
+  if (access(path.c_str(), F_OK) == 0) {
+    archive.reset(new GameArchive(path));
+  }
+  const uint64_t log_offset = archive ? archive->header->log_offset : 0;
+  if (static_cast<uint64_t>(log_status.st_size) < log_offset) {
+    throw std::runtime_error("Error! " + log_path + " is shorter than the part of it archived in " + path +
+                             "; it is not the log that was archived.");
+  }
+  std::unordered_map<uint64_t, Record> games;  // The games in progress, by Key.
+  const uint64_t archived_count = archive ? archive->header->record_count : 0;
+  for (uint64_t pending_number = 0; archive && pending_number < archive->header->pending_count; ++pending_number) {
+    const Record& record                     = archive->pending[pending_number];
+    games[Key(record.game_id, record.shard)] = record;
+  }
+  std::vector<Record> finished;
+  MoveLog::Record logged;
+  reader.Seek(log_offset);
+  while (reader.Next(logged)) {
+    const uint64_t key = Key(logged.game_id, logged.shard);
+    if (logged.kind == MoveLog::CREATE) {
+      Record& record           = games[key];
+      record                   = Record();
+      record.game_id           = logged.game_id;
+      record.shard             = logged.shard;
+      record.start_nanoseconds = logged.time_nanoseconds;
+      continue;
+    }
+    auto found = games.find(key);
+    if (found == games.end()) {
+      continue;  // A SNAPSHOT, or a game created before the log began.
+    }
+    Record& record = found->second;
+    if (logged.kind == MoveLog::MOVE && record.move_count < 64 / MOVE_BITS) {
+      record.moves |= static_cast<uint64_t>(logged.spot & MOVE_MASK) << (MOVE_BITS * record.move_count);
+      ++record.move_count;
+      if (static_cast<StatusCode>(logged.status) == StatusCode::WIN) {
+        record.result = logged.letter == 'X' ? X_WON : O_WON;
+      } else if (static_cast<StatusCode>(logged.status) == StatusCode::TIE) {
+        record.result = TIE;
+      }
+    } else if (logged.kind == MoveLog::RETIRE) {
+      record.end_nanoseconds = logged.time_nanoseconds;
+      if (record.result == 0) {
+        record.result = ABANDONED;
+      }
+      finished.push_back(record);
+      games.erase(found);
+    }
+  }
+  std::vector<Record> still_pending;
+  still_pending.reserve(games.size());
+  for (const auto& game : games) {
+    still_pending.push_back(game.second);
+  }
+
+  std::vector<IndexEntry> new_entries(finished.size());
+  for (size_t number = 0; number < finished.size(); ++number) {
+    new_entries[number].key               = Key(finished[number].game_id, finished[number].shard);
+    new_entries[number].start_nanoseconds = finished[number].start_nanoseconds;
+    new_entries[number].record_number     = archived_count + number;
+  }
+  std::sort(new_entries.begin(), new_entries.end(), IsIndexedBefore);
+  std::vector<IndexEntry> entries(archived_count + finished.size());
+  const IndexEntry* archived_index = archive ? archive->index : nullptr;
+  std::merge(archived_index, archived_index + archived_count, new_entries.begin(), new_entries.end(),
+             entries.begin(), IsIndexedBefore);
+  Header header = {};
+  memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+  header.byte_order    = BYTE_ORDER_MARK;
+  header.record_size   = sizeof(Record);
+  header.record_count  = entries.size();
+  header.index_offset  = sizeof(Header) + entries.size() * sizeof(Record);
+  header.pending_count = still_pending.size();
+  header.log_offset    = std::max(log_offset, reader.GetCompleteSize());
+
+  const std::string temporary_path = path + ".tmp";
+  int archive_file = open(temporary_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (archive_file == -1) {
+    throw std::runtime_error("Error! Creating " + temporary_path + ".");
+  }
+  bool is_written = WriteAll(archive_file, reinterpret_cast<const char*>(&header), sizeof(header)) &&
+                    (!archive || WriteAll(archive_file, reinterpret_cast<const char*>(archive->records),
+                                          archived_count * sizeof(Record))) &&
+                    WriteAll(archive_file, reinterpret_cast<const char*>(finished.data()),
+                             finished.size() * sizeof(Record)) &&
+                    WriteAll(archive_file, reinterpret_cast<const char*>(entries.data()),
+                             entries.size() * sizeof(IndexEntry)) &&
+                    WriteAll(archive_file, reinterpret_cast<const char*>(still_pending.data()),
+                             still_pending.size() * sizeof(Record)) &&
+                    fdatasync(archive_file) == 0;
+  is_written      = close(archive_file) == 0 && is_written;
+  if (!is_written || rename(temporary_path.c_str(), path.c_str()) == -1) {
+    throw std::runtime_error("Error! Writing " + path + ".");
+  }
+  return finished.size();
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: RunCompact
+ * ------------------------------------------------------------------------------------
+ * @brief Compacts a move log into an archive and prints what the archive now holds.
+ *
+ * @throws std::runtime_error if the log cannot be compacted, see Compact.
+ * ------------------------------------------------------------------------------------
+ */
+void GameArchive::RunCompact(const std::string& log_path, const std::string& path) {
+  const uint64_t archived_count = Compact(log_path, path);
+  GameArchive archive(path);
+  std::cout << "Archived " << archived_count << " games, " << archive.GetCount() << " in all; the archive holds "
+            << log_path << " up to byte " << archive.GetLogOffset() << ", with "
+            << archive.header->pending_count << " games in progress there" << std::endl;
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Find
+ * ------------------------------------------------------------------------------------
+ * @brief Looks a game up in the index.
+ *
+ * @param record_numbers [out] The records of every archived game with the ID, on any
+ *                             shard, by shard and then in the order they started.
+ * ------------------------------------------------------------------------------------
+ */
+void GameArchive::Find(uint32_t game_id, std::vector<uint64_t>& record_numbers) const {
+  record_numbers.clear();
+  const IndexEntry* end   = index + header->record_count;
+  const IndexEntry* entry = std::lower_bound(index, end, Key(game_id, 0),
+                                             [](const IndexEntry& left, uint64_t key) { return left.key < key; });
+  for (; entry != end && entry->key >> 8 == game_id; ++entry) {
+    record_numbers.push_back(entry->record_number);
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Replay
+ * ------------------------------------------------------------------------------------
+ * @brief Re-creates a game's board history, playing its moves with Game::InsertMove.
+ *
+ * @param positions [out] The board after every move of the game.
+ * ------------------------------------------------------------------------------------
+ */
+void GameArchive::Replay(const Record& record, std::vector<Game>& positions) {
+  positions.clear();
+  Game game;
+  for (int move = 0; move < record.move_count; ++move) {
+    const int spot = static_cast<int>((record.moves >> (MOVE_BITS * move)) & MOVE_MASK);
+    if (spot >= Game::SPOT_COUNT) {
+      return;
+    }
+    game.InsertMove(spot / Game::BOARD_COLUMNS + 1, spot % Game::BOARD_COLUMNS + 1, move % 2 == 0 ? 'X' : 'O');
+    positions.push_back(game);
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Scan
+ * ------------------------------------------------------------------------------------
+ * @brief Counts the archived games and their moves by result, and by X's first spot,
+ *        in one pass over the records.
+ * ------------------------------------------------------------------------------------
+ */
+GameArchive::Summary GameArchive::Scan() const {
+  const auto start = std::chrono::steady_clock::now();
+  madvise(const_cast<char*>(mapping), mapping_size, MADV_SEQUENTIAL);
+  Summary summary = {};
+  const uint64_t record_count = header->record_count;
+  for (uint64_t record_number = 0; record_number < record_count; ++record_number) {
+    const Record& record = records[record_number];
+    const uint8_t result = record.result <= ABANDONED ? record.result : 0;
+    summary.move_count += record.move_count;
+    ++summary.results[result];
+    if (record.move_count > 0 && (record.moves & MOVE_MASK) < Game::SPOT_COUNT) {
+      ++summary.results_by_opening[record.moves & MOVE_MASK][result];
+    }
+  }
+  summary.game_count = record_count;
+  summary.seconds    = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  madvise(const_cast<char*>(mapping), mapping_size, MADV_RANDOM);
+  return summary;
+}
+
+const char* GameArchive::ResultName(uint8_t result) {
+  switch (result) {
+    case X_WON:
+      return "X won";
+    case O_WON:
+      return "O won";
+    case TIE:
+      return "tie";
+    case ABANDONED:
+      return "abandoned";
+    default:
+      return "unknown";
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: RunReplay
+ * ------------------------------------------------------------------------------------
+ * @brief Prints the board after every move of the archived game with the ID, or, when
+ *        shards or reused IDs give several games the ID, the record number of each, to
+ *        replay one with RunReplayRecord.
+ *
+ * @throws std::runtime_error if the archive cannot be mapped.
+ * ------------------------------------------------------------------------------------
+ */
+void GameArchive::RunReplay(const std::string& path, uint32_t game_id) {
+  GameArchive archive(path);
+  std::vector<uint64_t> record_numbers;
+  archive.Find(game_id, record_numbers);
+  if (record_numbers.empty()) {
+    std::cout << "Game " << game_id << " is not in the archive." << std::endl;
+    return;
+  }
+  if (record_numbers.size() == 1) {
+    PrintReplay(archive.GetRecord(record_numbers.front()));
+    return;
+  }
+  std::cout << record_numbers.size() << " archived games have the ID " << game_id
+            << "; replay one with --replay-record " << path << " <record>:" << std::endl;
+  for (uint64_t record_number : record_numbers) {
+    const Record& record = archive.GetRecord(record_number);
+    std::cout << "  record " << record_number << ": shard " << static_cast<int>(record.shard) << ", started at "
+              << record.start_nanoseconds << " ns, " << ResultName(record.result) << " after "
+              << static_cast<int>(record.move_count) << " moves" << std::endl;
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: RunReplayRecord
+ * ------------------------------------------------------------------------------------
+ * @brief Prints the board after every move of the archived game of one record.
+ *
+ * @throws std::runtime_error if the archive cannot be mapped.
+ * ------------------------------------------------------------------------------------
+ */
+void GameArchive::RunReplayRecord(const std::string& path, uint64_t record_number) {
+  GameArchive archive(path);
+  if (record_number >= archive.GetCount()) {
+    std::cout << "Record " << record_number << " is not in the archive." << std::endl;
+    return;
+  }
+  PrintReplay(archive.GetRecord(record_number));
+}
+
+/* Prints an archived game's result, then the board after each of its moves. */
+void GameArchive::PrintReplay(const Record& record) {
+  std::vector<Game> positions;
+  std::cout << "----------\nGame " << record.game_id << " of shard " << static_cast<int>(record.shard)
+            << ", started at " << record.start_nanoseconds << " ns: " << ResultName(record.result) << " after "
+            << static_cast<int>(record.move_count) << " moves in "
+            << (record.end_nanoseconds - record.start_nanoseconds) / 1e6 << " ms" << std::endl;
+  Replay(record, positions);
+  for (size_t move = 0; move < positions.size(); ++move) {
+    std::cout << "Move " << move + 1 << ":\n" << positions[move].DisplayGameBoard();
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: RunScan
+ * ------------------------------------------------------------------------------------
+ * @brief Prints the results of every archived game, overall and by X's first spot, and
+ *        how fast Scan read the archive.
+ *
+ * @throws std::runtime_error if the archive cannot be mapped.
+ * ------------------------------------------------------------------------------------
+ */
+void GameArchive::RunScan(const std::string& path) {
+  GameArchive archive(path);
+  Summary summary = archive.Scan();
+  std::cout << "Scanned " << summary.game_count << " games (" << summary.move_count << " moves) in "
+            << summary.seconds * 1000 << " ms: " << summary.game_count / summary.seconds / 1e6 << " million games/s, "
+            << summary.game_count * sizeof(Record) / summary.seconds / 1e9 << " GB/s" << std::endl;
+  std::cout << "  all games:";
+  for (int result = X_WON; result <= ABANDONED; ++result) {
+    std::cout << " " << summary.results[result] << " " << ResultName(static_cast<uint8_t>(result)) << ",";
+  }
+  std::cout << std::endl;
+  for (int spot = 0; spot < Game::SPOT_COUNT; ++spot) {
+    std::cout << "  X opens at row " << spot / Game::BOARD_COLUMNS + 1 << ", column "
+              << spot % Game::BOARD_COLUMNS + 1 << ":";
+    for (int result = X_WON; result <= ABANDONED; ++result) {
+      std::cout << " " << summary.results_by_opening[spot][result] << " " << ResultName(static_cast<uint8_t>(result))
+                << ",";
+    }
+    std::cout << std::endl;
+  }
+}
@@ -0,0 +1,118 @@
+#ifndef GameArchive_h
+#define GameArchive_h
+#include "Game.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* -------------------------------------------------------------------------------------
+ * CLASS NAME: GameArchive
+ * -------------------------------------------------------------------------------------
+ * @brief A read-only, memory-mapped file of finished games, one fixed-size Record per
+ *        game, for replaying any game and for analytics over all of them.
+ *
+ * Compact builds an archive from a MoveLog: every game the log saw created and retired
+ * becomes a Record holding its moves, packed MOVE_BITS bits per move, its result and
+ * the times it started and ended. Compaction is incremental: the header keeps the log
+ * offset it read up to, and the games still in progress there are kept as pending
+ * records, so the next compaction reads the log on from that offset and appends the
+ * games finished since. The log before the offset is never read again; that offset
+ * (with the snapshots' own, for recovery) is how far the log could be cut.
+ *
+ * The file is a Header, then every Record in the order the games ended, then the index,
+ * then the pending records:
+ * an IndexEntry per game, sorted by game ID, shard and start time, for Find to binary
+ * search. A shard reuses a game ID once its generation wraps around, so only the three
+ * together, or the record number, name one game; RunReplay lists the games of an ID
+ * by record number, and RunReplayRecord replays one. Record numbers never change,
+ * as a compaction only appends. The file is in the byte order of the machine that wrote it, so a Record is read straight
+ * out of the mapping; an archive of the other byte order is refused. Scan walks the
+ * records front to back, so the kernel reads the file ahead of it, and a Record is
+ * half a cache line.
+ * -------------------------------------------------------------------------------------
+ */
+class GameArchive {
+  public:
+    enum Result : uint8_t {
+      X_WON     = 1,
+      O_WON     = 2,
+      TIE       = 3,
+      ABANDONED = 4,  // Retired without a win or a tie: forfeited on time or left.
+    };
+
+    struct Record {
+      uint32_t game_id;
+      uint8_t shard;
+      uint8_t move_count;
+      uint8_t result;
+      uint8_t padding;
+      uint64_t moves;  // The spot of move i in bits MOVE_BITS * i and up; X moves first.
+      uint64_t start_nanoseconds;  // Since the Unix epoch.
+      uint64_t end_nanoseconds;
+    };
+
+    /* What Scan found. */
+    struct Summary {
+      uint64_t game_count;
+      uint64_t move_count;
+      uint64_t results[ABANDONED + 1];  // Games by Result.
+      uint64_t results_by_opening[Game::SPOT_COUNT][ABANDONED + 1];  // By X's first spot, then by Result.
+      double seconds;
+    };
+
+    static constexpr int MOVE_BITS      = 4;
+    static constexpr uint64_t MOVE_MASK = (1u << MOVE_BITS) - 1;
+
+    explicit GameArchive(const std::string& path);
+    ~GameArchive();
+    static uint64_t Compact(const std::string& log_path, const std::string& path);
+    uint64_t GetCount() const { return header->record_count; }
+    uint64_t GetLogOffset() const { return header->log_offset; }
+    const Record& GetRecord(uint64_t record_number) const { return records[record_number]; }
+    void Find(uint32_t game_id, std::vector<uint64_t>& record_numbers) const;
+    static void Replay(const Record& record, std::vector<Game>& positions);
+    Summary Scan() const;
+    static const char* ResultName(uint8_t result);
+    static void RunCompact(const std::string& log_path, const std::string& path);
+    static void RunReplay(const std::string& path, uint32_t game_id);
+    static void RunReplayRecord(const std::string& path, uint64_t record_number);
+    static void RunScan(const std::string& path);
+
+  private:
+    struct Header {
+      char magic[8];
+      uint32_t byte_order;  // BYTE_ORDER_MARK as the writer stored it.
+      uint32_t record_size;
+      uint64_t record_count;
+      uint64_t index_offset;
+      uint64_t pending_count;  // Games in progress at log_offset, after the index.
+      uint64_t log_offset;     // The end of the last log record archived.
+    };
+
+    /* Unique per game: a game ID only comes back on its shard once its last game has ended. */
+    struct IndexEntry {
+      uint64_t key;  // The game ID above the shard, see Key.
+      uint64_t start_nanoseconds;
+      uint64_t record_number;
+    };
+
+    static const char FILE_MAGIC[8];
+    static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    int archive_file;
+    const char* mapping;
+    size_t mapping_size;
+    const Header* header;
+    const Record* records;
+    const IndexEntry* index;
+    const Record* pending;
+
+    static void PrintReplay(const Record& record);
+    static bool IsIndexedBefore(const IndexEntry& left, const IndexEntry& right) {
+      return left.key < right.key || (left.key == right.key && left.start_nanoseconds < right.start_nanoseconds);
+    }
+
+    static uint64_t Key(uint32_t game_id, uint8_t shard) { return (static_cast<uint64_t>(game_id) << 8) | shard; }
+};
+#endif /* GameArchive_h */
@@ -3,6 +3,7 @@
 #include "Game.h"
 #include "Status.h"
 #include "PromptingUser.h"
+#include <cstdint>
 
 /* ----------------------------------------------------------------------------
  * CLASS NAME: GameManager
@@ -13,15 +14,86 @@
  * conditions to determine the validity of a move. Additionally, it updates the
  * statuses of the game including, status_code, game_board, and player_symbol
  *
+ * GameManager is BasicGameManager over the 3x3 Game; the same flow runs any
+ * board variant of BasicGame. A manager owns no game: it is a view over the
+ * state of one game kept elsewhere, such as a row of the GameStore, and moves
+ * are played on that state in place.
+ *
  * @note To better understand the tasks of each variable, please refer to the
  *       documentation for the Status structure.
  * ----------------------------------------------------------------------------
  */
-class GameManager {
+template <typename GameType>
+class BasicGameManager {
   public:
-    Status MakeMove(const int row, const int column, const char letter, int count_move);
-  
+    typedef typename GameType::Masks Masks;
+    typedef typename GameType::Mask Mask;
+    static constexpr char NO_SIDE = ' ';  // The side to move of a game that is over.
+
+    BasicGameManager(Mask& x_mask, Mask& o_mask, uint16_t& move_count, char& side_to_move)
+        : x_mask(x_mask), o_mask(o_mask), move_count(move_count), side_to_move(side_to_move) {}
+    Status MakeMove(const int row, const int column, const char letter, int move_counter);
+
   private:
-    Game game;
-};  
+    Mask& x_mask;
+    Mask& o_mask;
+    uint16_t& move_count;
+    char& side_to_move;
+};
+
+template <typename GameType>
+constexpr char BasicGameManager<GameType>::NO_SIDE;
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: MakeMove
+ * ------------------------------------------------------------------------------------
+ * @brief Validates and processes a player's move in the Tic-Tac-Toe game.
+ *
+ * This function checks if the move is valid, updates the game board, and
+ * determines the game status (win, tie, or ongoing).
+ *
+ * @details The move's win is found from the mover's mask and the spot just taken, see
+ *          WinCheck. A move that ends the game leaves no side to move.
+ *
+ * @param row The row index of the move.
+ * @param column The column index of the move.
+ * @param letter The player's symbol ('X' or 'O').
+ * @param move_counter The current move count.
+ * @return Status object containing game information (status code, packed game board, letter).
+ * ------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+Status BasicGameManager<GameType>::MakeMove(const int row, const int column, const char letter, int move_counter) {
+  Status status;
+  const int spot = GameType::Spot(row, column);
+  Mask& mask     = letter == 'X' ? x_mask : o_mask;
+  status.letter  = letter;
+  if (!Masks::Test(x_mask, spot) && !Masks::Test(o_mask, spot)) {
+    Masks::Set(mask, spot);
+    ++move_count;
+    if (WinCheck<GameType::BOARD_ROWS, GameType::BOARD_COLUMNS, GameType::BOARD_WIN_LENGTH>::HasLine(mask, spot)) {
+      // Winner is found.
+      status.status_code = StatusCode::WIN;
+      side_to_move       = NO_SIDE;
+    } else if (move_counter == GameType::SPOT_COUNT) {
+      // Tie Game
+      status.status_code = StatusCode::TIE;
+      side_to_move       = NO_SIDE;
+    } else {
+      // No winner is found. Game continues.
+      status.status_code = StatusCode::UPDATE;
+      side_to_move       = letter == 'X' ? 'O' : 'X';
+    }
+  } else {
+    // Invalid move.
+    status.status_code = StatusCode::ERROR;
+  }
+  status.packed_board = Masks::Pack(x_mask, o_mask);
+
+  return status;
+}
+
+typedef BasicGameManager<Game> GameManager;
+
+extern template class BasicGameManager<Game>;
 #endif /* GameManager_h */
@@ -1,6 +1,17 @@
 #include "GameServer.h"
+#include "GameSnapshots.h"
 #include "RequestManager.h"
-#include <nlohmann/json.hpp>
+#include "HouseRequestManager.h"
+#include "IoUring.h"
+#include "MessageFrame.h"
+#include "MoveParser.h"
+#include "ReplyTable.h"
+#include "SeatTokens.h"
+#include <sys/epoll.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <algorithm>
+#include <cerrno>
 #include <iostream>
 
 namespace DashLine {
@@ -22,34 +33,45 @@ using namespace DashLine;
  **/
 namespace GameInfo {
   IRequestManager *request_manager = new Request_Manager::RequestManager;
-  Game game;
-  GameManager game_manager;
+  IRequestManager *house_player    = new Request_Manager::HouseRequestManager;
   Status status;
   PromptingUser prompting;
   Player player;
 }
 using namespace GameInfo;
 
-/* -------------------------------------------------------------------
- * NAMESPACE NAME: Json
- * -------------------------------------------------------------------
- * @brief Namespace containing utilities for handling JSON data
- *        using the nlohmann::json library.
- *
- * The Json namespace provide a single instance of nlohmann::json,
- * named jsondata, for managing and manipulating JSON data within
- * the application.
+namespace Timeout {
+  // The kind of a timer is kept in the low byte of its payload, the socket above it.
+  const uint64_t MOVE_CLOCK      = 1;
+  const uint64_t IDLE            = 2;
+  const uint64_t SNAPSHOT        = 3;
+  const uint64_t RECOVERED_GAMES = 4;
+  const uint64_t METRICS         = 5;
+  
+  // How long the players of recovered games have to take their seats back when connections
+  // have no idle timeout.
+  const std::chrono::milliseconds RECOVERED_GAME_GRACE(60000);
+  
+  // How often the event loops print their metrics, see ReportMetrics.
+  const std::chrono::milliseconds METRICS_INTERVAL(10000);
+}
+
+/* ----------------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: UseServerPlayer
+ * ----------------------------------------------------------------------------------------------------------
+ * @brief Hands the server's side of every game to a player, in place of the person at the server's terminal
+ *        and of the house player.
  *
- * @note Developers should refer to the [nlohmann::json documentation]
- *       (https://github.com/nlohmann/json) for detailed informaion
- *       on JSON data handling.
- * -------------------------------------------------------------------
+ * @param server_player [in] The player making the server's moves. Call before any game starts; the player
+ *                           is shared by every shard, so its GetMove must be safe to call from many threads
+ *                           at once.
+ * ----------------------------------------------------------------------------------------------------------
  */
-namespace Json {
-  nlohmann::json json_data;
+void GameServer::UseServerPlayer(IRequestManager* server_player) {
+  request_manager = server_player;
+  house_player    = server_player;
 }
 
-
 /* ----------------------------------------------------------------------------------------------------------
  * CONSTRUCTOR NAME: GameServer
  * ----------------------------------------------------------------------------------------------------------
@@ -66,11 +88,17 @@ namespace Json {
  *          It then calls the StartServer() method to perform the socket creation, binding, and
  *          other necessary setup.
  *
+ * @param is_port_shared True for a server shard, whose port is bound by every other shard too.
+ *
  * @throws std::runtime_error if there is an error creating the server socket or starting the server.
  *
  * ----------------------------------------------------------------------------------------------------------
  */
-GameServer::GameServer() : client_address_size(sizeof(client_address)) {
+GameServer::GameServer(bool is_port_shared)
+    : is_port_shared(is_port_shared), client_socket(-1), epoll_socket(-1), client_address_size(sizeof(client_address)),
+      protocol(WireProtocol::JSON), game_id(GameStore::NO_GAME), timers(TimerWheel::Clock::now()),
+      move_time(0), idle_timeout(0), latest_game_id(GameStore::NO_GAME), snapshots(nullptr), shard_index(0),
+      snapshot_interval(0), snapshot_sequence(0), seat_tokens(nullptr), is_rejoin_open(false) {
   // Assign server address to its address and port.
   server_address.sin_family = AF_INET;
   server_address.sin_port = htons(8080);
@@ -81,8 +109,16 @@ GameServer::GameServer() : client_address_size(sizeof(client_address)) {
 }
 
 GameServer::~GameServer() {
+  for (auto& entry : sessions) {
+    close(entry.first);
+  }
+  if (epoll_socket != -1) {
+    close(epoll_socket);
+  }
   close(server_socket);
-  close(client_socket);
+  if (client_socket != -1) {
+    close(client_socket);
+  }
 }
 
 /* -------------------------------------------------------------------------------------------
@@ -96,7 +132,10 @@ GameServer::~GameServer() {
  *
  * @details The method creates a socket using PF_INET (IPv4) and SOCK_STREAM (TCP).
  *          It then sets the SO_REUSEADDR option to allow reusing the same port after the
- *          socket is closed. After that, it binds the socket to the specified server address.
+ *          socket is closed and, for a server shard, the SO_REUSEPORT option so that every shard
+ *          can bind its own socket to the same port. After that, it binds the socket to the
+ *          specified server address; a server that does not share its port fails to bind one
+ *          that is already taken.
  *
  * @throws std::runtime_error if there is an error creating the socket,
  *                            setting socket options, or binding the socket.
@@ -117,6 +156,11 @@ int GameServer::StartServer() {
     throw std::runtime_error("Error! Reusing socket after closure.");
   }
   
+  // Let the kernel spread incoming connections over every shard's socket bound to the port
+  if (is_port_shared && setsockopt(server_socket, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof(yes)) == -1) {
+    throw std::runtime_error("Error! Sharing port between server sockets.");
+  }
+  
   // Bind the socket to an address and port
   if (bind(server_socket, (struct sockaddr*)&server_address, sizeof(server_address)) == -1) {
     throw std::runtime_error("Error! Binding to socket");
@@ -159,33 +203,36 @@ int GameServer::StartListen() {
 /* ------------------------------------------------------------------------------------------------
  * FUNCTION NAME: SendData
  * ------------------------------------------------------------------------------------------------
- * @brief Sends a JSON-formatted string to the connected client through the specified socket.
+ * @brief Sends a reply and the game board to the connected client through the specified socket.
  *
- * This function is responsible for constructing a JSON-formatted string that represents both a
- * status message and game_board updates. The resulting JSON string is then sent to the connected
- * client through the specified socket.
+ * This function is responsible for encoding a reply that represents both a status message and
+ * game_board updates. The encoded reply is then sent to the connected client through the
+ * specified socket.
  *
- * @details The function uses nlohmann json library to create a JSON object containing
- *          the provided status message and game board data. This JSON oject is then serialized
- *          into a string and the string is sent to the client. If an errors occurs during the
+ * @details The reply is taken from ReplyTable, pre-encoded in the protocol the client asked
+ *          for (a JSON-formatted string or the binary layout), with the game board filled in, and
+ *          is sent to the client as a single length-prefixed frame. If an errors occurs during the
  *          sending process, a std::runtime_error is thrown.
  *
- * @param status_message A string containing the status message to be included in the JSON string.
- * @param game_board     A string containing the game board data to be included in the JSON string.
+ * @param reply        The reply to be sent.
+ * @param packed_board The game board to be sent with the reply, packed as by Game::PackBoard.
  *
  * @throws std::runtime_error if an error occurs during sending.
  *
  * @return No explicit return value.
  * ------------------------------------------------------------------------------------------------
  */
-void GameServer::SendData(const char *status_message, const char *game_board) {
-  Json::json_data["status_message"] = status_message;
-  Json::json_data["game_board"]     = status.game_board;
-  std::string serialized_data       = Json::json_data.dump();
-  size_t serialized_data_size       = serialized_data.size();
-  ssize_t data_bytes_sent = send(client_socket, serialized_data.c_str(), serialized_data_size, 0);
-  if (data_bytes_sent == -1) {
-    throw std::runtime_error("Error! Sending data to Client");
+void GameServer::SendData(WireProtocol::Reply reply, uint32_t packed_board) {
+  std::string framed_data;
+  ReplyTable::AppendReply(framed_data, protocol, reply, packed_board);
+  size_t data_bytes_total = 0;
+  while (data_bytes_total < framed_data.size()) {
+    ssize_t data_bytes_sent = send(client_socket, framed_data.data() + data_bytes_total,
+                                   framed_data.size() - data_bytes_total, MSG_NOSIGNAL);
+    if (data_bytes_sent == -1) {
+      throw std::runtime_error("Error! Sending data to Client");
+    }
+    data_bytes_total += data_bytes_sent;
   }
 }
 
@@ -199,56 +246,172 @@ void GameServer::SendData(const char *status_message, const char *game_board) {
  * representing the row number and column number, respectively. The parsed values are stored
  * in the specified array.
  *
- * @details The function uses the nlohmann json library to parse the received JSON-formatted string.
- *          If successful, the parsed row and column numbers are stored in the client_move array.
- *          If an error occurs during parsing, the exception is caught, and an error message is printed
- *          to std::cerr.
+ * @details The numbers are read straight out of the received data by MoveParser, or out of the
+ *          CBOR or MessagePack encoding of the same object, without building a json document or
+ *          allocating. If the data is not a move object, the caller reports it and drops the client,
+ *          so that one client cannot fill std::cerr with a message per frame.
  *
+ * @param protocol The encoding of the received data (JSON, CBOR or MSGPACK).
  * @param received_data A JSON-formatted string containing the row and column numbers.
  * @param client_move Pointer to an array that will store the parsed row and column numbers.
  * @param size The size of the received data (in bytes).
  *
- * @return No explicit return value.
+ * @return True if the row and column numbers were parsed, false otherwise.
  * ----------------------------------------------------------------------------------------------------
  */
-void GameServer::ParseReceivedRowAndColumnNumber(const char *received_data, int *client_move, size_t size) {
-  try {
-    Json::json_data = nlohmann::json::parse(received_data);
-    client_move[0]  = Json::json_data["row"];
-    client_move[1]  = Json::json_data["column"];
-  } catch (const std::exception& e) {
-    std::cerr << "Error parsing JSON: " << e.what() << std::endl;
+bool GameServer::ParseReceivedRowAndColumnNumber(WireProtocol::Protocol protocol, const char *received_data,
+                                                 int *client_move, size_t size) {
+  return MoveParser::ParseEncodedMove(protocol, received_data, size, client_move[0], client_move[1]);
+}
+
+/* ----------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: ParseMove
+ * ----------------------------------------------------------------------------------------------------
+ * @brief Parses a move frame, encoded in the connection's protocol, into a row and column number.
+ *
+ * @details A JSON, CBOR or MessagePack move carries its numbers in Network-Byte-Order and is
+ *          parsed by ParseReceivedRowAndColumnNumber. A binary move is the single byte index of
+ *          the spot.
+ *
+ * @param protocol     The protocol the client asked for in its hello.
+ * @param payload      The payload of the move frame.
+ * @param payload_size The size of the payload (in bytes).
+ * @param player       The player that receives the 1-based row and column number.
+ *
+ * @return True if the payload holds a move on the game board, false otherwise.
+ * ----------------------------------------------------------------------------------------------------
+ */
+bool GameServer::ParseMove(WireProtocol::Protocol protocol, const char* payload, size_t payload_size,
+                           Player& player) {
+  if (protocol == WireProtocol::BINARY) {
+    return WireProtocol::ParseMove(payload, payload_size, player.row, player.column);
+  }
+  int client_move[2] = { 0, 0 };
+  if (!ParseReceivedRowAndColumnNumber(protocol, payload, client_move, payload_size)) {
+    return false;
+  }
+  
+  // Convert Network-Byte-Order integer back into Host-Byte-Order.
+  player.row    = ntohs(client_move[0]);
+  player.column = ntohs(client_move[1]);
+  
+  return player.row >= 1 && player.row <= 3 && player.column >= 1 && player.column <= 3;
+}
+
+/* -----------------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: ReceiveFrame
+ * -----------------------------------------------------------------------------------------------------------
+ * @brief Receives the next length-prefixed frame from the connected client through the specified socket.
+ *
+ * @details Received bytes are collected in the inbound buffer until it holds a complete frame. Bytes of
+ *          a following frame stay in the buffer for the next call. Before a deadline, the socket is polled
+ *          for the time left, so a client that never sends cannot hold the server forever.
+ *
+ * @param payload  The string that receives the payload of the frame.
+ * @param deadline The time the frame must be complete by, or time_point::max() to wait for as long as it takes.
+ *
+ * @throws std::runtime_error if an error occurs during the reception process, or the client disconnects.
+ *
+ * @return True if a frame was received, false if the deadline passed first.
+ * -----------------------------------------------------------------------------------------------------------
+ */
+bool GameServer::ReceiveFrame(std::string& payload, TimerWheel::Clock::time_point deadline) {
+  size_t offset = 0;
+  const char* frame;
+  size_t frame_size;
+  while (!MessageFrame::NextFrame(inbound, offset, frame, frame_size)) {
+    if (deadline != TimerWheel::Clock::time_point::max()) {
+      TimerWheel::Clock::duration left = deadline - TimerWheel::Clock::now();
+      if (left <= TimerWheel::Clock::duration::zero()) {
+        return false;
+      }
+      struct pollfd client_poll = { client_socket, POLLIN, 0 };
+      int ready = poll(&client_poll, 1,
+                       static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(left).count()) + 1);
+      if (ready == -1 && errno != EINTR) {
+        throw std::runtime_error("Error! Waiting for data from Client.");
+      }
+      if (ready <= 0) {
+        continue;
+      }
+    }
+    char received_data[256];
+    ssize_t buffer_bytes_read = recv(client_socket, received_data, sizeof(received_data), 0);
+    if (buffer_bytes_read == -1) {
+      throw std::runtime_error("Error! Receiving data from Client.");
+    }
+    if (buffer_bytes_read == 0) {
+      throw std::runtime_error("Error! Client disconnected.");
+    }
+    inbound.append(received_data, buffer_bytes_read);
   }
+  payload.assign(frame, frame_size);
+  inbound.erase(0, offset);
+  
+  return true;
+}
+
+/* -----------------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: ReceiveHello
+ * -----------------------------------------------------------------------------------------------------------
+ * @brief Receives the client's hello and switches the connection to the protocol it names.
+ *
+ * @throws std::runtime_error if the hello does not name a known protocol, or does not arrive within the
+ *                            idle timeout.
+ * -----------------------------------------------------------------------------------------------------------
+ */
+void GameServer::ReceiveHello() {
+  std::string hello;
+  if (!ReceiveFrame(hello, Deadline(idle_timeout))) {
+    throw std::runtime_error("Error! Client sent no hello in time.");
+  }
+  if (hello.size() != 1 || !WireProtocol::IsProtocol(static_cast<uint8_t>(hello[0]))) {
+    throw std::runtime_error("Error! Client sent an unknown protocol.");
+  }
+  protocol = static_cast<WireProtocol::Protocol>(hello[0]);
 }
 
 /* -----------------------------------------------------------------------------------------------------------
  * FUNCTION NAME: ReceiveData
  * -----------------------------------------------------------------------------------------------------------
- * @brief Receives an serialized JSON-formatted string from the connected client through the specified socket.
+ * @brief Receives a move from the connected client through the specified socket.
  *
  * This function is responsible for receiving data from the client, which is expected to be a
- * serialized JSON-formatted string containing information such as row and column numbers.
+ * move frame, encoded in the protocol the client asked for, containing the row and column numbers.
  *
- * @details The function uses the provided socket to receive a serialized JSON-formatted string
- *          from the client. The received data is then parsed using the nlohmann json library to
- *          extract information. If an error occurs during the reception process, a
+ * @details The function uses ReceiveFrame to receive the next frame from the client. The frame is
+ *          then parsed by ParseMove to extract the row and column numbers. If an error occurs during
+ *          the reception process, or the frame does not hold a move on the game board, a
  *          std::runtime error is thrown.
  *
- * @param client_move Pointer to an array that will store the parsed data (e.g., row and column nubmers).
+ * @param client_move    The player that will store the parsed row and column numbers.
+ * @param deadline       The time the move must be received by.
+ * @param is_out_of_time Set if the deadline passed before a move was received.
  *
- * @throws std::runtime_error if an error occurs during data reception.
+ * @throws std::runtime_error if an error occurs during data reception, or the frame is not a move.
  *
- * @return No explicit return value.
+ * @return True if a move was received before the deadline, false otherwise.
  * -----------------------------------------------------------------------------------------------------------
  */
-void GameServer::ReceiveData(int* client_move) {
-  char received_data[256];
-  ssize_t buffer_bytes_read = recv(client_socket, received_data, sizeof(received_data), 0);
-  if (buffer_bytes_read == -1) {
-    throw std::runtime_error("Error! Receiving row and column number from Client.");
+bool GameServer::ReceiveData(Player& client_move, TimerWheel::Clock::time_point deadline, bool& is_out_of_time) {
+  std::string payload;
+  is_out_of_time = !ReceiveFrame(payload, deadline);
+  if (is_out_of_time) {
+    return false;
+  }
+  if (!ParseMove(protocol, payload.data(), payload.size(), client_move)) {
+    throw std::runtime_error("Error parsing move");
+  }
+  
+  return true;
+}
+
+/* The time a limit from now ends at, or time_point::max() for a limit of 0 (no limit). */
+TimerWheel::Clock::time_point GameServer::Deadline(std::chrono::milliseconds limit) const {
+  if (limit.count() == 0) {
+    return TimerWheel::Clock::time_point::max();
   }
-  received_data[buffer_bytes_read] = '\0';
-  ParseReceivedRowAndColumnNumber(received_data, client_move, buffer_bytes_read);
+  return TimerWheel::Clock::now() + limit;
 }
 
 /* ---------------------------------------------------------------------------------------
@@ -275,42 +438,32 @@ void GameServer::ReceiveData(int* client_move) {
  * ---------------------------------------------------------------------------------------
 */
 bool GameServer::IsServerMove(int move_counter) {
+  GameStore::GameRef game_manager = games.Find(game_id);
   while (1) {
-    std::cout << status.game_board;
-    prompting.PlayerTurn('X');
-    prompting.UserForRowNumber();
-    player.row    = request_manager->GetValidatedUserInput(player.row, 1, 3, 'R');
-    prompting.UserForColumnNumber();
-    player.column = request_manager->GetValidatedUserInput(player.column, 1, 3, 'C');
+    std::cout << game_manager.GetGame().DisplayGameBoard();
+    player        = request_manager->GetMove(game_manager.GetGame(), 'X');
     status        = game_manager.MakeMove(player.row, player.column, 'X', move_counter);
-    if (status.status_code == "Gameover") {
-      if (move_counter == 9 && status.letter == 'T') {
-        std::cout << status.game_board;
-        std::cout << "TIE GAME" << std::endl;
-        const char* tie_game_message = "TIE GAME";
-        const char* final_game_board = status.game_board.c_str();
-        SendData(tie_game_message, final_game_board);
-        
-        // Successful sending tie message and game board to Client.
-        return true;
-      }
-      std::cout << status.game_board;
+    if (status.status_code == StatusCode::TIE) {
+      std::cout << game_manager.GetGame().DisplayGameBoard();
+      std::cout << "TIE GAME" << std::endl;
+      SendData(WireProtocol::TIE_GAME, status.packed_board);
+      
+      // Successful sending tie message and game board to Client.
+      return true;
+    } else if (status.status_code == StatusCode::WIN) {
+      std::cout << game_manager.GetGame().DisplayGameBoard();
       std::cout << "You win" << std::endl;
-      const char* winning_message = "Server won";
-      const char* game_board      = status.game_board.c_str();
-      SendData(winning_message, game_board);
+      SendData(WireProtocol::SERVER_WON, status.packed_board);
       
       // Successful sending winning message and game board to Client.
       return true;
-    } else if (status.status_code == "Error") {
+    } else if (status.status_code == StatusCode::ERROR) {
       std::cerr << "Invalid move. Please try again." << std::endl;
       continue;
     }
-    const char* update_message = "Player X move:";
-    const char* game_board     = status.game_board.c_str();
-    SendData(update_message, game_board);
+    SendData(WireProtocol::PLAYER_X_MOVED, status.packed_board);
     std::cout << "Your move was a success." << std::endl;
-    std::cout << game_board;
+    std::cout << game_manager.GetGame().DisplayGameBoard();
     break;
   }               // End of Server move.
   
@@ -322,10 +475,10 @@ bool GameServer::IsServerMove(int move_counter) {
  * ---------------------------------------------------------------------------------------
  * @brief Process a move received from the Client.
  *
- * This function receives an integer array representing a move from the client.
- * consisting of two integers representing the row and column. After receiving
- * and parsing the data, it validates whether the client's chosen location is
- * available and checks if the client is the winner.
+ * This function receives a move from the client, consisting of the row and
+ * column number. After receiving and parsing the data, it validates whether
+ * the client's chosen location is available and checks if the client is the
+ * winner.
  *
  * @details If the client's chosen location is available, the game board is updated, and
  *          a success message is sent to the client. The program continues, and the server
@@ -338,43 +491,48 @@ bool GameServer::IsServerMove(int move_counter) {
  *          If the client is the winner, a game-winning message is sent to the client,
  *          the program terminates.
  *
+ *          If the client does not move within the move time (see EnableTimeouts), it
+ *          loses the game and is told it ran out of time.
+ *
  * @param  move_counter The current move counter.
  *
  * @return True if the game is over (client won), false otherwise.
  * ---------------------------------------------------------------------------------------
  */
 bool GameServer::IsClientMove(int move_counter) {
+  GameStore::GameRef game_manager = games.Find(game_id);
+  // The move clock, or failing that the idle timeout, bounds the wait for the whole move.
+  TimerWheel::Clock::time_point deadline = Deadline(move_time.count() > 0 ? move_time : idle_timeout);
   while (1) {
-    int client_move[2];
-    ReceiveData(client_move);
-    
-    // Convert Network-Byte-Order integer back into Host-Byte-Order.
-    int client_row    = ntohs(client_move[0]);
-    int client_column = ntohs(client_move[1]);
-    status            = game_manager.MakeMove(client_row, client_column, 'O', move_counter);
-    if (status.status_code == "Gameover") {
+    Player client_move;
+    bool is_out_of_time;
+    if (!ReceiveData(client_move, deadline, is_out_of_time)) {
+      Dashes();
+      std::cout << game_manager.GetGame().DisplayGameBoard();
+      std::cout << "Client ran out of time" << std::endl;
+      Dashes();
+      SendData(WireProtocol::OUT_OF_TIME, game_manager.PackBoard());
+      return true;
+    }
+    status = game_manager.MakeMove(client_move.row, client_move.column, 'O', move_counter);
+    if (status.status_code == StatusCode::WIN || status.status_code == StatusCode::TIE) {
       Dashes();
-      std::cout << status.game_board;
-      std::cout << "Client Won" << std::endl;
+      std::cout << game_manager.GetGame().DisplayGameBoard();
+      std::cout << (status.status_code == StatusCode::WIN ? "Client Won" : "TIE GAME") << std::endl;
       Dashes();
-      const char* winning_message    = "You win";
-      const char* winning_game_board = status.game_board.c_str();
-      SendData(winning_message, winning_game_board);
+      SendData(status.status_code == StatusCode::WIN ? WireProtocol::CLIENT_WON : WireProtocol::TIE_GAME,
+               status.packed_board);
       
       // Successful sending winning message and game board to Client.
       return true;
-    } else if (status.status_code == "Error") {
-      const char* error_message = "Spot unavailable. Please try again.";
-      const char* game_board    = status.game_board.c_str();
-      SendData(error_message, game_board);
+    } else if (status.status_code == StatusCode::ERROR) {
+      SendData(WireProtocol::SPOT_UNAVAILABLE, status.packed_board);
       
       // Successful sending error message to Client.
       continue;
     } else {
       std::cout << "Received player O move." << std::endl;
-      const char* success_message = "Your move was a success.";
-      const char* game_board      = status.game_board.c_str();
-      SendData(success_message, game_board);
+      SendData(WireProtocol::MOVE_ACCEPTED, status.packed_board);
       // Successful sending success message to Client.
     }
     break;
@@ -384,8 +542,9 @@ bool GameServer::IsClientMove(int move_counter) {
 }
 
 void GameServer::LaunchGame() {
-  // Assign game_board to initial Game Board.
-  status.game_board = game.DisplayGameBoard();
+  ReceiveHello();
+  game_id = games.Create();
+  
   int count_move = 1;
   while (1) {
     if (IsServerMove(count_move++)) {
@@ -396,3 +555,1396 @@ void GameServer::LaunchGame() {
     }
   }
 }
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: StartEventLoop
+ * ------------------------------------------------------------------------------------------------
+ * @brief Host one independent Tic-Tac-Toe game per client connection off an epoll event loop.
+ *
+ * This method switches the server socket to non-blocking mode, registers it with an
+ * edge-triggered epoll instance and then waits for readiness events. Every client that
+ * connects gets its own Session (socket, game and move counter), so any number
+ * of games are played at the same time by a single server process.
+ *
+ * @details Edge-triggered events are only reported when the state of a socket changes, so
+ *          every handler drains its socket until the kernel reports EAGAIN: AcceptClients
+ *          accepts every pending connection, ReadFromClient reads every pending byte and
+ *          WriteToClient sends every queued byte. epoll_wait sleeps until the next timer of
+ *          ExpireTimers is due, if there is one.
+ *
+ * @throws std::runtime_error if there is an error during listening or setting up epoll.
+ *
+ * @return Does not return under normal operation.
+ * ------------------------------------------------------------------------------------------------
+ */
+int GameServer::StartEventLoop() {
+  if (listen(server_socket, SOMAXCONN) == -1) {
+    throw std::runtime_error("Error! listening for Client connection.");
+  }
+  if (fcntl(server_socket, F_SETFL, fcntl(server_socket, F_GETFL, 0) | O_NONBLOCK) == -1) {
+    throw std::runtime_error("Error! Setting server socket to non-blocking.");
+  }
+  epoll_socket = epoll_create1(0);
+  if (epoll_socket == -1) {
+    throw std::runtime_error("Error! Creating epoll instance.");
+  }
+  struct epoll_event server_event;
+  server_event.events  = EPOLLIN | EPOLLET;
+  server_event.data.fd = server_socket;
+  if (epoll_ctl(epoll_socket, EPOLL_CTL_ADD, server_socket, &server_event) == -1) {
+    throw std::runtime_error("Error! Registering server socket with epoll.");
+  }
+  std::cout << "Server is listening for incoming connections..." << std::endl;
+  timers.Schedule(TimerWheel::Clock::now() + Timeout::METRICS_INTERVAL, Timeout::METRICS);
+  
+  const int maximum_events = 256;
+  struct epoll_event events[maximum_events];
+  while (1) {
+    ExpireTimers();
+    int ready_events = epoll_wait(epoll_socket, events, maximum_events, MillisecondsToNextTimer());
+    if (ready_events == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::runtime_error("Error! Waiting for epoll events.");
+    }
+    for (int index = 0; index < ready_events; ++index) {
+      int socket = events[index].data.fd;
+      if (socket == server_socket) {
+        AcceptClients();
+        continue;
+      }
+      auto found = sessions.find(socket);
+      if (found == sessions.end()) {
+        continue;  // Session was closed by an earlier event of this batch.
+      }
+      Session& session = found->second;
+      if (events[index].events & (EPOLLERR | EPOLLHUP)) {
+        CloseSession(socket);
+        continue;
+      }
+      if (events[index].events & EPOLLOUT) {
+        WriteToClient(session);
+      }
+      if (events[index].events & EPOLLIN && sessions.count(socket) != 0) {
+        ReadFromClient(session);
+      }
+    }
+  }
+  
+  return EXIT_SUCCESS;
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: AcceptClients
+ * ------------------------------------------------------------------------------------------------
+ * @brief Accept every pending client connection and start a session for each of them.
+ *
+ * Each accepted socket is made non-blocking and registered for edge-triggered input and
+ * output events. The session has no game until its client's hello has been received, see
+ * StartGame.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::AcceptClients() {
+  while (1) {
+    int socket = accept4(server_socket, nullptr, nullptr, SOCK_NONBLOCK);
+    if (socket == -1) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        std::cerr << "Error! Connecting to Client" << std::endl;
+      }
+      return;  // No more pending connections.
+    }
+    struct epoll_event client_event;
+    client_event.events  = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    client_event.data.fd = socket;
+    if (epoll_ctl(epoll_socket, EPOLL_CTL_ADD, socket, &client_event) == -1) {
+      std::cerr << "Error! Registering client socket with epoll." << std::endl;
+      close(socket);
+      continue;
+    }
+    Session& session        = sessions[socket];
+    session.client_socket   = socket;
+    session.move_counter    = 1;
+    session.is_closing      = false;
+    session.is_closed       = false;
+    session.recv_armed      = false;
+    session.send_in_flight  = false;
+    session.is_greeted      = false;
+    session.game_id         = GameStore::NO_GAME;
+    session.letter          = 'O';
+    session.opponent_socket = -1;
+    session.is_waiting      = false;
+    session.is_spectator    = false;
+    session.move_timer      = TimerWheel::NO_TIMER;
+    session.idle_timer      = TimerWheel::NO_TIMER;
+    TouchSession(session);
+  }
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: ReadFromClient
+ * ------------------------------------------------------------------------------------------------
+ * @brief Read every pending byte of a client socket into the session's inbound buffer.
+ *
+ * The session is closed when the client disconnects or the socket reports an error.
+ * Otherwise, the received bytes are handed to HandleClientData.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::ReadFromClient(Session& session) {
+  char received_data[256];
+  while (1) {
+    ssize_t buffer_bytes_read = recv(session.client_socket, received_data, sizeof(received_data), 0);
+    if (buffer_bytes_read > 0) {
+      session.inbound.append(received_data, buffer_bytes_read);
+      continue;
+    }
+    if (buffer_bytes_read == -1 && errno == EINTR) {
+      continue;
+    }
+    if (buffer_bytes_read == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;  // Socket is drained.
+    }
+    CloseSession(session.client_socket);  // Client disconnected or the socket failed.
+    return;
+  }
+  HandleClientData(session);
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: WriteToClient
+ * ------------------------------------------------------------------------------------------------
+ * @brief Send as many queued bytes of the session as the client socket accepts.
+ *
+ * Bytes the socket does not accept yet stay in the outbound buffer and are sent on the
+ * next EPOLLOUT event. A session whose game is over is closed once its outbound buffer
+ * is empty.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::WriteToClient(Session& session) {
+  if (session.is_spectator) {
+    WriteUpdates(session);
+    return;
+  }
+  while (!session.outbound.empty()) {
+    ssize_t data_bytes_sent = send(session.client_socket, session.outbound.data(),
+                                   session.outbound.size(), MSG_NOSIGNAL);
+    if (data_bytes_sent == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return;  // Wait for the next EPOLLOUT event.
+      }
+      CloseSession(session.client_socket);
+      return;
+    }
+    session.outbound.erase(0, data_bytes_sent);
+  }
+  if (session.is_closing) {
+    CloseSession(session.client_socket);
+  }
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: HandleClientData
+ * ------------------------------------------------------------------------------------------------
+ * @brief Play every complete move frame of the inbound buffer.
+ *
+ * The first frame of a session is the client's hello, which names the protocol of every
+ * following frame; once it is received the house player makes the first move, just like
+ * the person at the server's terminal does in LaunchGame. Every following frame holds one
+ * move, and all of them are played in order, so a client may pipeline several moves in
+ * one write. With matchmaking, the hello puts the client in the MatchQueue instead, and
+ * the moves of a client paired with another client are played by MakePairedMove. A watch
+ * hello makes the session a spectator of a game instead, see WatchGame, and every frame it
+ * sends afterwards is ignored. The bytes of an incomplete frame are kept until more bytes
+ * arrive. A session that sends an oversized frame, an unknown protocol or a move that cannot
+ * be parsed is closed.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::HandleClientData(Session& session) {
+  size_t offset = 0;
+  const char* payload;
+  size_t payload_size;
+  try {
+    while (!session.is_closing && MessageFrame::NextFrame(session.inbound, offset, payload, payload_size)) {
+      if (!session.is_greeted) {
+        uint32_t watched_game_id;
+        if (WireProtocol::ParseWatchHello(payload, payload_size, session.protocol, watched_game_id)) {
+          session.is_greeted = true;
+          if (!WatchGame(session, watched_game_id)) {
+            return;
+          }
+          continue;
+        }
+        uint32_t rejoined_game_id;
+        uint64_t seat_token;
+        if (WireProtocol::ParseRejoinHello(payload, payload_size, session.protocol, rejoined_game_id, seat_token)) {
+          session.is_greeted = true;
+          if (!RejoinGame(session, rejoined_game_id, seat_token)) {
+            return;
+          }
+          continue;
+        }
+        if (payload_size != 1 || !WireProtocol::IsProtocol(static_cast<uint8_t>(payload[0]))) {
+          CloseSession(session.client_socket);
+          return;
+        }
+        session.protocol   = static_cast<WireProtocol::Protocol>(payload[0]);
+        session.is_greeted = true;
+        if (match_queue) {
+          JoinMatch(session);
+        } else {
+          session.game_id = StartGame(GameStore::HOUSE_PLAYER, session.client_socket);
+          MakeServerMove(session);
+        }
+        continue;
+      }
+      if (session.is_spectator) {
+        continue;
+      }
+      Player player;
+      if (!ParseMove(session.protocol, payload, payload_size, player)) {
+        std::cerr << "Error parsing move" << std::endl;
+        CloseSession(session.client_socket);
+        return;
+      }
+      if (session.opponent_socket != -1) {
+        MakePairedMove(session, sessions.find(session.opponent_socket)->second, player);
+      } else if (session.is_waiting) {
+        // The game has not started yet, or its opponent has not taken its seat back.
+        QueueData(session, WireProtocol::SPOT_UNAVAILABLE,
+                  session.game_id == GameStore::NO_GAME ? 0 : games.Find(session.game_id).PackBoard());
+      } else {
+        MakeClientMove(session, player);
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    CloseSession(session.client_socket);
+    return;
+  }
+  session.inbound.erase(0, offset);
+  FlushSession(session);
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: MakeServerMove
+ * ------------------------------------------------------------------------------------------------
+ * @brief Play the house player's move in a session and queue the result for the client.
+ *
+ * @details Mirrors IsServerMove: a winning or tie game board ends the game, otherwise the
+ *          updated game board is queued and control is given to the client.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::MakeServerMove(Session& session) {
+  GameStore::GameRef game_manager = games.Find(session.game_id);
+  Player house_move  = house_player->GetMove(game_manager.GetGame(), 'X');
+  Status move_status = game_manager.MakeMove(house_move.row, house_move.column, 'X', session.move_counter++);
+  switch (move_status.status_code) {
+    case StatusCode::WIN:
+      session.is_closing = true;
+      QueueData(session, WireProtocol::SERVER_WON, move_status.packed_board);
+      PublishUpdate(session.game_id, WireProtocol::X_WON, move_status.packed_board);
+      break;
+    case StatusCode::TIE:
+      session.is_closing = true;
+      QueueData(session, WireProtocol::TIE_GAME, move_status.packed_board);
+      PublishUpdate(session.game_id, WireProtocol::TIE_GAME, move_status.packed_board);
+      break;
+    default:
+      QueueData(session, WireProtocol::PLAYER_X_MOVED, move_status.packed_board);
+      PublishUpdate(session.game_id, WireProtocol::PLAYER_X_MOVED, move_status.packed_board);
+      StartMoveClock(session);
+      break;
+  }
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: MakeClientMove
+ * ------------------------------------------------------------------------------------------------
+ * @brief Play a client's move in its session and queue the result for the client.
+ *
+ * @details Mirrors IsClientMove: an unavailable spot is reported and the
+ *          client is asked again, a winning move ends the game, and a successful move is
+ *          followed by the house player's move.
+ *
+ * @param session The session the move belongs to.
+ * @param player  The 1-based row and column number received from the client.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::MakeClientMove(Session& session, const Player& player) {
+  Status move_status = games.Find(session.game_id).MakeMove(player.row, player.column, 'O', session.move_counter);
+  switch (move_status.status_code) {
+    case StatusCode::WIN:
+      session.is_closing = true;
+      QueueData(session, WireProtocol::CLIENT_WON, move_status.packed_board);
+      PublishUpdate(session.game_id, WireProtocol::O_WON, move_status.packed_board);
+      return;
+    case StatusCode::TIE:
+      session.is_closing = true;
+      QueueData(session, WireProtocol::TIE_GAME, move_status.packed_board);
+      PublishUpdate(session.game_id, WireProtocol::TIE_GAME, move_status.packed_board);
+      return;
+    case StatusCode::ERROR:
+      QueueData(session, WireProtocol::SPOT_UNAVAILABLE, move_status.packed_board);
+      return;
+    case StatusCode::UPDATE:
+      break;
+  }
+  ++session.move_counter;
+  QueueData(session, WireProtocol::MOVE_ACCEPTED, move_status.packed_board);
+  PublishUpdate(session.game_id, WireProtocol::PLAYER_O_MOVED, move_status.packed_board);
+  MakeServerMove(session);
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: EnableMatchmaking
+ * ------------------------------------------------------------------------------------------------
+ * @brief Pair the event loop's clients into games with each other, see MatchQueue.
+ *
+ * @param bot_wait The longest a client waits for another client before it plays the house player.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::EnableMatchmaking(std::chrono::milliseconds bot_wait) {
+  match_queue.reset(new MatchQueue(bot_wait));
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: JoinMatch
+ * ------------------------------------------------------------------------------------------------
+ * @brief Pair a greeted client with the client waiting longest, or make it wait.
+ *
+ * @details The waiting client plays X: it is told so and moves first. The new client plays O,
+ *          on the waiting client's game, and hears of X's move like it would of the house
+ *          player's. A client that finds nobody waiting is queued until ExpireMatches.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::JoinMatch(Session& session) {
+  int opponent_socket;
+  if (!match_queue->Join(session.client_socket, MatchQueue::Clock::now(), opponent_socket)) {
+    session.is_waiting = true;
+    return;
+  }
+  // A waiting session leaves the queue when it is closed, so the opponent is still there.
+  Session& opponent = sessions.find(opponent_socket)->second;
+  opponent.game_id         = StartGame(opponent.client_socket, session.client_socket);
+  session.game_id          = opponent.game_id;
+  session.letter           = 'O';
+  session.opponent_socket  = opponent.client_socket;
+  opponent.is_waiting      = false;
+  opponent.letter          = 'X';
+  opponent.opponent_socket = session.client_socket;
+  QueueData(opponent, WireProtocol::PLAYING_X, games.Find(opponent.game_id).PackBoard());
+  StartMoveClock(opponent);
+  FlushSession(opponent);
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: StartGame
+ * ------------------------------------------------------------------------------------------------
+ * @brief Create the game of a client against the house player or of a pair of clients, once it
+ *        starts, and make it the game spectators of the latest game watch.
+ *
+ * @details Sessions get no game before then, so a spectator or a client still waiting for an
+ *          opponent never leaves an empty game in the GameStore or the move log. With EnableRejoin,
+ *          every client is sent the token of its seat, ahead of the first reply of its game.
+ *
+ * @param x_socket The socket of the client playing X, or GameStore::HOUSE_PLAYER for the house player.
+ * @param o_socket The socket of the client playing O.
+ *
+ * @return The ID of the new game.
+ * ------------------------------------------------------------------------------------------------
+ */
+GameStore::GameId GameServer::StartGame(int x_socket, int o_socket) {
+  latest_game_id = games.Create();
+  games.Find(latest_game_id).SetPlayers(x_socket, o_socket);
+  if (seat_tokens) {
+    const bool is_house_game = x_socket == GameStore::HOUSE_PLAYER;
+    if (!is_house_game) {
+      Session& x_session = sessions.find(x_socket)->second;
+      ReplyTable::AppendSeat(x_session.outbound, x_session.protocol, latest_game_id,
+                             seat_tokens->Issue(shard_index, latest_game_id, 'X', false));
+    }
+    Session& o_session = sessions.find(o_socket)->second;
+    ReplyTable::AppendSeat(o_session.outbound, o_session.protocol, latest_game_id,
+                           seat_tokens->Issue(shard_index, latest_game_id, 'O', is_house_game));
+  }
+  return latest_game_id;
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: RejoinGame
+ * ------------------------------------------------------------------------------------------------
+ * @brief Give a greeted session the seat its rejoin hello's token names, in a game recovered from
+ *        the server that went down, and queue the board as it is.
+ *
+ * @details The game goes on from where it was logged. Against the house player, the house moves
+ *          at once if it is X's turn, and the client's move clock starts otherwise. Against a
+ *          client, the session waits until its opponent takes its seat back too, then the move
+ *          clock of the side to move starts; until then its moves are refused like a move of a
+ *          client still in the MatchQueue.
+ *
+ * @note Games are per shard: a player only finds its game on the shard that hosts it, and with
+ *       more than one shard has to connect again until its connection lands there.
+ *
+ * @return True if the session took its seat back, false if the token names no empty seat of a
+ *         live game, or the recovered games' grace is over, and the session was closed.
+ * ------------------------------------------------------------------------------------------------
+ */
+bool GameServer::RejoinGame(Session& session, GameStore::GameId rejoined_game_id, uint64_t seat_token) {
+  GameStore::GameRef rejoined_game = games.Find(rejoined_game_id);
+  char letter        = 0;
+  bool is_house_game = false;
+  if (seat_tokens && is_rejoin_open && rejoined_game) {
+    if (seat_token == seat_tokens->Issue(shard_index, rejoined_game_id, 'X', false)) {
+      letter = 'X';
+    } else if (seat_token == seat_tokens->Issue(shard_index, rejoined_game_id, 'O', false)) {
+      letter = 'O';
+    } else if (seat_token == seat_tokens->Issue(shard_index, rejoined_game_id, 'O', true)) {
+      letter        = 'O';
+      is_house_game = true;
+    }
+  }
+  if (letter == 0 || rejoined_game.GetPlayer(letter) != GameStore::NO_PLAYER ||
+      rejoined_game.GetSideToMove() == GameStore::NO_SIDE) {
+    CloseSession(session.client_socket);
+    return false;
+  }
+  const char side_to_move = rejoined_game.GetSideToMove();
+  rejoined_game.SetPlayer(letter, session.client_socket);
+  session.game_id      = rejoined_game_id;
+  session.letter       = letter;
+  session.move_counter = rejoined_game.GetMoveCount() + 1;
+  QueueData(session, letter == 'X' ? WireProtocol::REJOINED_X : WireProtocol::REJOINED_O, rejoined_game.PackBoard());
+  if (is_house_game) {
+    rejoined_game.SetPlayer('X', GameStore::HOUSE_PLAYER);
+    if (side_to_move == 'X') {
+      MakeServerMove(session);
+    } else {
+      StartMoveClock(session);
+    }
+    return true;
+  }
+  auto found = sessions.find(rejoined_game.GetPlayer(letter == 'X' ? 'O' : 'X'));
+  if (found == sessions.end() || found->second.is_closing || found->second.is_closed) {
+    session.is_waiting = true;  // Its opponent has not taken its seat back yet.
+    return true;
+  }
+  Session& opponent        = found->second;
+  session.opponent_socket  = opponent.client_socket;
+  opponent.opponent_socket = session.client_socket;
+  opponent.is_waiting      = false;
+  StartMoveClock(side_to_move == letter ? session : opponent);
+  return true;
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: ExpireMatches
+ * ------------------------------------------------------------------------------------------------
+ * @brief Start a game against the house player for every client that waited the bot wait.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::ExpireMatches() {
+  int socket;
+  while (match_queue->PopExpired(MatchQueue::Clock::now(), socket)) {
+    auto found = sessions.find(socket);
+    if (found == sessions.end()) {
+      continue;
+    }
+    found->second.is_waiting = false;
+    found->second.game_id    = StartGame(GameStore::HOUSE_PLAYER, socket);
+    MakeServerMove(found->second);
+    FlushSession(found->second);
+  }
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: ReportMetrics
+ * ------------------------------------------------------------------------------------------------
+ * @brief Print a census of the shard's games and, with matchmaking, the pairing throughput and
+ *        wait times since the last report, then schedule the next report.
+ *
+ * @details The event loops report every Timeout::METRICS_INTERVAL from the time they start, on a
+ *          timer like TakeSnapshot's, so a shard reports even while no game starts.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::ReportMetrics() {
+  if (match_queue) {
+    MatchQueue::Clock::time_point now = MatchQueue::Clock::now();
+    MatchQueue::Metrics metrics       = match_queue->GetMetrics(now);
+    std::cout << "Matchmaking: " << metrics.pairs_per_second << " games/s started ("
+              << metrics.bot_pair_count << " of " << metrics.pair_count << " against the house player), mean wait "
+              << metrics.mean_wait_milliseconds << " ms, longest wait " << metrics.longest_wait_milliseconds
+              << " ms" << std::endl;
+    match_queue->ResetMetrics(now);
+  }
+  GameStore::Census census = games.GetCensus();
+  std::cout << "Games: " << census.game_count << " live (" << census.x_to_move_count << " with X to move, "
+            << census.o_to_move_count << " with O to move, " << census.over_count << " over), "
+            << census.move_count << " moves played" << std::endl;
+  timers.Schedule(TimerWheel::Clock::now() + Timeout::METRICS_INTERVAL, Timeout::METRICS);
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: EnableTimeouts
+ * ------------------------------------------------------------------------------------------------
+ * @brief Put the event loop's clients on the clock, see ExpireTimers.
+ *
+ * @param move_time    The longest a client may take over a move before it loses the game, or 0.
+ * @param idle_timeout The longest a client may send and receive nothing before it is closed, or 0.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::EnableTimeouts(std::chrono::milliseconds move_time, std::chrono::milliseconds idle_timeout) {
+  this->move_time    = move_time;
+  this->idle_timeout = idle_timeout;
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: EnableMoveLog
+ * ------------------------------------------------------------------------------------------------
+ * @brief Append every game the server creates and retires, and every move played on them, to a
+ *        MoveLog through the server's own writer.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::EnableMoveLog(MoveLog::Writer* move_log) {
+  games.SetMoveLog(move_log);
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: RecoverGames
+ * ------------------------------------------------------------------------------------------------
+ * @brief Take over the games GameSnapshots recovered for this server, before the event loop starts.
+ *
+ * @details The players of a recovered game were connected to the server that went down; with
+ *          EnableRejoin they take their seats back with the tokens they were sent, see RejoinGame,
+ *          and until then the game can be watched. Once the idle timeout has passed, or
+ *          Timeout::RECOVERED_GAME_GRACE without an idle timeout, one timer ends every game with a
+ *          seat still empty, see CloseOpenSeats, so the games of one crash do not pile up over the
+ *          restarts that follow.
+ *
+ * @note Call EnableTimeouts first.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::RecoverGames(GameStore& recovered_games) {
+  games = std::move(recovered_games);
+  if (games.GetCount() == 0) {
+    return;
+  }
+  is_rejoin_open = true;
+  const std::chrono::milliseconds grace = idle_timeout.count() > 0 ? idle_timeout : Timeout::RECOVERED_GAME_GRACE;
+  timers.Schedule(TimerWheel::Clock::now() + grace, Timeout::RECOVERED_GAMES);
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: EnableRejoin
+ * ------------------------------------------------------------------------------------------------
+ * @brief Send every player the token of its seat, and give the seats of recovered games back to the
+ *        players that bring theirs, see RejoinGame.
+ *
+ * @param seat_tokens The issuer of the tokens, shared by every shard.
+ * @param shard_index The shard whose games these are.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::EnableRejoin(const SeatTokens* seat_tokens, int shard_index) {
+  this->seat_tokens = seat_tokens;
+  this->shard_index = shard_index;
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: CloseOpenSeats
+ * ------------------------------------------------------------------------------------------------
+ * @brief End the recovered games whose players did not all come back once the grace is over.
+ *
+ * @details A player that took its seat back wins the game of an opponent that did not, as if the
+ *          opponent had left; a game nobody came back to is retired.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::CloseOpenSeats() {
+  is_rejoin_open = false;
+  std::vector<GameStore::GameId> open_game_ids;
+  games.GetOpenGameIds(open_game_ids);
+  for (GameStore::GameId open_game_id : open_game_ids) {
+    GameStore::GameRef open_game = games.Find(open_game_id);
+    const int x_socket = open_game.GetPlayer('X');
+    auto found = sessions.find(x_socket >= 0 ? x_socket : open_game.GetPlayer('O'));
+    if (found == sessions.end() || found->second.is_closing || found->second.is_closed) {
+      RetireGame(open_game_id);
+      continue;
+    }
+    Session& winner       = found->second;
+    uint32_t packed_board = open_game.PackBoard();
+    winner.is_waiting     = false;
+    winner.is_closing     = true;
+    StopMoveClock(winner);
+    QueueData(winner, WireProtocol::CLIENT_WON, packed_board);
+    PublishUpdate(open_game_id, winner.letter == 'X' ? WireProtocol::X_WON : WireProtocol::O_WON, packed_board);
+    FlushSession(winner);
+  }
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: EnableSnapshots
+ * ------------------------------------------------------------------------------------------------
+ * @brief Take a snapshot of the server's games now, and again every snapshot_interval, see
+ *        TakeSnapshot. Call after EnableMoveLog, so that every snapshot is marked in the log.
+ *
+ * @param snapshots   The writer of the snapshots.
+ * @param shard_index The shard whose snapshots these are.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::EnableSnapshots(GameSnapshots* snapshots, int shard_index,
+                                 std::chrono::milliseconds snapshot_interval) {
+  this->snapshots         = snapshots;
+  this->shard_index       = shard_index;
+  this->snapshot_interval = snapshot_interval;
+  snapshot_sequence       = snapshots->GetSequence(shard_index);
+  TakeSnapshot();
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: TakeSnapshot
+ * ------------------------------------------------------------------------------------------------
+ * @brief Copy the state of every game and hand it to the snapshot writer, which writes it to disk
+ *        off the event loop, then schedule the next snapshot.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::TakeSnapshot() {
+  games.TakeSnapshot(game_snapshot, ++snapshot_sequence);
+  snapshots->Submit(shard_index, game_snapshot);
+  timers.Schedule(TimerWheel::Clock::now() + snapshot_interval, Timeout::SNAPSHOT);
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: StartMoveClock
+ * ------------------------------------------------------------------------------------------------
+ * @brief Give a session the move time for the move it is now asked for.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::StartMoveClock(Session& session) {
+  timers.Cancel(session.move_timer);
+  session.move_timer = TimerWheel::NO_TIMER;
+  if (move_time.count() > 0) {
+    session.move_timer = timers.Schedule(TimerWheel::Clock::now() + move_time,
+                                         (static_cast<uint64_t>(session.client_socket) << 8) | Timeout::MOVE_CLOCK);
+  }
+}
+
+void GameServer::StopMoveClock(Session& session) {
+  timers.Cancel(session.move_timer);
+  session.move_timer = TimerWheel::NO_TIMER;
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: TouchSession
+ * ------------------------------------------------------------------------------------------------
+ * @brief Start a session's idle timeout over. Spectators are never idle: they leave with their game.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::TouchSession(Session& session) {
+  if (idle_timeout.count() <= 0 || session.is_spectator || session.is_closed) {
+    return;
+  }
+  timers.Cancel(session.idle_timer);
+  session.idle_timer = timers.Schedule(TimerWheel::Clock::now() + idle_timeout,
+                                       (static_cast<uint64_t>(session.client_socket) << 8) | Timeout::IDLE);
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: ExpireTimers
+ * ------------------------------------------------------------------------------------------------
+ * @brief Act on every timer that has expired: a client out of move time loses its game, an idle
+ *        client is closed, and a client that waited the bot wait plays the house player. Snapshots
+ *        are taken, metrics reported, and the recovered games' empty seats closed, on timers too.
+ *
+ * @details Timers are cancelled when their session closes, so a timer only ever finds a session
+ *          that is still open; one that is already closing has lost or finished its game anyway.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::ExpireTimers() {
+  uint64_t payload;
+  while (timers.PopExpired(TimerWheel::Clock::now(), payload)) {
+    if ((payload & 0xff) == Timeout::SNAPSHOT) {
+      TakeSnapshot();
+      continue;
+    }
+    if ((payload & 0xff) == Timeout::METRICS) {
+      ReportMetrics();
+      continue;
+    }
+    if ((payload & 0xff) == Timeout::RECOVERED_GAMES) {
+      CloseOpenSeats();
+      continue;
+    }
+    int socket = static_cast<int>(payload >> 8);
+    auto found = sessions.find(socket);
+    if (found == sessions.end() || found->second.is_closed) {
+      continue;
+    }
+    Session& session = found->second;
+    if ((payload & 0xff) == Timeout::MOVE_CLOCK) {
+      session.move_timer = TimerWheel::NO_TIMER;
+      if (!session.is_closing) {
+        ForfeitOnTime(session);
+      }
+    } else {
+      session.idle_timer = TimerWheel::NO_TIMER;
+      CloseSession(socket);
+    }
+  }
+  if (match_queue) {
+    ExpireMatches();
+  }
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: MillisecondsToNextTimer
+ * ------------------------------------------------------------------------------------------------
+ * @brief How long the event loop may sleep before ExpireTimers has work, or -1 for as long as it
+ *        likes.
+ * ------------------------------------------------------------------------------------------------
+ */
+int GameServer::MillisecondsToNextTimer() {
+  int timeout = timers.MillisecondsToNextTimer(TimerWheel::Clock::now());
+  if (match_queue) {
+    int match_timeout = match_queue->MillisecondsToExpiry(MatchQueue::Clock::now());
+    if (timeout == -1 || (match_timeout != -1 && match_timeout < timeout)) {
+      timeout = match_timeout;
+    }
+  }
+  return timeout;
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: ForfeitOnTime
+ * ------------------------------------------------------------------------------------------------
+ * @brief End the game of a client that ran out of move time: the client is told so, and the game
+ *        goes to its opponent, or to the house player.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::ForfeitOnTime(Session& session) {
+  uint32_t packed_board = games.Find(session.game_id).PackBoard();
+  char winner           = 'X';
+  session.is_closing    = true;
+  QueueData(session, WireProtocol::OUT_OF_TIME, packed_board);
+  Session* opponent = nullptr;
+  auto found = sessions.find(session.opponent_socket);
+  if (session.opponent_socket != -1 && found != sessions.end() && !found->second.is_closed) {
+    opponent             = &found->second;
+    winner               = opponent->letter;
+    opponent->is_closing = true;
+    StopMoveClock(*opponent);
+    QueueData(*opponent, WireProtocol::CLIENT_WON, packed_board);
+  }
+  PublishUpdate(session.game_id, winner == 'X' ? WireProtocol::X_WON : WireProtocol::O_WON, packed_board);
+  if (opponent) {
+    FlushSession(*opponent);
+  }
+  FlushSession(session);
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: MakePairedMove
+ * ------------------------------------------------------------------------------------------------
+ * @brief Play a client's move in a game against another client and queue the result for both.
+ *
+ * @details A move out of turn is refused like an unavailable spot. A successful move is
+ *          reported to the opponent as PLAYER_X_MOVED or PLAYER_O_MOVED; a winning move ends
+ *          the game with CLIENT_WON for the mover and SERVER_WON for the opponent.
+ *
+ * @param session  The session of the client that moved.
+ * @param opponent The session of the client it plays against.
+ * @param player   The 1-based row and column number received from the client.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::MakePairedMove(Session& session, Session& opponent, const Player& player) {
+  GameStore::GameRef game_manager = games.Find(session.game_id);
+  const char letter_to_move = session.move_counter % 2 == 1 ? 'X' : 'O';
+  if (session.letter != letter_to_move) {
+    QueueData(session, WireProtocol::SPOT_UNAVAILABLE, game_manager.PackBoard());
+    return;
+  }
+  Status move_status = game_manager.MakeMove(player.row, player.column, session.letter, session.move_counter);
+  switch (move_status.status_code) {
+    case StatusCode::WIN:
+      session.is_closing  = true;
+      opponent.is_closing = true;
+      QueueData(session, WireProtocol::CLIENT_WON, move_status.packed_board);
+      QueueData(opponent, WireProtocol::SERVER_WON, move_status.packed_board);
+      PublishUpdate(session.game_id, session.letter == 'X' ? WireProtocol::X_WON : WireProtocol::O_WON,
+                    move_status.packed_board);
+      break;
+    case StatusCode::TIE:
+      session.is_closing  = true;
+      opponent.is_closing = true;
+      QueueData(session, WireProtocol::TIE_GAME, move_status.packed_board);
+      QueueData(opponent, WireProtocol::TIE_GAME, move_status.packed_board);
+      PublishUpdate(session.game_id, WireProtocol::TIE_GAME, move_status.packed_board);
+      break;
+    case StatusCode::ERROR:
+      QueueData(session, WireProtocol::SPOT_UNAVAILABLE, move_status.packed_board);
+      return;
+    case StatusCode::UPDATE:
+      ++session.move_counter;
+      ++opponent.move_counter;
+      QueueData(session, WireProtocol::MOVE_ACCEPTED, move_status.packed_board);
+      QueueData(opponent, session.letter == 'X' ? WireProtocol::PLAYER_X_MOVED : WireProtocol::PLAYER_O_MOVED,
+                move_status.packed_board);
+      PublishUpdate(session.game_id, session.letter == 'X' ? WireProtocol::PLAYER_X_MOVED
+                                                           : WireProtocol::PLAYER_O_MOVED, move_status.packed_board);
+      StopMoveClock(session);
+      StartMoveClock(opponent);
+      break;
+  }
+  FlushSession(opponent);
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: EndMatch
+ * ------------------------------------------------------------------------------------------------
+ * @brief Take a closing session out of the MatchQueue or out of its game with another client.
+ *
+ * @details An opponent whose game was still on wins it, and its spectators are told so. The game
+ *          itself is left to the session that closes last, which retires it.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::EndMatch(Session& session) {
+  if (session.is_waiting) {
+    if (match_queue) {
+      match_queue->Leave(session.client_socket);
+    }
+    session.is_waiting = false;
+  }
+  auto found = sessions.find(session.opponent_socket);
+  if (session.opponent_socket == -1 || found == sessions.end()) {
+    return;
+  }
+  Session& opponent        = found->second;
+  session.opponent_socket  = -1;
+  session.game_id          = GameStore::NO_GAME;
+  opponent.opponent_socket = -1;
+  if (!opponent.is_closing && !opponent.is_closed) {
+    uint32_t packed_board = games.Find(opponent.game_id).PackBoard();
+    opponent.is_closing   = true;
+    StopMoveClock(opponent);
+    QueueData(opponent, WireProtocol::CLIENT_WON, packed_board);
+    PublishUpdate(opponent.game_id, opponent.letter == 'X' ? WireProtocol::X_WON : WireProtocol::O_WON, packed_board);
+    FlushSession(opponent);
+  }
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: WatchGame
+ * ------------------------------------------------------------------------------------------------
+ * @brief Make a greeted session a spectator of a game and queue the board as it is.
+ *
+ * @param session         The session that sent a watch hello.
+ * @param watched_game_id The game to watch, or WireProtocol::LATEST_GAME for the game started last.
+ *
+ * @note Games are per shard: a spectator only finds the games of the shard its connection landed on.
+ *       A spectator never owns a game, so closing it retires nothing.
+ *
+ * @return True if the session watches the game, false if there is no such game and the session
+ *         was closed.
+ * ------------------------------------------------------------------------------------------------
+ */
+bool GameServer::WatchGame(Session& session, GameStore::GameId watched_game_id) {
+  if (watched_game_id == WireProtocol::LATEST_GAME) {
+    watched_game_id = latest_game_id;
+  }
+  GameStore::GameRef watched_game = games.Find(watched_game_id);
+  if (!watched_game) {
+    CloseSession(session.client_socket);
+    return false;
+  }
+  // The watch hello is the session's first frame, so it has no game of its own to give up.
+  session.game_id      = watched_game_id;
+  session.is_spectator = true;
+  timers.Cancel(session.idle_timer);  // A spectator never sends; it leaves with its game.
+  session.idle_timer   = TimerWheel::NO_TIMER;
+  spectators[watched_game_id].push_back(session.client_socket);
+  std::shared_ptr<std::string> snapshot = std::make_shared<std::string>();
+  ReplyTable::AppendReply(*snapshot, session.protocol, WireProtocol::WATCHING, watched_game.PackBoard());
+  session.updates.Push(snapshot);
+  
+  return true;
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: PublishUpdate
+ * ------------------------------------------------------------------------------------------------
+ * @brief Send an update of a game to every spectator watching it.
+ *
+ * The update is encoded at most once per protocol, the first time a spectator using that
+ * protocol is reached, and every spectator queues a reference to the same buffer. A spectator
+ * whose socket does not keep up only has its oldest updates dropped, see UpdateQueue, so the
+ * players of the game never wait for it. The end of the game closes every spectator once its
+ * updates are sent.
+ *
+ * @param published_game_id The game that changed.
+ * @param reply             PLAYER_X_MOVED or PLAYER_O_MOVED, or X_WON, O_WON or TIE_GAME at the end.
+ * @param packed_board      The game board, packed as by Game::PackBoard.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::PublishUpdate(GameStore::GameId published_game_id, WireProtocol::Reply reply,
+                               uint32_t packed_board) {
+  if (spectators.empty()) {
+    return;
+  }
+  auto found = spectators.find(published_game_id);
+  if (found == spectators.end()) {
+    return;
+  }
+  const bool is_over = reply == WireProtocol::X_WON || reply == WireProtocol::O_WON ||
+                       reply == WireProtocol::TIE_GAME;
+  // Flushing may close a spectator, which takes it off the list; walk a copy of it instead.
+  publishing.assign(found->second.begin(), found->second.end());
+  if (is_over) {
+    spectators.erase(found);
+  }
+  UpdateQueue::Update encoded[WireProtocol::PROTOCOL_COUNT];
+  for (int socket : publishing) {
+    auto watcher = sessions.find(socket);
+    if (watcher == sessions.end()) {
+      continue;
+    }
+    Session& spectator = watcher->second;
+    UpdateQueue::Update& update = encoded[spectator.protocol];
+    if (!update) {
+      std::shared_ptr<std::string> buffer = std::make_shared<std::string>();
+      ReplyTable::AppendReply(*buffer, spectator.protocol, reply, packed_board);
+      update = buffer;
+    }
+    spectator.updates.Push(update);
+    spectator.is_closing = spectator.is_closing || is_over;
+    FlushSession(spectator);
+  }
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: WriteUpdates
+ * ------------------------------------------------------------------------------------------------
+ * @brief Send as many of a spectator's updates as its socket accepts, with one sendmsg per batch.
+ *
+ * Like WriteToClient, whatever the socket does not accept yet waits for the next EPOLLOUT event,
+ * and a spectator whose game is over is closed once every update is sent.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::WriteUpdates(Session& session) {
+  while (session.updates.PrepareWrite()) {
+    ssize_t data_bytes_sent = sendmsg(session.client_socket, session.updates.GetMessage(), MSG_NOSIGNAL);
+    if (data_bytes_sent == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return;  // Wait for the next EPOLLOUT event.
+      }
+      CloseSession(session.client_socket);
+      return;
+    }
+    session.updates.Consume(data_bytes_sent);
+  }
+  if (session.is_closing) {
+    CloseSession(session.client_socket);
+  }
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: StopWatching
+ * ------------------------------------------------------------------------------------------------
+ * @brief Take a closing spectator off the list of its game. Does nothing for a player.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::StopWatching(Session& session) {
+  if (!session.is_spectator) {
+    return;
+  }
+  auto found = spectators.find(session.game_id);
+  if (found == spectators.end()) {
+    return;
+  }
+  std::vector<int>& watchers = found->second;
+  watchers.erase(std::remove(watchers.begin(), watchers.end(), session.client_socket), watchers.end());
+  if (watchers.empty()) {
+    spectators.erase(found);
+  }
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: RetireGame
+ * ------------------------------------------------------------------------------------------------
+ * @brief Retire a game from the registry, closing the spectators of a game that was abandoned
+ *        before it ended.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::RetireGame(GameStore::GameId retired_game_id) {
+  auto found = spectators.find(retired_game_id);
+  if (found != spectators.end()) {
+    std::vector<int> watchers;
+    watchers.swap(found->second);
+    spectators.erase(found);
+    for (int socket : watchers) {
+      auto watcher = sessions.find(socket);
+      if (watcher != sessions.end()) {
+        watcher->second.is_closing = true;
+        FlushSession(watcher->second);
+      }
+    }
+  }
+  games.Retire(retired_game_id);
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: QueueData
+ * ------------------------------------------------------------------------------------------------
+ * @brief Append a reply and game board, in the session's protocol, to its outbound buffer.
+ *
+ * Each message is appended as its own length-prefixed frame, so replies that are sent in a
+ * single write stay separate messages for the client. The reply is copied from ReplyTable,
+ * so nothing but the outbound buffer is written.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::QueueData(Session& session, WireProtocol::Reply reply, uint32_t packed_board) {
+  ReplyTable::AppendReply(session.outbound, session.protocol, reply, packed_board);
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: FlushSession
+ * ------------------------------------------------------------------------------------------------
+ * @brief Start sending the session's queued bytes with the backend the server runs on. The session
+ *        is not idle: its idle timeout starts over.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::FlushSession(Session& session) {
+  TouchSession(session);
+  if (io_uring) {
+    SubmitSend(session);
+  } else {
+    WriteToClient(session);
+  }
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: CloseSession
+ * ------------------------------------------------------------------------------------------------
+ * @brief Close a client socket and forget its game, or stop it watching one.
+ *
+ * @note Closing the socket also removes it from the epoll instance. With the io_uring
+ *       backend the socket is only shut down here, which completes the requests the
+ *       kernel still owns; ReleaseSession closes it once they are all completed.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::CloseSession(int socket) {
+  auto found = sessions.find(socket);
+  if (io_uring) {
+    if (found != sessions.end() && !found->second.is_closed) {
+      found->second.is_closed = true;
+      timers.Cancel(found->second.move_timer);
+      timers.Cancel(found->second.idle_timer);
+      EndMatch(found->second);
+      StopWatching(found->second);
+      shutdown(socket, SHUT_RDWR);
+    }
+    return;
+  }
+  if (found != sessions.end()) {
+    timers.Cancel(found->second.move_timer);
+    timers.Cancel(found->second.idle_timer);
+    EndMatch(found->second);
+    StopWatching(found->second);
+    if (!found->second.is_spectator) {
+      RetireGame(found->second.game_id);
+    }
+    sessions.erase(found);
+  }
+  close(socket);
+}
+
+namespace Uring {
+  // The operation of a request is kept in the low byte of its user data, the socket above it.
+  const uint64_t ACCEPT  = 1;
+  const uint64_t RECEIVE = 2;
+  const uint64_t SEND    = 3;
+  
+  uint64_t UserData(int socket, uint64_t operation) {
+    return (static_cast<uint64_t>(socket) << 8) | operation;
+  }
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: StartUringLoop
+ * ------------------------------------------------------------------------------------------------
+ * @brief Host one independent Tic-Tac-Toe game per client connection off io_uring.
+ *
+ * This method hosts the same games as StartEventLoop, but instead of waiting for readiness
+ * and then calling accept, recv and send one socket at a time, it keeps requests queued in
+ * the kernel: a multishot accept on the server socket, a multishot receive on every client
+ * socket that reads into the registered buffer ring, and a send whenever a session has
+ * bytes queued. Every request prepared while handling a batch of completions is submitted,
+ * and the next batch is waited for, by a single io_uring_enter call, which gives up waiting
+ * when the next timer of ExpireTimers is due.
+ *
+ * @details When io_uring cannot be set up (old kernel, or disabled by the system), the
+ *          server reports it and falls back to StartEventLoop.
+ *
+ * @throws std::runtime_error if there is an error during listening or submitting requests.
+ *
+ * @return Does not return under normal operation.
+ * ------------------------------------------------------------------------------------------------
+ */
+int GameServer::StartUringLoop() {
+  const unsigned ring_entries = 4096;
+  const unsigned buffer_count = 4096;
+  const unsigned buffer_size  = 256;
+  try {
+    io_uring.reset(new IoUring(ring_entries, buffer_count, buffer_size));
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << " Falling back to epoll." << std::endl;
+    return StartEventLoop();
+  }
+  if (listen(server_socket, SOMAXCONN) == -1) {
+    throw std::runtime_error("Error! listening for Client connection.");
+  }
+  std::cout << "Server is listening for incoming connections (io_uring)..." << std::endl;
+  timers.Schedule(TimerWheel::Clock::now() + Timeout::METRICS_INTERVAL, Timeout::METRICS);
+  
+  SubmitAccept();
+  while (1) {
+    ExpireTimers();
+    io_uring->SubmitAndWait(1, MillisecondsToNextTimer());
+    struct io_uring_cqe* completion;
+    while ((completion = io_uring->PeekCompletion()) != nullptr) {
+      uint64_t user_data = completion->user_data;
+      int result         = completion->res;
+      unsigned flags     = completion->flags;
+      io_uring->AdvanceCompletion();
+      int socket         = static_cast<int>(user_data >> 8);
+      uint64_t operation = user_data & 0xff;
+      if (operation == Uring::ACCEPT) {
+        HandleAcceptCompletion(result, flags);
+        continue;
+      }
+      auto found = sessions.find(socket);
+      if (found == sessions.end()) {
+        continue;
+      }
+      if (operation == Uring::RECEIVE) {
+        HandleReceiveCompletion(found->second, result, flags);
+      } else if (operation == Uring::SEND) {
+        HandleSendCompletion(found->second, result);
+      }
+    }
+  }
+  
+  return EXIT_SUCCESS;
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: SubmitAccept
+ * ------------------------------------------------------------------------------------------------
+ * @brief Queue a multishot accept, which completes once for every incoming connection.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::SubmitAccept() {
+  struct io_uring_sqe* entry = io_uring->GetSubmission();
+  entry->opcode    = IORING_OP_ACCEPT;
+  entry->fd        = server_socket;
+  entry->ioprio    = IORING_ACCEPT_MULTISHOT;
+  entry->user_data = Uring::UserData(server_socket, Uring::ACCEPT);
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: SubmitReceive
+ * ------------------------------------------------------------------------------------------------
+ * @brief Queue a multishot receive that reads into buffers picked from the buffer ring.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::SubmitReceive(Session& session) {
+  struct io_uring_sqe* entry = io_uring->GetSubmission();
+  entry->opcode     = IORING_OP_RECV;
+  entry->fd         = session.client_socket;
+  entry->flags      = IOSQE_BUFFER_SELECT;
+  entry->buf_group  = IoUring::BUFFER_GROUP;
+  entry->ioprio     = IORING_RECV_MULTISHOT;
+  entry->user_data  = Uring::UserData(session.client_socket, Uring::RECEIVE);
+  session.recv_armed = true;
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: SubmitSend
+ * ------------------------------------------------------------------------------------------------
+ * @brief Queue a send of the session's bytes, unless one is already in flight.
+ *
+ * The queued bytes move from outbound to sending, which is left untouched until the
+ * send completes. A session whose game is over is closed once both buffers are empty.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::SubmitSend(Session& session) {
+  if (session.is_spectator) {
+    SubmitUpdates(session);
+    return;
+  }
+  if (session.send_in_flight || session.is_closed) {
+    return;
+  }
+  if (session.sending.empty()) {
+    session.sending.swap(session.outbound);
+  }
+  if (session.sending.empty()) {
+    if (session.is_closing) {
+      CloseSession(session.client_socket);
+    }
+    return;
+  }
+  struct io_uring_sqe* entry = io_uring->GetSubmission();
+  entry->opcode    = IORING_OP_SEND;
+  entry->fd        = session.client_socket;
+  entry->addr      = reinterpret_cast<uint64_t>(session.sending.data());
+  entry->len       = static_cast<uint32_t>(session.sending.size());
+  entry->msg_flags = MSG_NOSIGNAL;
+  entry->user_data = Uring::UserData(session.client_socket, Uring::SEND);
+  session.send_in_flight = true;
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: SubmitUpdates
+ * ------------------------------------------------------------------------------------------------
+ * @brief Queue one sendmsg of a spectator's updates, unless one is already in flight.
+ *
+ * The message points straight into the shared update buffers, which the UpdateQueue keeps
+ * until the send completes. A spectator whose game is over is closed once every update is sent.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::SubmitUpdates(Session& session) {
+  if (session.send_in_flight || session.is_closed) {
+    return;
+  }
+  if (!session.updates.PrepareWrite()) {
+    if (session.is_closing) {
+      CloseSession(session.client_socket);
+    }
+    return;
+  }
+  struct io_uring_sqe* entry = io_uring->GetSubmission();
+  entry->opcode    = IORING_OP_SENDMSG;
+  entry->fd        = session.client_socket;
+  entry->addr      = reinterpret_cast<uint64_t>(session.updates.GetMessage());
+  entry->len       = 1;
+  entry->msg_flags = MSG_NOSIGNAL;
+  entry->user_data = Uring::UserData(session.client_socket, Uring::SEND);
+  session.send_in_flight = true;
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: HandleAcceptCompletion
+ * ------------------------------------------------------------------------------------------------
+ * @brief Start a game for an accepted client connection.
+ *
+ * @param result The accepted client socket, or a negative error number.
+ * @param flags  The completion flags; without IORING_CQE_F_MORE the accept is re-armed.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::HandleAcceptCompletion(int result, unsigned flags) {
+  if (!(flags & IORING_CQE_F_MORE)) {
+    SubmitAccept();
+  }
+  if (result < 0) {
+    return;
+  }
+  Session& session        = sessions[result];
+  session.client_socket   = result;
+  session.move_counter    = 1;
+  session.is_closing      = false;
+  session.is_closed       = false;
+  session.recv_armed      = false;
+  session.send_in_flight  = false;
+  session.is_greeted      = false;
+  session.game_id         = GameStore::NO_GAME;
+  session.letter          = 'O';
+  session.opponent_socket = -1;
+  session.is_waiting      = false;
+  session.is_spectator    = false;
+  session.move_timer      = TimerWheel::NO_TIMER;
+  session.idle_timer      = TimerWheel::NO_TIMER;
+  TouchSession(session);
+  SubmitReceive(session);
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: HandleReceiveCompletion
+ * ------------------------------------------------------------------------------------------------
+ * @brief Move received bytes out of the buffer ring and play them.
+ *
+ * @param session The session the bytes were received on.
+ * @param result  The number of bytes received, 0 when the client disconnected, or a
+ *                negative error number.
+ * @param flags   The completion flags, holding the id of the buffer the bytes are in.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::HandleReceiveCompletion(Session& session, int result, unsigned flags) {
+  if (flags & IORING_CQE_F_BUFFER) {
+    uint16_t buffer_id = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+    if (result > 0) {
+      session.inbound.append(io_uring->GetBuffer(buffer_id), result);
+    }
+    io_uring->RecycleBuffer(buffer_id);
+  }
+  if (!(flags & IORING_CQE_F_MORE)) {
+    session.recv_armed = false;
+  }
+  if (result > 0) {
+    HandleClientData(session);
+  }
+  if (!session.recv_armed && !session.is_closed) {
+    if (result > 0 || result == -ENOBUFS) {
+      SubmitReceive(session);
+    } else {
+      CloseSession(session.client_socket);  // Client disconnected or the socket failed.
+    }
+  }
+  ReleaseSession(session);
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: HandleSendCompletion
+ * ------------------------------------------------------------------------------------------------
+ * @brief Drop the sent bytes and send whatever is left or was queued in the meantime.
+ *
+ * @param session The session the bytes were sent on.
+ * @param result  The number of bytes sent, or a negative error number.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::HandleSendCompletion(Session& session, int result) {
+  session.send_in_flight = false;
+  if (result < 0) {
+    CloseSession(session.client_socket);
+  } else if (session.is_spectator) {
+    session.updates.Consume(result);
+    SubmitUpdates(session);
+  } else {
+    session.sending.erase(0, result);
+    SubmitSend(session);
+  }
+  ReleaseSession(session);
+}
+
+/* ------------------------------------------------------------------------------------------------
+ * FUNCTION NAME: ReleaseSession
+ * ------------------------------------------------------------------------------------------------
+ * @brief Close a shut down session once the kernel owns none of its requests anymore.
+ * ------------------------------------------------------------------------------------------------
+ */
+void GameServer::ReleaseSession(Session& session) {
+  if (session.is_closed && !session.recv_armed && !session.send_in_flight) {
+    int socket = session.client_socket;
+    if (!session.is_spectator) {
+      RetireGame(session.game_id);
+    }
+    close(socket);
+    sessions.erase(socket);
+  }
+}
@@ -1,3 +1,25 @@
+#ifndef GameServer_h
+#define GameServer_h
+#include "MatchQueue.h"
+#include "MoveLog.h"
+#include "Session.h"
+#include "TimerWheel.h"
+#include "Player.h"
+#include "IRequestManager.h"
+#include "WireProtocol.h"
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class GameSnapshots;
+class IoUring;
+class SeatTokens;
+
 /* -------------------------------------------------------------------------------------
  * CLASS NAME: GameServer
  * -------------------------------------------------------------------------------------
@@ -8,28 +30,121 @@
  * server and client send-receive data over the network to determine the winner
  * of the Tic-Tac-Toe game.
  *
+ * The server runs in one of two modes. StartListen() and LaunchGame() host a
+ * single game against the person at the server's terminal. StartEventLoop()
+ * hosts one independent game per client connection off an edge-triggered epoll
+ * event loop, with the server's side played by the house player. StartUringLoop()
+ * hosts the same games off io_uring, batching accepts, receives and sends into one
+ * system call per loop iteration, and falls back to StartEventLoop() when the
+ * kernel does not provide io_uring. With EnableMatchmaking(), the event loops pair
+ * their clients into games with each other instead, see MatchQueue. Any number
+ * of spectators may watch a game hosted by the event loops: each update of the
+ * game is encoded once per protocol and shared by all of them, see UpdateQueue.
+ * EnableTimeouts() puts every client's moves on a clock and evicts idle
+ * connections; the event loops keep those timers on a TimerWheel and sleep until
+ * the next one is due. EnableMoveLog() records every game and move in a MoveLog.
+ * EnableSnapshots() hands a copy of every game's state to GameSnapshots at a regular
+ * interval, and RecoverGames() takes over the games recovered from them at startup;
+ * with EnableRejoin(), their players take their seats back with the seat tokens
+ * they were sent when their games started.
+ * UseServerPlayer() hands the server's side, in either mode, to another player
+ * such as the perfect-play table or a search engine.
+ *
  * @note Close server and client socket when Tic-Tac-Toe game terminates.
  * -------------------------------------------------------------------------------------
  */
 class GameServer {
   public:
-    GameServer();
+    explicit GameServer(bool is_port_shared = false);
     int StartServer();
     int StartListen();
     void LaunchGame();
+    int StartEventLoop();
+    int StartUringLoop();
+    static void UseServerPlayer(IRequestManager* server_player);
+    void EnableMatchmaking(std::chrono::milliseconds bot_wait);
+    void EnableTimeouts(std::chrono::milliseconds move_time, std::chrono::milliseconds idle_timeout);
+    void EnableMoveLog(MoveLog::Writer* move_log);
+    void RecoverGames(GameStore& recovered_games);
+    void EnableSnapshots(GameSnapshots* snapshots, int shard_index, std::chrono::milliseconds snapshot_interval);
+    void EnableRejoin(const SeatTokens* seat_tokens, int shard_index);
     ~GameServer();
   
   private:
+    bool is_port_shared;
     int server_socket;
     int client_socket;
+    int epoll_socket;
     struct sockaddr_in client_address;
     socklen_t client_address_size;
     struct sockaddr_in server_address;
+    std::string inbound;
+    WireProtocol::Protocol protocol;
+    std::unordered_map<int, Session> sessions;
+    GameStore games;
+    GameStore::GameId game_id;  // The game against the person at the server's terminal.
+    std::unique_ptr<IoUring> io_uring;
+    std::unique_ptr<MatchQueue> match_queue;
+    TimerWheel timers;
+    std::chrono::milliseconds move_time;     // 0 when moves are not timed.
+    std::chrono::milliseconds idle_timeout;  // 0 when idle connections are kept.
+    std::unordered_map<GameStore::GameId, std::vector<int>> spectators;  // Sockets watching each game.
+    std::vector<int> publishing;  // The spectators an update is being published to.
+    GameStore::GameId latest_game_id;
+    GameSnapshots* snapshots;  // nullptr when the games are not snapshotted.
+    int shard_index;
+    std::chrono::milliseconds snapshot_interval;
+    uint32_t snapshot_sequence;          // The sequence of the last snapshot taken.
+    GameStore::Snapshot game_snapshot;  // The buffers the next snapshot is taken in.
+    const SeatTokens* seat_tokens;      // nullptr when players are sent no seat tokens.
+    bool is_rejoin_open;                // True until the recovered games' grace is over.
     bool IsServerMove(int counter);
     bool IsClientMove(int counter);
-    void SendData(const char* status_message, const char* game_board);
-    void ReceiveData(int* client_move);
-    void ParseReceivedRowAndColumnNumber(const char* received_data, int* client_move, size_t size);
+    void SendData(WireProtocol::Reply reply, uint32_t packed_board);
+    bool ReceiveFrame(std::string& payload, TimerWheel::Clock::time_point deadline);
+    void ReceiveHello();
+    bool ReceiveData(Player& client_move, TimerWheel::Clock::time_point deadline, bool& is_out_of_time);
+    TimerWheel::Clock::time_point Deadline(std::chrono::milliseconds limit) const;
+    bool ParseReceivedRowAndColumnNumber(WireProtocol::Protocol protocol, const char* received_data,
+                                         int* client_move, size_t size);
+    bool ParseMove(WireProtocol::Protocol protocol, const char* payload, size_t payload_size, Player& player);
+    void AcceptClients();
+    void ReadFromClient(Session& session);
+    void WriteToClient(Session& session);
+    void FlushSession(Session& session);
+    void SubmitAccept();
+    void SubmitReceive(Session& session);
+    void SubmitSend(Session& session);
+    void HandleAcceptCompletion(int result, unsigned flags);
+    void HandleReceiveCompletion(Session& session, int result, unsigned flags);
+    void HandleSendCompletion(Session& session, int result);
+    void ReleaseSession(Session& session);
+    void HandleClientData(Session& session);
+    void MakeServerMove(Session& session);
+    void MakeClientMove(Session& session, const Player& player);
+    void QueueData(Session& session, WireProtocol::Reply reply, uint32_t packed_board);
+    GameStore::GameId StartGame(int x_socket, int o_socket);
+    bool RejoinGame(Session& session, GameStore::GameId rejoined_game_id, uint64_t seat_token);
+    void JoinMatch(Session& session);
+    void ExpireMatches();
+    void MakePairedMove(Session& session, Session& opponent, const Player& player);
+    void EndMatch(Session& session);
+    bool WatchGame(Session& session, GameStore::GameId watched_game_id);
+    void PublishUpdate(GameStore::GameId published_game_id, WireProtocol::Reply reply, uint32_t packed_board);
+    void WriteUpdates(Session& session);
+    void SubmitUpdates(Session& session);
+    void StopWatching(Session& session);
+    void RetireGame(GameStore::GameId retired_game_id);
+    void StartMoveClock(Session& session);
+    void StopMoveClock(Session& session);
+    void TouchSession(Session& session);
+    void ExpireTimers();
+    int MillisecondsToNextTimer();
+    void ForfeitOnTime(Session& session);
+    void TakeSnapshot();
+    void CloseOpenSeats();
+    void ReportMetrics();
+    void CloseSession(int socket);
     void CloseServer();
 };
 #endif /* GameServer_h */
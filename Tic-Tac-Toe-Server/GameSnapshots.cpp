@@ -0,0 +1,311 @@
+#include "GameSnapshots.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+const char GameSnapshots::FILE_MAGIC[8] = { 'T', 'T', 'T', 'S', 'N', 'A', 'P', '2' };
+
+namespace {
+  static_assert(sizeof(GameStore::Mask) <= sizeof(uint16_t), "A 3x3 mask fits 16 bits.");
+
+  void AppendBigEndian(std::string& bytes, uint64_t value, int size) {
+    for (int index = size - 1; index >= 0; --index) {
+      bytes.push_back(static_cast<char>((value >> (8 * index)) & 0xff));
+    }
+  }
+
+  uint64_t GetBigEndian(const char* bytes, int size) {
+    uint64_t value = 0;
+    for (int index = 0; index < size; ++index) {
+      value = (value << 8) | static_cast<uint8_t>(bytes[index]);
+    }
+    return value;
+  }
+
+  template <typename Value>
+  void AppendColumn(std::string& bytes, const std::vector<Value>& column, int size) {
+    for (const Value& value : column) {
+      AppendBigEndian(bytes, static_cast<uint64_t>(value), size);
+    }
+  }
+
+  template <typename Value>
+  void GetColumn(const char*& bytes, std::vector<Value>& column, size_t row_count, int size) {
+    column.resize(row_count);
+    for (size_t row = 0; row < row_count; ++row) {
+      column[row] = static_cast<Value>(GetBigEndian(bytes, size));
+      bytes += size;
+    }
+  }
+
+  bool WriteAll(int file, const char* bytes, size_t size) {
+    while (size > 0) {
+      ssize_t written = write(file, bytes, size);
+      if (written == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return false;
+      }
+      bytes += written;
+      size  -= static_cast<size_t>(written);
+    }
+    return true;
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * CONSTRUCTOR NAME: GameSnapshots
+ * ------------------------------------------------------------------------------------
+ * @brief Starts the writer of the snapshots of shard_count shards, kept next to the move
+ *        log at log_path.
+ * ------------------------------------------------------------------------------------
+ */
+GameSnapshots::GameSnapshots(const std::string& log_path, int shard_count)
+    : log_path(log_path), sequences(shard_count, 0), pending(shard_count), is_pending(shard_count, false),
+      is_stopping(false) {
+  writer = std::thread(&GameSnapshots::WriteSnapshots, this);
+}
+
+/* Writes the snapshots still pending, then stops the writer. */
+GameSnapshots::~GameSnapshots() {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    is_stopping = true;
+  }
+  wake.notify_one();
+  writer.join();
+}
+
+std::string GameSnapshots::SnapshotPath(int shard_index) const {
+  return log_path + ".snapshot-" + std::to_string(shard_index);
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Recover
+ * ------------------------------------------------------------------------------------
+ * @brief Rebuilds every shard's games from its snapshot and the move log.
+ *
+ * @details The log is read from the smallest log offset of the shards' snapshots, or
+ *          from its start if a shard has no snapshot file. A shard's records are
+ *          replayed from just after the SNAPSHOT record of the snapshot it was loaded
+ *          from, or from the start of the log for a shard with no snapshot file. A snapshot whose SNAPSHOT record never reached the log is
+ *          newer than everything the log holds of its shard, and is taken as it is.
+ *          Each shard's next snapshot is numbered after every one it logged.
+ *
+ * @param stores [out] One GameStore per shard, to hold the recovered games.
+ *
+ * @throws std::runtime_error if the move log cannot be read, is not a move log, or
+ *                            holds the games of more shards than the server runs; the
+ *                            error names the --shards the server has to run with, as
+ *                            game IDs are per shard and cannot be moved to another.
+ *
+ * @return The number of games recovered and what it took.
+ * ------------------------------------------------------------------------------------
+ */
+GameSnapshots::Recovery GameSnapshots::Recover(std::vector<GameStore>& stores) {
+  const auto start         = std::chrono::steady_clock::now();
+  const size_t shard_count = sequences.size();
+  Recovery recovery = {};
+  std::vector<GameStore::Snapshot> snapshots(shard_count);
+  std::vector<std::vector<MoveLog::Record>> records(shard_count);
+  std::vector<uint8_t> is_snapshot_logged(shard_count, false);
+  std::vector<uint32_t> logged_sequences(shard_count, 0);
+  uint64_t log_offset = UINT64_MAX;
+  for (size_t shard = 0; shard < shard_count; ++shard) {
+    if (ReadSnapshot(SnapshotPath(static_cast<int>(shard)), snapshots[shard])) {
+      sequences[shard]             = snapshots[shard].sequence;
+      recovery.snapshot_row_count += snapshots[shard].game_ids.size();
+      log_offset                   = std::min(log_offset, snapshots[shard].log_offset);
+    } else {
+      log_offset = 0;
+    }
+  }
+
+  // The log may start after the records of a shard the server no longer runs; its snapshot file tells.
+  size_t logged_shard_count = shard_count;
+  while (access(SnapshotPath(static_cast<int>(logged_shard_count)).c_str(), F_OK) == 0) {
+    ++logged_shard_count;
+  }
+
+  MoveLog::Reader reader(log_path);
+  reader.Seek(log_offset);
+  const uint64_t log_start = reader.GetSize();
+  MoveLog::Record record;
+  while (reader.Next(record)) {
+    if (record.shard >= shard_count) {
+      logged_shard_count = std::max(logged_shard_count, static_cast<size_t>(record.shard) + 1);
+      continue;
+    }
+    if (record.kind != MoveLog::SNAPSHOT) {
+      records[record.shard].push_back(record);
+      continue;
+    }
+    logged_sequences[record.shard] = std::max(logged_sequences[record.shard], record.game_id);
+    if (sequences[record.shard] != 0 && record.game_id == sequences[record.shard]) {
+      records[record.shard].clear();
+      is_snapshot_logged[record.shard] = true;
+    }
+  }
+  recovery.log_bytes_read = reader.GetSize() - log_start;
+  if (logged_shard_count > shard_count) {
+    throw std::runtime_error("Error! The move log holds the games of " + std::to_string(logged_shard_count) +
+                             " shards; start the server with --shards " + std::to_string(logged_shard_count) +
+                             " to recover them.");
+  }
+  if (reader.GetCompleteSize() < reader.GetSize()) {
+    std::cerr << "Cutting a torn record off the end of the move log." << std::endl;
+    if (truncate(log_path.c_str(), static_cast<off_t>(reader.GetCompleteSize())) == -1) {
+      throw std::runtime_error("Error! Truncating the move log.");
+    }
+  }
+
+  for (size_t shard = 0; shard < shard_count; ++shard) {
+    if (sequences[shard] != 0 && !is_snapshot_logged[shard]) {
+      records[shard].clear();
+    }
+    stores[shard].Recover(snapshots[shard], records[shard]);
+    sequences[shard]       = std::max(sequences[shard], logged_sequences[shard]);
+    recovery.record_count += records[shard].size();
+    recovery.game_count   += stores[shard].GetCount();
+  }
+  recovery.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return recovery;
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Submit
+ * ------------------------------------------------------------------------------------
+ * @brief Hands a shard's snapshot to the writer.
+ *
+ * @param snapshot [in,out] The snapshot to write; it is swapped for the buffers of an
+ *                          older snapshot, for the shard to take its next one in.
+ * ------------------------------------------------------------------------------------
+ */
+void GameSnapshots::Submit(int shard_index, GameStore::Snapshot& snapshot) {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    std::swap(pending[shard_index], snapshot);
+    is_pending[shard_index] = true;
+  }
+  wake.notify_one();
+}
+
+/* The writer: writes every pending snapshot, off the lock, until the snapshots are destroyed. */
+void GameSnapshots::WriteSnapshots() {
+  GameStore::Snapshot snapshot;
+  std::string bytes;
+  std::unique_lock<std::mutex> guard(lock);
+  while (1) {
+    auto found = std::find(is_pending.begin(), is_pending.end(), true);
+    if (found == is_pending.end()) {
+      if (is_stopping) {
+        return;
+      }
+      wake.wait(guard);
+      continue;
+    }
+    const int shard_index = static_cast<int>(found - is_pending.begin());
+    std::swap(snapshot, pending[shard_index]);
+    *found = false;
+    guard.unlock();
+    if (!WriteSnapshot(SnapshotPath(shard_index), snapshot, bytes)) {
+      std::cerr << "Error! Writing the snapshot of shard " << shard_index << "." << std::endl;
+    }
+    guard.lock();
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: WriteSnapshot
+ * ------------------------------------------------------------------------------------
+ * @brief Encodes a snapshot and replaces the file at path with it, through a synced
+ *        temporary file, so a crash leaves either the old snapshot or the new one.
+ *
+ * @param bytes A buffer to encode into, reused from one snapshot to the next.
+ *
+ * @return False if the snapshot could not be written; the old one is kept.
+ * ------------------------------------------------------------------------------------
+ */
+bool GameSnapshots::WriteSnapshot(const std::string& path, const GameStore::Snapshot& snapshot, std::string& bytes) {
+  const size_t row_count = snapshot.game_ids.size();
+  bytes.assign(FILE_MAGIC, sizeof(FILE_MAGIC));
+  AppendBigEndian(bytes, snapshot.sequence, 4);
+  AppendBigEndian(bytes, snapshot.log_offset, 8);
+  AppendBigEndian(bytes, row_count, 4);
+  AppendColumn(bytes, snapshot.x_masks, 2);
+  AppendColumn(bytes, snapshot.o_masks, 2);
+  AppendColumn(bytes, snapshot.move_counts, 2);
+  AppendColumn(bytes, snapshot.sides_to_move, 1);
+  AppendColumn(bytes, snapshot.game_ids, 4);
+  AppendColumn(bytes, snapshot.is_live, 1);
+
+  const std::string temporary_path = path + ".tmp";
+  int snapshot_file = open(temporary_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (snapshot_file == -1) {
+    return false;
+  }
+  bool is_written = WriteAll(snapshot_file, bytes.data(), bytes.size()) && fdatasync(snapshot_file) == 0;
+  is_written      = close(snapshot_file) == 0 && is_written;
+  return is_written && rename(temporary_path.c_str(), path.c_str()) == 0;
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: ReadSnapshot
+ * ------------------------------------------------------------------------------------
+ * @brief Loads a snapshot file.
+ *
+ * @throws std::runtime_error if the file exists but does not hold a whole snapshot.
+ *
+ * @return False if there is no snapshot file.
+ * ------------------------------------------------------------------------------------
+ */
+bool GameSnapshots::ReadSnapshot(const std::string& path, GameStore::Snapshot& snapshot) {
+  const size_t header_size   = sizeof(FILE_MAGIC) + 16;
+  const size_t bytes_per_row = 2 + 2 + 2 + 1 + 4 + 1;
+  int snapshot_file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (snapshot_file == -1) {
+    if (errno == ENOENT) {
+      return false;
+    }
+    throw std::runtime_error("Error! Opening " + path + ".");
+  }
+  std::string bytes;
+  char chunk[1 << 16];
+  ssize_t bytes_read;
+  while ((bytes_read = read(snapshot_file, chunk, sizeof(chunk))) != 0) {
+    if (bytes_read == -1 && errno != EINTR) {
+      close(snapshot_file);
+      throw std::runtime_error("Error! Reading " + path + ".");
+    }
+    if (bytes_read > 0) {
+      bytes.append(chunk, static_cast<size_t>(bytes_read));
+    }
+  }
+  close(snapshot_file);
+  const char* cursor = bytes.data();
+  if (bytes.size() < header_size || memcmp(cursor, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+    throw std::runtime_error("Error! " + path + " is not a snapshot.");
+  }
+  snapshot.sequence      = static_cast<uint32_t>(GetBigEndian(cursor + sizeof(FILE_MAGIC), 4));
+  snapshot.log_offset    = GetBigEndian(cursor + sizeof(FILE_MAGIC) + 4, 8);
+  const size_t row_count = static_cast<size_t>(GetBigEndian(cursor + sizeof(FILE_MAGIC) + 12, 4));
+  if (bytes.size() != header_size + row_count * bytes_per_row) {
+    throw std::runtime_error("Error! " + path + " is not a whole snapshot.");
+  }
+  cursor += header_size;
+  GetColumn(cursor, snapshot.x_masks, row_count, 2);
+  GetColumn(cursor, snapshot.o_masks, row_count, 2);
+  GetColumn(cursor, snapshot.move_counts, row_count, 2);
+  GetColumn(cursor, snapshot.sides_to_move, row_count, 1);
+  GetColumn(cursor, snapshot.game_ids, row_count, 4);
+  GetColumn(cursor, snapshot.is_live, row_count, 1);
+  return true;
+}
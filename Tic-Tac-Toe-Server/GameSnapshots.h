@@ -0,0 +1,73 @@
+#ifndef GameSnapshots_h
+#define GameSnapshots_h
+#include "GameStore.h"
+#include "MoveLog.h"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* -------------------------------------------------------------------------------------
+ * CLASS NAME: GameSnapshots
+ * -------------------------------------------------------------------------------------
+ * @brief Writes the shards' snapshots of their games to disk, and rebuilds the shards'
+ *        games from those snapshots and the move log when the server starts again.
+ *
+ * Every shard has one snapshot file, named after the move log: "<log>.snapshot-<shard>".
+ * A shard takes a snapshot with GameStore::TakeSnapshot and hands it to Submit, which
+ * swaps it with the shard's pending snapshot under a lock and wakes the writer thread;
+ * the shard gets an older snapshot's buffers back to take the next one in, so neither
+ * side allocates once warmed up. The writer encodes the snapshot, writes it to a
+ * temporary file, syncs it and renames it over the shard's file, so the file always
+ * holds a whole snapshot. A snapshot that is still pending when the next one arrives
+ * is dropped for it.
+ *
+ * Recover loads every shard's snapshot, then reads the move log once, from the oldest
+ * snapshot's log offset on, keeping each shard's records after the SNAPSHOT record of
+ * its snapshot, and replays them into the shard's GameStore. Only the log written
+ * since the snapshots is read, however long the log has grown. A record torn by a
+ * crash at the end of the log is cut off, so the log can be appended to again.
+ *
+ * A snapshot file is FILE_MAGIC, then the snapshot's sequence (4 bytes), log offset (8
+ * bytes) and row count (4 bytes), then the columns one after the other: X masks, O
+ * masks and move counts (2 bytes per row), sides to move (1 byte), game IDs (4 bytes)
+ * and live flags (1 byte), all big-endian.
+ * -------------------------------------------------------------------------------------
+ */
+class GameSnapshots {
+  public:
+    /* What Recover found, for the server to report. */
+    struct Recovery {
+      uint32_t game_count;
+      uint64_t snapshot_row_count;
+      uint64_t record_count;  // Records replayed after the snapshots.
+      uint64_t log_bytes_read;
+      double seconds;
+    };
+
+    GameSnapshots(const std::string& log_path, int shard_count);
+    ~GameSnapshots();
+    Recovery Recover(std::vector<GameStore>& stores);
+    uint32_t GetSequence(int shard_index) const { return sequences[shard_index]; }
+    void Submit(int shard_index, GameStore::Snapshot& snapshot);
+
+  private:
+    static const char FILE_MAGIC[8];
+
+    std::string log_path;
+    std::vector<uint32_t> sequences;  // The sequence of each shard's last snapshot, 0 for none.
+    std::vector<GameStore::Snapshot> pending;
+    std::vector<uint8_t> is_pending;
+    std::mutex lock;
+    std::condition_variable wake;
+    bool is_stopping;
+    std::thread writer;
+
+    std::string SnapshotPath(int shard_index) const;
+    void WriteSnapshots();
+    static bool WriteSnapshot(const std::string& path, const GameStore::Snapshot& snapshot, std::string& bytes);
+    static bool ReadSnapshot(const std::string& path, GameStore::Snapshot& snapshot);
+};
+#endif /* GameSnapshots_h */
@@ -0,0 +1,463 @@
+#ifndef GameStore_h
+#define GameStore_h
+#include "Game.h"
+#include "GameManager.h"
+#include "MoveLog.h"
+#include "Status.h"
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+/* -------------------------------------------------------------------------------------
+ * CLASS NAME: GameStore
+ * -------------------------------------------------------------------------------------
+ * @brief Creates, finds and retires the games a server hosts, by a compact game ID, and
+ *        keeps their state column by column.
+ *
+ * Every game is a row of the store, and every field of the games is its own contiguous
+ * array indexed by the row: the X masks, the O masks, the move counts, the side to
+ * move and the sockets of the two players. A pass over every game, such as GetCensus
+ * or a snapshot, streams through the few columns it reads instead of visiting each
+ * game object in turn, and 32 games' masks share a cache line.
+ *
+ * A game ID is the game's row (the low INDEX_BITS bits) under the row's generation,
+ * which changes every time the game is retired. A retired row goes on a free list and
+ * is reused by the next game created; the columns grow to the server's busiest moment
+ * and are never shrunk, so once warmed up, starting and finishing a game touches no
+ * heap. An ID kept past its game's end finds nothing instead of the game that reused
+ * the row.
+ *
+ * Find returns a GameRef, which plays moves on the row through a GameManager over the
+ * row's columns, and hands out the position as a Game for the players of the server's
+ * side. GameStore is BasicGameStore over the 3x3 Game; one store belongs to one
+ * thread, as GameServer does.
+ *
+ * With SetMoveLog, every game created and retired and every move played is appended
+ * to the shard's MoveLog writer; refused moves change nothing and are not logged.
+ *
+ * TakeSnapshot copies the columns of the games' state into a Snapshot, a few block
+ * copies that leave the store free to go on at once, and marks the point in the
+ * move log the snapshot was taken at. Recover rebuilds a store from its last snapshot
+ * and the records logged after that point, keeping every game's ID.
+ * -------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+class BasicGameStore {
+  public:
+    typedef uint32_t GameId;
+    typedef typename GameType::Masks Masks;
+    typedef typename GameType::Mask Mask;
+    static constexpr GameId NO_GAME   = 0xffffffffu;
+    static constexpr char NO_SIDE     = BasicGameManager<GameType>::NO_SIDE;
+    static constexpr int NO_PLAYER    = -1;  // The socket of an empty seat.
+    static constexpr int HOUSE_PLAYER = -2;  // The socket of the house player's seat.
+
+    /* A pass over every live game, see GetCensus. */
+    struct Census {
+      uint32_t game_count;
+      uint32_t x_to_move_count;
+      uint32_t o_to_move_count;
+      uint32_t over_count;  // Games that are over but not retired yet.
+      uint64_t move_count;
+    };
+
+    /* The games' state, column by column, as TakeSnapshot copied it. The players'
+       sockets are left out: they do not outlive the server. */
+    struct Snapshot {
+      uint32_t sequence;    // Numbers the snapshots of a store, see MoveLog::SNAPSHOT.
+      uint64_t log_offset;  // The size the move log was committed to when the snapshot was taken.
+      std::vector<Mask> x_masks;
+      std::vector<Mask> o_masks;
+      std::vector<uint16_t> move_counts;
+      std::vector<char> sides_to_move;
+      std::vector<GameId> game_ids;
+      std::vector<uint8_t> is_live;
+    };
+
+    /* ------------------------------------------------------------------------------------
+     * CLASS NAME: GameRef
+     * ------------------------------------------------------------------------------------
+     * @brief A live game of the store, played through a GameManager.
+     *
+     * @note A GameRef holds the game's row, not pointers into the columns, so it stays
+     *       valid while the columns grow; it is only good until the game is retired.
+     * ------------------------------------------------------------------------------------
+     */
+    class GameRef {
+      public:
+        GameRef(BasicGameStore* store, uint32_t row) : store(store), row(row) {}
+        explicit operator bool() const { return store != nullptr; }
+        Status MakeMove(const int row_number, const int column_number, const char letter, int move_counter);
+        GameType GetGame() const;
+        uint32_t PackBoard() const { return Masks::Pack(store->x_masks[row], store->o_masks[row]); }
+        char GetSideToMove() const { return store->sides_to_move[row]; }
+        int GetMoveCount() const { return store->move_counts[row]; }
+        void SetPlayers(int x_socket, int o_socket);
+        int GetPlayer(char letter) const;
+        void SetPlayer(char letter, int socket);
+
+      private:
+        BasicGameStore* store;
+        uint32_t row;
+    };
+
+    BasicGameStore() : free_row(NO_ROW), game_count(0), move_log(nullptr) {}
+    void SetMoveLog(MoveLog::Writer* move_log) { this->move_log = move_log; }
+    GameId Create();
+    GameRef Find(const GameId game_id);
+    void Retire(const GameId game_id);
+    uint32_t GetCount() const { return game_count; }
+    Census GetCensus() const;
+    void GetOpenGameIds(std::vector<GameId>& open_game_ids) const;
+    void TakeSnapshot(Snapshot& snapshot, uint32_t sequence) const;
+    void Recover(const Snapshot& snapshot, const std::vector<MoveLog::Record>& records);
+
+  private:
+    static constexpr int INDEX_BITS      = 24;
+    static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+    static constexpr uint32_t NO_ROW     = INDEX_MASK;  // Also keeps NO_GAME from being a game's ID.
+
+    std::vector<Mask> x_masks;
+    std::vector<Mask> o_masks;
+    std::vector<uint16_t> move_counts;
+    std::vector<char> sides_to_move;
+    std::vector<int> x_sockets;
+    std::vector<int> o_sockets;
+    std::vector<GameId> game_ids;     // The ID of the row's game, or of its next game while it is free.
+    std::vector<uint8_t> is_live;
+    std::vector<uint32_t> next_free;  // The next free row, while the row is free.
+    uint32_t free_row;
+    uint32_t game_count;
+    MoveLog::Writer* move_log;  // nullptr when moves are not logged.
+
+    void AddRows(size_t row_count);
+    void Replay(const MoveLog::Record& record);
+};
+
+typedef BasicGameStore<Game> GameStore;
+
+template <typename GameType>
+constexpr typename BasicGameStore<GameType>::GameId BasicGameStore<GameType>::NO_GAME;
+template <typename GameType>
+constexpr char BasicGameStore<GameType>::NO_SIDE;
+template <typename GameType>
+constexpr int BasicGameStore<GameType>::NO_PLAYER;
+template <typename GameType>
+constexpr int BasicGameStore<GameType>::HOUSE_PLAYER;
+template <typename GameType>
+constexpr uint32_t BasicGameStore<GameType>::NO_ROW;
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Create
+ * ------------------------------------------------------------------------------------
+ * @brief Starts a new game, X to move, on a free row, growing every column by a row
+ *        when every row is taken.
+ *
+ * @throws std::runtime_error if the store holds as many games as IDs can tell apart.
+ *
+ * @return The ID of the new game.
+ * ------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+typename BasicGameStore<GameType>::GameId BasicGameStore<GameType>::Create() {
+  uint32_t row = free_row;
+  if (row != NO_ROW) {
+    free_row = next_free[row];
+  } else {
+    if (game_ids.size() == NO_ROW) {
+      throw std::runtime_error("Error! Too many games.");
+    }
+    row = static_cast<uint32_t>(game_ids.size());
+    AddRows(row + 1);
+  }
+  x_masks[row]       = Mask();
+  o_masks[row]       = Mask();
+  move_counts[row]   = 0;
+  sides_to_move[row] = 'X';
+  x_sockets[row]     = NO_PLAYER;
+  o_sockets[row]     = NO_PLAYER;
+  is_live[row]       = true;
+  ++game_count;
+  if (move_log) {
+    move_log->Append(MoveLog::CREATE, game_ids[row]);
+  }
+
+  return game_ids[row];
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Find
+ * ------------------------------------------------------------------------------------
+ * @brief Looks a game up by its ID.
+ *
+ * @return The game, or a GameRef that tests false if the game was retired or never
+ *         existed.
+ * ------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+typename BasicGameStore<GameType>::GameRef BasicGameStore<GameType>::Find(const GameId game_id) {
+  const uint32_t row = game_id & INDEX_MASK;
+  if (row >= game_ids.size() || !is_live[row] || game_ids[row] != game_id) {
+    return GameRef(nullptr, 0);
+  }
+  return GameRef(this, row);
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Retire
+ * ------------------------------------------------------------------------------------
+ * @brief Ends a game and puts its row on the free list under a new generation.
+ *        Retiring a game that is not live does nothing.
+ * ------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+void BasicGameStore<GameType>::Retire(const GameId game_id) {
+  if (!Find(game_id)) {
+    return;
+  }
+  const uint32_t row = game_id & INDEX_MASK;
+  is_live[row]       = false;
+  game_ids[row]      = game_id + (1u << INDEX_BITS);  // The next generation; wraps around, keeping the row.
+  next_free[row]     = free_row;
+  free_row           = row;
+  --game_count;
+  if (move_log) {
+    move_log->Append(MoveLog::RETIRE, game_id);
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: GetCensus
+ * ------------------------------------------------------------------------------------
+ * @brief Counts the live games by side to move, and the moves played in them, in one
+ *        linear pass over three columns.
+ * ------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+typename BasicGameStore<GameType>::Census BasicGameStore<GameType>::GetCensus() const {
+  Census census = {};
+  const size_t row_count = game_ids.size();
+  for (size_t row = 0; row < row_count; ++row) {
+    // Branch-free, so the loop vectorizes; free rows count for nothing.
+    const uint32_t live = is_live[row];
+    census.game_count      += live;
+    census.x_to_move_count += live & (sides_to_move[row] == 'X');
+    census.o_to_move_count += live & (sides_to_move[row] == 'O');
+    census.over_count      += live & (sides_to_move[row] == NO_SIDE);
+    census.move_count      += live * move_counts[row];
+  }
+  return census;
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: GetOpenGameIds
+ * ------------------------------------------------------------------------------------
+ * @brief Lists the ID of every live game with an empty seat, as the games Recover
+ *        rebuilds have until their players take their seats back. One pass over the
+ *        sockets' columns.
+ * ------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+void BasicGameStore<GameType>::GetOpenGameIds(std::vector<GameId>& open_game_ids) const {
+  open_game_ids.clear();
+  for (size_t row = 0; row < game_ids.size(); ++row) {
+    if (is_live[row] && (x_sockets[row] == NO_PLAYER || o_sockets[row] == NO_PLAYER)) {
+      open_game_ids.push_back(game_ids[row]);
+    }
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: TakeSnapshot
+ * ------------------------------------------------------------------------------------
+ * @brief Copies the state of every game into a snapshot, and appends a SNAPSHOT record
+ *        carrying its sequence to the move log, between the moves before the snapshot
+ *        and the moves after it. The snapshot keeps the size of the log already on disk,
+ *        which ends before its SNAPSHOT record.
+ *
+ * @details Each column is one block copy into the snapshot's own vector, which keeps
+ *          its capacity from one snapshot to the next, so taking a snapshot of a warmed
+ *          up store touches no heap.
+ * ------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+void BasicGameStore<GameType>::TakeSnapshot(Snapshot& snapshot, uint32_t sequence) const {
+  snapshot.sequence      = sequence;
+  snapshot.log_offset    = move_log ? move_log->GetCommittedSize() : 0;
+  snapshot.x_masks       = x_masks;
+  snapshot.o_masks       = o_masks;
+  snapshot.move_counts   = move_counts;
+  snapshot.sides_to_move = sides_to_move;
+  snapshot.game_ids      = game_ids;
+  snapshot.is_live       = is_live;
+  if (move_log) {
+    move_log->Append(MoveLog::SNAPSHOT, sequence);
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Recover
+ * ------------------------------------------------------------------------------------
+ * @brief Replaces the store's games with those of a snapshot, then replays the records
+ *        the store logged after the snapshot was taken.
+ *
+ * @details Replayed games take the rows their IDs name, so every game keeps its ID,
+ *          and the free list is rebuilt from the rows left free at the end. Nothing
+ *          replayed is logged again. Every seat of a recovered game is empty, NO_PLAYER,
+ *          until its player takes it back.
+ *
+ * @param snapshot The store's last snapshot, or an empty one to replay the whole log.
+ * @param records  The store's CREATE, MOVE and RETIRE records logged after the snapshot,
+ *                 in the order they were logged.
+ * ------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+void BasicGameStore<GameType>::Recover(const Snapshot& snapshot, const std::vector<MoveLog::Record>& records) {
+  x_masks       = snapshot.x_masks;
+  o_masks       = snapshot.o_masks;
+  move_counts   = snapshot.move_counts;
+  sides_to_move = snapshot.sides_to_move;
+  game_ids      = snapshot.game_ids;
+  is_live       = snapshot.is_live;
+  x_sockets.assign(game_ids.size(), NO_PLAYER);
+  o_sockets.assign(game_ids.size(), NO_PLAYER);
+  next_free.assign(game_ids.size(), NO_ROW);
+  for (const MoveLog::Record& record : records) {
+    Replay(record);
+  }
+  free_row   = NO_ROW;
+  game_count = 0;
+  for (size_t row = game_ids.size(); row-- > 0;) {
+    if (is_live[row]) {
+      ++game_count;
+    } else {
+      next_free[row] = free_row;
+      free_row       = static_cast<uint32_t>(row);
+    }
+  }
+}
+
+/* Grows every column to row_count rows; the new rows are free. */
+template <typename GameType>
+void BasicGameStore<GameType>::AddRows(size_t row_count) {
+  while (game_ids.size() < row_count) {
+    x_masks.emplace_back();
+    o_masks.emplace_back();
+    move_counts.push_back(0);
+    sides_to_move.push_back(NO_SIDE);
+    x_sockets.push_back(NO_PLAYER);
+    o_sockets.push_back(NO_PLAYER);
+    game_ids.push_back(static_cast<GameId>(game_ids.size()));
+    is_live.push_back(false);
+    next_free.push_back(NO_ROW);
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Replay
+ * ------------------------------------------------------------------------------------
+ * @brief Applies a logged record to the row its game ID names, as Create, MakeMove or
+ *        Retire did when it was logged. A record of a game the row no longer holds is
+ *        skipped.
+ * ------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+void BasicGameStore<GameType>::Replay(const MoveLog::Record& record) {
+  const uint32_t row = record.game_id & INDEX_MASK;
+  if (record.kind == MoveLog::CREATE) {
+    AddRows(row + 1);
+    x_masks[row]       = Mask();
+    o_masks[row]       = Mask();
+    move_counts[row]   = 0;
+    sides_to_move[row] = 'X';
+    game_ids[row]      = record.game_id;
+    is_live[row]       = true;
+    return;
+  }
+  if (row >= game_ids.size() || !is_live[row] || game_ids[row] != record.game_id) {
+    return;
+  }
+  if (record.kind == MoveLog::RETIRE) {
+    is_live[row]  = false;
+    game_ids[row] = record.game_id + (1u << INDEX_BITS);
+  } else if (record.kind == MoveLog::MOVE) {
+    Masks::Set(record.letter == 'X' ? x_masks[row] : o_masks[row], record.spot);
+    ++move_counts[row];
+    const StatusCode status_code = static_cast<StatusCode>(record.status);
+    if (status_code == StatusCode::WIN || status_code == StatusCode::TIE) {
+      sides_to_move[row] = NO_SIDE;
+    } else {
+      sides_to_move[row] = record.letter == 'X' ? 'O' : 'X';
+    }
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: MakeMove
+ * ------------------------------------------------------------------------------------
+ * @brief Validates and plays a move on the game's row with a GameManager over the
+ *        row's columns, and logs the move if it was played.
+ *
+ * @param row_number    The 1-based row of the move.
+ * @param column_number The 1-based column of the move.
+ * @param letter        The player's symbol ('X' or 'O').
+ * @param move_counter  The current move count.
+ *
+ * @return Status object containing game information (status code, packed game board, letter).
+ * ------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+Status BasicGameStore<GameType>::GameRef::MakeMove(const int row_number, const int column_number,
+                                                   const char letter, int move_counter) {
+  BasicGameManager<GameType> game_manager(store->x_masks[row], store->o_masks[row], store->move_counts[row],
+                                          store->sides_to_move[row]);
+  Status status = game_manager.MakeMove(row_number, column_number, letter, move_counter);
+  if (status.status_code != StatusCode::ERROR && store->move_log) {
+    store->move_log->Append(MoveLog::MOVE, store->game_ids[row], letter, GameType::Spot(row_number, column_number),
+                            move_counter, static_cast<uint8_t>(status.status_code));
+  }
+
+  return status;
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: GetGame
+ * ------------------------------------------------------------------------------------
+ * @brief Builds the game's position as a Game, for the players of the server's side
+ *        and for display.
+ * ------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+GameType BasicGameStore<GameType>::GameRef::GetGame() const {
+  GameType game;
+  for (int spot = 0; spot < GameType::SPOT_COUNT; ++spot) {
+    const int row_number    = spot / GameType::BOARD_COLUMNS + 1;
+    const int column_number = spot % GameType::BOARD_COLUMNS + 1;
+    if (Masks::Test(store->x_masks[row], spot)) {
+      game.InsertMove(row_number, column_number, 'X');
+    } else if (Masks::Test(store->o_masks[row], spot)) {
+      game.InsertMove(row_number, column_number, 'O');
+    }
+  }
+  return game;
+}
+
+/* Records the sockets of the game's players; HOUSE_PLAYER for the house player. */
+template <typename GameType>
+void BasicGameStore<GameType>::GameRef::SetPlayers(int x_socket, int o_socket) {
+  store->x_sockets[row] = x_socket;
+  store->o_sockets[row] = o_socket;
+}
+
+/* The socket of the player of one seat, NO_PLAYER if the seat is empty. */
+template <typename GameType>
+int BasicGameStore<GameType>::GameRef::GetPlayer(char letter) const {
+  return letter == 'X' ? store->x_sockets[row] : store->o_sockets[row];
+}
+
+/* Seats a player, or empties the seat with NO_PLAYER. */
+template <typename GameType>
+void BasicGameStore<GameType>::GameRef::SetPlayer(char letter, int socket) {
+  (letter == 'X' ? store->x_sockets[row] : store->o_sockets[row]) = socket;
+}
+#endif /* GameStore_h */
@@ -0,0 +1,30 @@
+#include "HouseRequestManager.h"
+
+namespace Request_Manager {
+  /* ----------------------------------------------------------------------
+   * FUNCTION NAME: GetMove
+   * ----------------------------------------------------------------------
+   * @brief Picks the first available spot on the game board.
+   *
+   * @param game    [in] The game the move is made on.
+   * @param letter  [in] The player's symbol ('X' or 'O').
+   *
+   * @return Returns the row and column number of the first available spot,
+   *         or row and column 0 if the game board is full.
+   * ----------------------------------------------------------------------
+   */
+  Player HouseRequestManager::GetMove(const Game& game, const char letter) {
+    Player player = { 0, 0 };
+    for (int row = 1; row <= 3; ++row) {
+      for (int column = 1; column <= 3; ++column) {
+        if (game.IsMoveValid(row, column)) {
+          player.row    = row;
+          player.column = column;
+          return player;
+        }
+      }
+    }
+    
+    return player;
+  }
+}
@@ -0,0 +1,23 @@
+#ifndef HouseRequestManager_h
+#define HouseRequestManager_h
+#include "IRequestManager.h"
+
+namespace Request_Manager {
+/* ------------------------------------------------------------------
+ * CLASS NAME: HouseRequestManager
+ * ------------------------------------------------------------------
+ * @brief Plays the server's side of a game without a person.
+ *
+ * The HouseRequestManager class implements the IRequestManager
+ * interface for games hosted by the event loop, where nobody sits at
+ * the server's terminal. It plays the first available spot, scanning
+ * the game board row by row.
+ * ------------------------------------------------------------------
+ */
+  class HouseRequestManager : public IRequestManager {
+    public:
+      HouseRequestManager() = default;
+      Player GetMove(const Game& game, const char letter);
+  };
+}
+#endif /* HouseRequestManager_h */
@@ -1,21 +1,25 @@
 #ifndef IRequestManager_h
 #define IRequestManager_h
+#include "Game.h"
+#include "Player.h"
 
 /* -----------------------------------------------------------------------------------
  * CLASS NAME: IRequestManager
  * -----------------------------------------------------------------------------------
- * @brief Interface for handling user input in a Tic-Tac-Toe game.
+ * @brief Interface for producing a player's move in a Tic-Tac-Toe game.
  *
- * The IRequesManager interface declares a method for getting validated
- * user input and column numbers during a game. Classes that implements
- * this interface should provide their implementation of the GetUserValidatedUserInput
- * method.
+ * The IRequesManager interface declares a method for getting the next row and
+ * column number to play on a game board. Classes that implements this interface
+ * decide where the move comes from, e.g. a person typing at the server's terminal
+ * or a player that is run by the server itself.
+ *
+ * @note Row and column numbers in the returned Player are 1-based (1-3).
  * -----------------------------------------------------------------------------------
  */
 
 class IRequestManager {
   public:
-    virtual int GetValidatedUserInput(int& user_input, const int row, const int column, const char letter) = 0;
+    virtual Player GetMove(const Game& game, const char letter) = 0;
     virtual ~IRequestManager() {}
 };
 #endif /* IRequestManager_h */
@@ -0,0 +1,275 @@
+#include "IoUring.h"
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <csignal>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+/* ----------------------------------------------------------------------------------------
+ * CONSTRUCTOR NAME: IoUring
+ * ----------------------------------------------------------------------------------------
+ * @brief Sets up an io_uring instance and registers its provided receive buffers.
+ *
+ * @param entries      The number of submission entries of the ring.
+ * @param buffer_count The number of provided receive buffers (a power of two).
+ * @param buffer_size  The size of each provided receive buffer (in bytes).
+ *
+ * @throws std::runtime_error if the kernel does not support io_uring (or it is disabled),
+ *                            or if mapping the rings or registering the buffers fails.
+ * ----------------------------------------------------------------------------------------
+ */
+IoUring::IoUring(unsigned entries, unsigned buffer_count, unsigned buffer_size)
+    : ring_socket(-1), submission_pending(0), submission_ring(MAP_FAILED), submission_ring_size(0),
+      completion_ring(MAP_FAILED), completion_ring_size(0), submission_entries(nullptr),
+      submission_entries_size(0), submission_local_tail(0), buffer_ring(nullptr), buffer_ring_size(0),
+      buffers(nullptr), buffer_count(buffer_count), buffer_size(buffer_size) {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  params.flags = IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN | IORING_SETUP_SINGLE_ISSUER;
+  ring_socket  = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+  if (ring_socket == -1) {
+    throw std::runtime_error("Error! Setting up io_uring.");
+  }
+  
+  // Map the submission and completion rings, which share one mapping on recent kernels.
+  submission_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  completion_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    if (completion_ring_size > submission_ring_size) {
+      submission_ring_size = completion_ring_size;
+    }
+    completion_ring_size = submission_ring_size;
+  }
+  submission_ring = mmap(nullptr, submission_ring_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ring_socket, IORING_OFF_SQ_RING);
+  if (submission_ring == MAP_FAILED) {
+    Release();
+    throw std::runtime_error("Error! Mapping io_uring submission ring.");
+  }
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    completion_ring = submission_ring;
+  } else {
+    completion_ring = mmap(nullptr, completion_ring_size, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, ring_socket, IORING_OFF_CQ_RING);
+    if (completion_ring == MAP_FAILED) {
+      Release();
+      throw std::runtime_error("Error! Mapping io_uring completion ring.");
+    }
+  }
+  submission_entries_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  void* entries_map = mmap(nullptr, submission_entries_size, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, ring_socket, IORING_OFF_SQES);
+  if (entries_map == MAP_FAILED) {
+    Release();
+    throw std::runtime_error("Error! Mapping io_uring submission entries.");
+  }
+  submission_entries = static_cast<struct io_uring_sqe*>(entries_map);
+  
+  char* submission_base  = static_cast<char*>(submission_ring);
+  char* completion_base  = static_cast<char*>(completion_ring);
+  submission_head        = reinterpret_cast<unsigned*>(submission_base + params.sq_off.head);
+  submission_tail        = reinterpret_cast<unsigned*>(submission_base + params.sq_off.tail);
+  submission_mask        = *reinterpret_cast<unsigned*>(submission_base + params.sq_off.ring_mask);
+  submission_entry_count = *reinterpret_cast<unsigned*>(submission_base + params.sq_off.ring_entries);
+  submission_array       = reinterpret_cast<unsigned*>(submission_base + params.sq_off.array);
+  submission_local_tail  = *submission_tail;
+  completion_head        = reinterpret_cast<unsigned*>(completion_base + params.cq_off.head);
+  completion_tail        = reinterpret_cast<unsigned*>(completion_base + params.cq_off.tail);
+  completion_mask        = *reinterpret_cast<unsigned*>(completion_base + params.cq_off.ring_mask);
+  completion_entries     = reinterpret_cast<struct io_uring_cqe*>(completion_base + params.cq_off.cqes);
+  RegisterBuffers();
+}
+
+IoUring::~IoUring() {
+  Release();
+}
+
+/* ----------------------------------------------------------------------------------------
+ * FUNCTION NAME: RegisterBuffers
+ * ----------------------------------------------------------------------------------------
+ * @brief Allocates the receive buffers and registers them as a provided buffer ring.
+ *
+ * The kernel picks a free buffer from the ring for every multishot receive completion,
+ * so receives never need a buffer of their own while they wait for data.
+ *
+ * @throws std::runtime_error if the kernel does not support provided buffer rings.
+ * ----------------------------------------------------------------------------------------
+ */
+void IoUring::RegisterBuffers() {
+  buffer_ring_size = buffer_count * sizeof(struct io_uring_buf);
+  void* ring_map   = mmap(nullptr, buffer_ring_size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ring_map == MAP_FAILED) {
+    Release();
+    throw std::runtime_error("Error! Allocating io_uring buffer ring.");
+  }
+  buffer_ring = static_cast<struct io_uring_buf_ring*>(ring_map);
+  buffers     = new char[static_cast<size_t>(buffer_count) * buffer_size];
+  
+  struct io_uring_buf_reg registration;
+  memset(&registration, 0, sizeof(registration));
+  registration.ring_addr    = reinterpret_cast<uint64_t>(buffer_ring);
+  registration.ring_entries = buffer_count;
+  registration.bgid         = BUFFER_GROUP;
+  if (syscall(__NR_io_uring_register, ring_socket, IORING_REGISTER_PBUF_RING, &registration, 1) == -1) {
+    Release();
+    throw std::runtime_error("Error! Registering io_uring buffer ring.");
+  }
+  buffer_ring->tail = 0;
+  for (unsigned buffer_id = 0; buffer_id < buffer_count; ++buffer_id) {
+    RecycleBuffer(static_cast<uint16_t>(buffer_id));
+  }
+}
+
+/* ----------------------------------------------------------------------------------------
+ * FUNCTION NAME: Release
+ * ----------------------------------------------------------------------------------------
+ * @brief Unmaps the rings, frees the receive buffers and closes the io_uring instance.
+ * ----------------------------------------------------------------------------------------
+ */
+void IoUring::Release() {
+  if (buffer_ring != nullptr) {
+    munmap(buffer_ring, buffer_ring_size);
+    buffer_ring = nullptr;
+  }
+  delete[] buffers;
+  buffers = nullptr;
+  if (submission_entries != nullptr) {
+    munmap(submission_entries, submission_entries_size);
+    submission_entries = nullptr;
+  }
+  if (completion_ring != MAP_FAILED && completion_ring != submission_ring) {
+    munmap(completion_ring, completion_ring_size);
+  }
+  completion_ring = MAP_FAILED;
+  if (submission_ring != MAP_FAILED) {
+    munmap(submission_ring, submission_ring_size);
+    submission_ring = MAP_FAILED;
+  }
+  if (ring_socket != -1) {
+    close(ring_socket);
+    ring_socket = -1;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------
+ * FUNCTION NAME: GetSubmission
+ * ----------------------------------------------------------------------------------------
+ * @brief Returns a cleared submission entry to prepare a request in.
+ *
+ * The request is only handed to the kernel by the next SubmitAndWait call. When every
+ * submission entry is taken, the pending requests are submitted first.
+ *
+ * @return A pointer to the submission entry.
+ * ----------------------------------------------------------------------------------------
+ */
+struct io_uring_sqe* IoUring::GetSubmission() {
+  unsigned head = __atomic_load_n(submission_head, __ATOMIC_ACQUIRE);
+  if (submission_local_tail - head >= submission_entry_count) {
+    SubmitAndWait(0);
+  }
+  unsigned index                = submission_local_tail & submission_mask;
+  struct io_uring_sqe* entry    = &submission_entries[index];
+  memset(entry, 0, sizeof(*entry));
+  submission_array[index]       = index;
+  ++submission_local_tail;
+  ++submission_pending;
+  
+  return entry;
+}
+
+/* ----------------------------------------------------------------------------------------
+ * FUNCTION NAME: SubmitAndWait
+ * ----------------------------------------------------------------------------------------
+ * @brief Submits every prepared request with one system call and waits for completions.
+ *
+ * @param wait_count           The number of completions to wait for (0 does not wait).
+ * @param timeout_milliseconds The longest to wait for them, as an epoll_wait timeout (-1 waits
+ *                             for as long as it takes). Passed through IORING_ENTER_EXT_ARG.
+ *
+ * @throws std::runtime_error if io_uring_enter fails.
+ *
+ * @return The number of submitted requests.
+ * ----------------------------------------------------------------------------------------
+ */
+int IoUring::SubmitAndWait(unsigned wait_count, int timeout_milliseconds) {
+  __atomic_store_n(submission_tail, submission_local_tail, __ATOMIC_RELEASE);
+  unsigned flags = wait_count > 0 ? IORING_ENTER_GETEVENTS : 0;
+  struct __kernel_timespec timeout;
+  struct io_uring_getevents_arg wait_argument;
+  memset(&wait_argument, 0, sizeof(wait_argument));
+  if (wait_count > 0 && timeout_milliseconds >= 0) {
+    timeout.tv_sec           = timeout_milliseconds / 1000;
+    timeout.tv_nsec          = static_cast<long long>(timeout_milliseconds % 1000) * 1000000;
+    wait_argument.sigmask_sz = _NSIG / 8;
+    wait_argument.ts         = reinterpret_cast<uint64_t>(&timeout);
+    flags |= IORING_ENTER_EXT_ARG;
+  }
+  while (1) {
+    long submitted = flags & IORING_ENTER_EXT_ARG
+                         ? syscall(__NR_io_uring_enter, ring_socket, submission_pending, wait_count, flags,
+                                   &wait_argument, sizeof(wait_argument))
+                         : syscall(__NR_io_uring_enter, ring_socket, submission_pending, wait_count, flags,
+                                   nullptr, 0);
+    if (submitted >= 0) {
+      submission_pending -= static_cast<unsigned>(submitted);
+      return static_cast<int>(submitted);
+    }
+    if (errno == ETIME) {
+      return 0;  // Nothing was submitted and the timeout passed without a completion.
+    }
+    if (errno != EINTR) {
+      throw std::runtime_error("Error! Submitting io_uring requests.");
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------------------------
+ * FUNCTION NAME: PeekCompletion
+ * ----------------------------------------------------------------------------------------
+ * @return The oldest unread completion entry, or nullptr if there is none.
+ * ----------------------------------------------------------------------------------------
+ */
+struct io_uring_cqe* IoUring::PeekCompletion() {
+  unsigned head = *completion_head;
+  if (head == __atomic_load_n(completion_tail, __ATOMIC_ACQUIRE)) {
+    return nullptr;
+  }
+  
+  return &completion_entries[head & completion_mask];
+}
+
+/* ----------------------------------------------------------------------------------------
+ * FUNCTION NAME: AdvanceCompletion
+ * ----------------------------------------------------------------------------------------
+ * @brief Marks the completion entry returned by PeekCompletion as read.
+ * ----------------------------------------------------------------------------------------
+ */
+void IoUring::AdvanceCompletion() {
+  __atomic_store_n(completion_head, *completion_head + 1, __ATOMIC_RELEASE);
+}
+
+const char* IoUring::GetBuffer(uint16_t buffer_id) const {
+  return buffers + static_cast<size_t>(buffer_id) * buffer_size;
+}
+
+/* ----------------------------------------------------------------------------------------
+ * FUNCTION NAME: RecycleBuffer
+ * ----------------------------------------------------------------------------------------
+ * @brief Hands a provided receive buffer back to the kernel.
+ *
+ * @param buffer_id The id reported in the completion flags of the receive.
+ * ----------------------------------------------------------------------------------------
+ */
+void IoUring::RecycleBuffer(uint16_t buffer_id) {
+  // The ring is indexed by hand: compiled as C++, the kernel header's flexible bufs array
+  // is placed 8 bytes past the start of the ring instead of at its start.
+  unsigned short tail        = buffer_ring->tail;
+  struct io_uring_buf* entry = reinterpret_cast<struct io_uring_buf*>(buffer_ring) + (tail & (buffer_count - 1));
+  entry->addr = reinterpret_cast<uint64_t>(GetBuffer(buffer_id));
+  entry->len  = buffer_size;
+  entry->bid  = buffer_id;
+  __atomic_store_n(&buffer_ring->tail, static_cast<unsigned short>(tail + 1), __ATOMIC_RELEASE);
+}
@@ -0,0 +1,63 @@
+#ifndef IoUring_h
+#define IoUring_h
+#include <linux/io_uring.h>
+#include <cstddef>
+#include <cstdint>
+
+/* -------------------------------------------------------------------------------------
+ * CLASS NAME: IoUring
+ * -------------------------------------------------------------------------------------
+ * @brief A minimal io_uring submission/completion ring built on the raw system calls.
+ *
+ * The IoUring class sets up a ring with io_uring_setup, maps its submission queue,
+ * completion queue and submission entries, and registers a ring of provided receive
+ * buffers with the kernel. Requests are prepared with GetSubmission, all of them are
+ * submitted by a single SubmitAndWait call, and the results are read back with
+ * PeekCompletion/AdvanceCompletion.
+ *
+ * @note Receives that select a provided buffer report its id in the completion flags;
+ *       the buffer must be handed back with RecycleBuffer once its bytes are consumed.
+ * -------------------------------------------------------------------------------------
+ */
+class IoUring {
+  public:
+    IoUring(unsigned entries, unsigned buffer_count, unsigned buffer_size);
+    ~IoUring();
+    struct io_uring_sqe* GetSubmission();
+    int SubmitAndWait(unsigned wait_count, int timeout_milliseconds = -1);
+    struct io_uring_cqe* PeekCompletion();
+    void AdvanceCompletion();
+    const char* GetBuffer(uint16_t buffer_id) const;
+    void RecycleBuffer(uint16_t buffer_id);
+    static const uint16_t BUFFER_GROUP = 0;
+  
+  private:
+    int ring_socket;
+    unsigned submission_pending;
+    void* submission_ring;
+    size_t submission_ring_size;
+    void* completion_ring;
+    size_t completion_ring_size;
+    struct io_uring_sqe* submission_entries;
+    size_t submission_entries_size;
+    unsigned* submission_head;
+    unsigned* submission_tail;
+    unsigned submission_mask;
+    unsigned submission_entry_count;
+    unsigned* submission_array;
+    unsigned submission_local_tail;
+    unsigned* completion_head;
+    unsigned* completion_tail;
+    unsigned completion_mask;
+    struct io_uring_cqe* completion_entries;
+    struct io_uring_buf_ring* buffer_ring;
+    size_t buffer_ring_size;
+    char* buffers;
+    unsigned buffer_count;
+    unsigned buffer_size;
+    IoUring(const IoUring&);
+    IoUring& operator=(const IoUring&);
+    void RegisterBuffers();
+    void Release();
+};
+#endif /* IoUring_h */
@@ -0,0 +1,94 @@
+#ifndef LineCounters_h
+#define LineCounters_h
+#include "BasicGame.h"
+#include <cstdint>
+
+/* -------------------------------------------------------------------------------------
+ * STRUCT NAME: SpotLines
+ * -------------------------------------------------------------------------------------
+ * @brief For every spot of a board, the winning lines that run through it, generated
+ *        at compile time from LineGeometry.
+ *
+ * A spot lies on at most WIN_LENGTH lines in each of the 4 directions, whatever the
+ * size of the board.
+ * -------------------------------------------------------------------------------------
+ */
+template <int ROWS, int COLUMNS, int WIN_LENGTH>
+struct SpotLines {
+  typedef LineGeometry<ROWS, COLUMNS, WIN_LENGTH> Geometry;
+
+  static constexpr int SPOT_COUNT       = ROWS * COLUMNS;
+  static constexpr int MAXIMUM_PER_SPOT = 4 * WIN_LENGTH;
+
+  struct Table {
+    uint16_t lines[SPOT_COUNT][MAXIMUM_PER_SPOT];
+    uint8_t line_count[SPOT_COUNT];
+  };
+
+  static constexpr Table Generate() {
+    Table table = {};
+    for (int line = 0; line < Geometry::LINE_COUNT; ++line) {
+      for (int index = 0; index < WIN_LENGTH; ++index) {
+        int spot = Geometry::TABLE.first_spot[line] + index * Geometry::TABLE.step[line];
+        table.lines[spot][table.line_count[spot]++] = static_cast<uint16_t>(line);
+      }
+    }
+    return table;
+  }
+
+  static constexpr Table TABLE = Generate();
+};
+
+template <int ROWS, int COLUMNS, int WIN_LENGTH>
+constexpr typename SpotLines<ROWS, COLUMNS, WIN_LENGTH>::Table SpotLines<ROWS, COLUMNS, WIN_LENGTH>::TABLE;
+
+/* -------------------------------------------------------------------------------------
+ * CLASS NAME: LineCounters
+ * -------------------------------------------------------------------------------------
+ * @brief Counts, for each player, how many spots of every winning line they hold.
+ *
+ * Placing a letter only adds one to the counters of the lines through its spot, and a
+ * line is won the moment its counter reaches WIN_LENGTH. Updating a move costs at most
+ * 4 * WIN_LENGTH counters and asking for the winner is a single load, independent of
+ * the size of the board. This is the incremental win detection of the searches, which
+ * place and take back moves along every line they look at.
+ *
+ * @note Sides are 0 for X and 1 for O.
+ * -------------------------------------------------------------------------------------
+ */
+template <int ROWS, int COLUMNS, int WIN_LENGTH>
+class LineCounters {
+  public:
+    typedef SpotLines<ROWS, COLUMNS, WIN_LENGTH> Lines;
+
+    LineCounters() : counts(), winners(0) {}
+
+    /* Records that a side took a spot; returns true if that completes one of its lines. */
+    bool InsertMove(const int spot, const int side) {
+      const uint16_t* lines = Lines::TABLE.lines[spot];
+      uint8_t* side_counts  = counts[side];
+      bool is_winner = false;
+      for (int index = 0; index < Lines::TABLE.line_count[spot]; ++index) {
+        is_winner |= ++side_counts[lines[index]] == WIN_LENGTH;
+      }
+      winners |= static_cast<uint8_t>(is_winner << side);
+      return is_winner;
+    }
+
+    /* Takes back a side's move on a spot; the side no longer has a completed line. */
+    void RemoveMove(const int spot, const int side) {
+      const uint16_t* lines = Lines::TABLE.lines[spot];
+      for (int index = 0; index < Lines::TABLE.line_count[spot]; ++index) {
+        --counts[side][lines[index]];
+      }
+      winners &= static_cast<uint8_t>(~(1u << side));
+    }
+
+    bool IsWinner(const int side) const { return (winners >> side) & 1u; }
+    int Count(const int side, const int line) const { return counts[side][line]; }
+
+  private:
+    uint8_t counts[2][Lines::Geometry::LINE_COUNT];
+    uint8_t winners;  // Bit 0 once X has completed a line, bit 1 once O has.
+};
+#endif /* LineCounters_h */
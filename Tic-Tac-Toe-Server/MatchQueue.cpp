@@ -0,0 +1,119 @@
+#include "MatchQueue.h"
+#include <algorithm>
+
+MatchQueue::MatchQueue(std::chrono::milliseconds bot_wait) : bot_wait(bot_wait) {
+  ResetMetrics(Clock::now());
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Join
+ * ------------------------------------------------------------------------------------
+ * @brief Pairs a client with the client that has waited longest, or queues it.
+ *
+ * @param socket          The joining client's socket.
+ * @param now             The time the client joins.
+ * @param opponent_socket Receives the socket of the waiting client it is paired with.
+ *
+ * @return True if the client was paired, false if it now waits in the queue.
+ * ------------------------------------------------------------------------------------
+ */
+bool MatchQueue::Join(int socket, Clock::time_point now, int& opponent_socket) {
+  if (waiting.empty()) {
+    Waiting client = { socket, now };
+    waiting.push_back(client);
+    return false;
+  }
+  opponent_socket = waiting.front().socket;
+  CountWait(now - waiting.front().joined);
+  CountWait(Clock::duration::zero());
+  waiting.pop_front();
+  ++pair_count;
+  
+  return true;
+}
+
+/* Takes a client that disconnected out of the queue. */
+void MatchQueue::Leave(int socket) {
+  for (auto client = waiting.begin(); client != waiting.end(); ++client) {
+    if (client->socket == socket) {
+      waiting.erase(client);
+      return;
+    }
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: PopExpired
+ * ------------------------------------------------------------------------------------
+ * @brief Takes the oldest client out of the queue if it has waited the bot wait.
+ *
+ * @return True, with its socket, if a client is to play the house player.
+ * ------------------------------------------------------------------------------------
+ */
+bool MatchQueue::PopExpired(Clock::time_point now, int& socket) {
+  if (waiting.empty() || now - waiting.front().joined < bot_wait) {
+    return false;
+  }
+  socket = waiting.front().socket;
+  CountWait(now - waiting.front().joined);
+  waiting.pop_front();
+  ++pair_count;
+  ++bot_pair_count;
+  
+  return true;
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: MillisecondsToExpiry
+ * ------------------------------------------------------------------------------------
+ * @brief The time until the oldest client is due a house player, rounded up, as an
+ *        epoll_wait timeout.
+ *
+ * @return The milliseconds to wait, or -1 when the queue is empty.
+ * ------------------------------------------------------------------------------------
+ */
+int MatchQueue::MillisecondsToExpiry(Clock::time_point now) const {
+  if (waiting.empty()) {
+    return -1;
+  }
+  Clock::duration left = waiting.front().joined + bot_wait - now;
+  if (left <= Clock::duration::zero()) {
+    return 0;
+  }
+  return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(left).count()) + 1;
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: GetMetrics
+ * ------------------------------------------------------------------------------------
+ * @brief Sums up the pairs made, and the waits for them, since the last reset.
+ * ------------------------------------------------------------------------------------
+ */
+MatchQueue::Metrics MatchQueue::GetMetrics(Clock::time_point now) const {
+  typedef std::chrono::duration<double, std::milli> Milliseconds;
+  Metrics metrics;
+  const double seconds = std::chrono::duration<double>(now - metrics_start).count();
+  metrics.seconds                   = seconds;
+  metrics.pair_count                = pair_count;
+  metrics.bot_pair_count            = bot_pair_count;
+  metrics.pairs_per_second          = seconds > 0 ? pair_count / seconds : 0.0;
+  metrics.mean_wait_milliseconds    = wait_count > 0 ? Milliseconds(total_wait).count() / wait_count : 0.0;
+  metrics.longest_wait_milliseconds = Milliseconds(longest_wait).count();
+  
+  return metrics;
+}
+
+void MatchQueue::ResetMetrics(Clock::time_point now) {
+  pair_count     = 0;
+  bot_pair_count = 0;
+  wait_count     = 0;
+  total_wait     = Clock::duration::zero();
+  longest_wait   = Clock::duration::zero();
+  metrics_start  = now;
+}
+
+void MatchQueue::CountWait(Clock::duration wait) {
+  ++wait_count;
+  total_wait  += wait;
+  longest_wait = std::max(longest_wait, wait);
+}
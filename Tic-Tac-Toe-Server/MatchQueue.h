@@ -0,0 +1,63 @@
+#ifndef MatchQueue_h
+#define MatchQueue_h
+#include <chrono>
+#include <cstdint>
+#include <deque>
+
+/* -------------------------------------------------------------------------------------
+ * CLASS NAME: MatchQueue
+ * -------------------------------------------------------------------------------------
+ * @brief Pairs the clients of one shard into games, oldest first.
+ *
+ * A client joins the queue once its hello is received. If another client is waiting,
+ * the two are paired at once: the one that waited plays X and moves first. A client
+ * nobody joins within the bot wait is popped by PopExpired and plays the house player,
+ * so no client ever waits longer than that for its game to start.
+ *
+ * The queue belongs to one shard's event loop and is only touched by its thread, so it
+ * needs no lock. Clients of different shards are not paired with each other.
+ *
+ * The queue counts the pairs it makes and how long clients waited for them; see
+ * GetMetrics.
+ * -------------------------------------------------------------------------------------
+ */
+class MatchQueue {
+  public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Metrics {
+      uint64_t pair_count;      // Games started, against a client or the house player.
+      uint64_t bot_pair_count;  // Games started against the house player.
+      double seconds;           // Since the metrics were last reset.
+      double pairs_per_second;
+      double mean_wait_milliseconds;
+      double longest_wait_milliseconds;
+    };
+
+    explicit MatchQueue(std::chrono::milliseconds bot_wait);
+    bool Join(int socket, Clock::time_point now, int& opponent_socket);
+    void Leave(int socket);
+    bool PopExpired(Clock::time_point now, int& socket);
+    int MillisecondsToExpiry(Clock::time_point now) const;
+    bool IsEmpty() const { return waiting.empty(); }
+    Metrics GetMetrics(Clock::time_point now) const;
+    void ResetMetrics(Clock::time_point now);
+
+  private:
+    struct Waiting {
+      int socket;
+      Clock::time_point joined;
+    };
+
+    std::deque<Waiting> waiting;
+    std::chrono::milliseconds bot_wait;
+    uint64_t pair_count;
+    uint64_t bot_pair_count;
+    uint64_t wait_count;
+    Clock::duration total_wait;
+    Clock::duration longest_wait;
+    Clock::time_point metrics_start;
+
+    void CountWait(Clock::duration wait);
+};
+#endif /* MatchQueue_h */
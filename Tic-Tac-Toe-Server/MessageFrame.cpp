@@ -0,0 +1,70 @@
+#include "MessageFrame.h"
+#include <stdexcept>
+
+namespace MessageFrame {
+  /* ------------------------------------------------------------------------------------
+   * FUNCTION NAME: AppendFrame
+   * ------------------------------------------------------------------------------------
+   * @brief Appends a payload, preceded by its length header, to a send buffer.
+   *
+   * @param buffer       [out] The buffer the frame is appended to.
+   * @param payload      [in]  The bytes of the message.
+   * @param payload_size [in]  The number of bytes of the message.
+   *
+   * @throws std::runtime_error if the payload is larger than MAXIMUM_PAYLOAD_SIZE.
+   * ------------------------------------------------------------------------------------
+   */
+  void AppendFrame(std::string& buffer, const char* payload, size_t payload_size) {
+    if (payload_size > MAXIMUM_PAYLOAD_SIZE) {
+      throw std::runtime_error("Error! Message is too large to be framed.");
+    }
+    char header[HEADER_SIZE];
+    header[0] = static_cast<char>((payload_size >> 24) & 0xff);
+    header[1] = static_cast<char>((payload_size >> 16) & 0xff);
+    header[2] = static_cast<char>((payload_size >> 8) & 0xff);
+    header[3] = static_cast<char>(payload_size & 0xff);
+    buffer.append(header, HEADER_SIZE);
+    buffer.append(payload, payload_size);
+  }
+  
+  /* ------------------------------------------------------------------------------------
+   * FUNCTION NAME: NextFrame
+   * ------------------------------------------------------------------------------------
+   * @brief Finds the next complete frame in a reassembly buffer.
+   *
+   * @details Frames are read in place: payload points into the buffer, and offset is
+   *          moved past the frame. The caller erases the consumed bytes once it has
+   *          handled every complete frame, so a burst of pipelined messages costs a
+   *          single erase.
+   *
+   * @param buffer       [in]     The reassembly buffer.
+   * @param offset       [in,out] Where the next frame starts; moved past the frame.
+   * @param payload      [out]    The start of the frame's payload.
+   * @param payload_size [out]    The number of bytes of the frame's payload.
+   *
+   * @throws std::runtime_error if the header announces a payload larger than
+   *                            MAXIMUM_PAYLOAD_SIZE.
+   *
+   * @return True if a complete frame was found, false if more bytes are needed.
+   * ------------------------------------------------------------------------------------
+   */
+  bool NextFrame(const std::string& buffer, size_t& offset, const char*& payload, size_t& payload_size) {
+    if (buffer.size() - offset < HEADER_SIZE) {
+      return false;
+    }
+    const unsigned char* header = reinterpret_cast<const unsigned char*>(buffer.data() + offset);
+    uint32_t frame_size = (static_cast<uint32_t>(header[0]) << 24) | (static_cast<uint32_t>(header[1]) << 16) |
+                          (static_cast<uint32_t>(header[2]) << 8)  |  static_cast<uint32_t>(header[3]);
+    if (frame_size > MAXIMUM_PAYLOAD_SIZE) {
+      throw std::runtime_error("Error! Received message is too large.");
+    }
+    if (buffer.size() - offset - HEADER_SIZE < frame_size) {
+      return false;
+    }
+    payload      = buffer.data() + offset + HEADER_SIZE;
+    payload_size = frame_size;
+    offset      += HEADER_SIZE + frame_size;
+    
+    return true;
+  }
+}
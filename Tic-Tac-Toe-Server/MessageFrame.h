@@ -0,0 +1,27 @@
+#ifndef MessageFrame_h
+#define MessageFrame_h
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/* -------------------------------------------------------------------------------------
+ * NAMESPACE NAME: MessageFrame
+ * -------------------------------------------------------------------------------------
+ * @brief Length-prefixed framing of the messages exchanged by server and client.
+ *
+ * TCP delivers a stream of bytes, not messages: one recv can return half a message or
+ * several of them. Every message is therefore sent as a frame, a 4-byte big-endian
+ * payload length followed by the payload. The receiver appends whatever recv returns
+ * to a reassembly buffer and takes complete frames out of it with NextFrame.
+ *
+ * @note The server and client keep identical copies of this file.
+ * -------------------------------------------------------------------------------------
+ */
+namespace MessageFrame {
+  const size_t HEADER_SIZE           = 4;
+  const uint32_t MAXIMUM_PAYLOAD_SIZE = 4096;
+  
+  void AppendFrame(std::string& buffer, const char* payload, size_t payload_size);
+  bool NextFrame(const std::string& buffer, size_t& offset, const char*& payload, size_t& payload_size);
+}
+#endif /* MessageFrame_h */
@@ -0,0 +1,78 @@
+#include "MonteCarloRequestManager.h"
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+namespace Request_Manager {
+  MonteCarloRequestManager::MonteCarloRequestManager(std::chrono::milliseconds time_budget, int thread_count)
+      : search(time_budget, thread_count) {}
+  
+  /* ----------------------------------------------------------------------
+   * FUNCTION NAME: GetMove
+   * ----------------------------------------------------------------------
+   * @brief Searches for the best spot for the player to move.
+   *
+   * @param game    [in] The game the move is made on.
+   * @param letter  [in] The player's symbol ('X' or 'O').
+   *
+   * @details Prints how many playouts the search ran, and how many per
+   *          second, for every move it searches.
+   *
+   * @return Returns the row and column number of the most visited spot,
+   *         or row and column 0 if the game is over.
+   * ----------------------------------------------------------------------
+   */
+  Player MonteCarloRequestManager::GetMove(const Game& game, const char letter) {
+    Player player = { 0, 0 };
+    MonteCarloSearch<Game>::Result result = search.Search(game, letter);
+    if (result.spot < 0) {
+      return player;
+    }
+    player.row    = result.spot / Game::BOARD_COLUMNS + 1;
+    player.column = result.spot % Game::BOARD_COLUMNS + 1;
+    if (result.playouts > 0) {
+      std::cout << "Monte Carlo move " << player.row << ", " << player.column << " after " << result.playouts
+                << " playouts (" << static_cast<uint64_t>(result.playouts_per_second) << " playouts/s)"
+                << std::endl;
+    }
+    
+    return player;
+  }
+  
+  /* ----------------------------------------------------------------------
+   * FUNCTION NAME: RunBenchmark
+   * ----------------------------------------------------------------------
+   * @brief Prints how many playouts per second the Monte Carlo tree search
+   *        runs on a 15x15 Gomoku board, on 1, 2, 4, ... threads up to one
+   *        per core.
+   *
+   * @details Every thread count gets the best of several searches of
+   *          time_budget from the same opening, two moves in, where the
+   *          search has many moves to weigh and none it can prove.
+   *
+   * @param time_budget [in] The time each search is given.
+   * ----------------------------------------------------------------------
+   */
+  void MonteCarloRequestManager::RunBenchmark(std::chrono::milliseconds time_budget) {
+    const int round_count = 3;
+    const int core_count  = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    GomokuGame game;
+    game.InsertMove(8, 8, 'X');
+    game.InsertMove(8, 9, 'O');
+    std::cout << "Monte Carlo tree search on a " << GomokuGame::BOARD_ROWS << "x" << GomokuGame::BOARD_COLUMNS
+              << " Gomoku board, " << time_budget.count() << " ms per search:" << std::endl;
+    for (int thread_count = 1; ; thread_count = std::min(thread_count * 2, core_count)) {
+      MonteCarloSearch<GomokuGame> gomoku_search(time_budget, thread_count);
+      double best_playouts_per_second = 0;
+      for (int round = 0; round < round_count; ++round) {
+        best_playouts_per_second = std::max(best_playouts_per_second,
+                                            gomoku_search.Search(game, 'X').playouts_per_second);
+      }
+      std::cout << "  " << thread_count << (thread_count == 1 ? " thread:  " : " threads: ")
+                << static_cast<uint64_t>(best_playouts_per_second) << " playouts/s" << std::endl;
+      if (thread_count == core_count) {
+        break;
+      }
+    }
+  }
+}
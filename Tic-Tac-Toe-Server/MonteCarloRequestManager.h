@@ -0,0 +1,29 @@
+#ifndef MonteCarloRequestManager_h
+#define MonteCarloRequestManager_h
+#include "IRequestManager.h"
+#include "MonteCarloSearch.h"
+
+namespace Request_Manager {
+/* ------------------------------------------------------------------
+ * CLASS NAME: MonteCarloRequestManager
+ * ------------------------------------------------------------------
+ * @brief Plays the server's side of a game by Monte Carlo tree search.
+ *
+ * The MonteCarloRequestManager class implements the IRequestManager
+ * interface with a MonteCarloSearch of the game on a number of
+ * threads, spending a fixed time on every move. The engine itself
+ * works on any board variant of BasicGame; this is its player for the
+ * server's board.
+ * ------------------------------------------------------------------
+ */
+  class MonteCarloRequestManager : public IRequestManager {
+    public:
+      MonteCarloRequestManager(std::chrono::milliseconds time_budget, int thread_count);
+      Player GetMove(const Game& game, const char letter);
+      static void RunBenchmark(std::chrono::milliseconds time_budget);
+    
+    private:
+      MonteCarloSearch<Game> search;
+  };
+}
+#endif /* MonteCarloRequestManager_h */
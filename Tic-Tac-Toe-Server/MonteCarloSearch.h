@@ -0,0 +1,540 @@
+#ifndef MonteCarloSearch_h
+#define MonteCarloSearch_h
+#include "LineCounters.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* -------------------------------------------------------------------------------------
+ * CLASS NAME: MonteCarloSearch
+ * -------------------------------------------------------------------------------------
+ * @brief Finds a move on any board variant of BasicGame by Monte Carlo tree search,
+ *        run on many threads for at most a fixed time.
+ *
+ * Each thread repeatedly walks down a search tree by UCT, adds the next level of moves
+ * below the position it reaches, finishes the game from there with random moves (a
+ * playout) and credits the result to every position on its way back up. The move
+ * played is the one visited most.
+ *
+ * The threads share the work two ways. Threads on the same tree (tree parallelism)
+ * count a virtual loss on every position they walk through until their playout is
+ * credited, which steers the other threads away from the same line. A position's
+ * moves are added by whichever thread claims it first with one compare-and-swap;
+ * the others play out from it in the meantime, so nothing is ever locked. With more
+ * than one tree (root parallelism), the threads are split between independent trees
+ * whose root visits are added up at the end.
+ *
+ * The search also proves what it can: a move that wins or fills the board is proven a
+ * win or a draw, and a position is proven once one move from it is a proven win or
+ * every move from it is proven. A walk that reaches a proven position takes its result
+ * instead of playing out, and the search stops as soon as the root is proven, so a
+ * decided position is not searched for the whole time budget. A root with one move
+ * is not searched at all.
+ *
+ * The threads are started once, with the search, and wait for the next move between
+ * searches. Every thread takes the positions it adds from its own arena and plays out
+ * on its own scratch board, both allocated on its first search and reused after, so
+ * the threads share nothing but the tree's counters. Searches run one at a time.
+ *
+ * On boards of more than 64 spots only the empty spots next to a taken spot are added
+ * to the tree; playouts may take any spot.
+ * -------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+class MonteCarloSearch {
+  public:
+    static constexpr int SPOT_COUNT = GameType::SPOT_COUNT;
+
+    struct Result {
+      int spot;                   // -1 when the game is over.
+      uint64_t playouts;
+      double playouts_per_second;
+    };
+
+    MonteCarloSearch(std::chrono::milliseconds time_budget, int thread_count = 0, int tree_count = 1,
+                     int arena_size = 1 << 18);
+    ~MonteCarloSearch();
+    Result Search(const GameType& game, const char letter) const;
+
+  private:
+    typedef LineCounters<GameType::BOARD_ROWS, GameType::BOARD_COLUMNS, GameType::BOARD_WIN_LENGTH> Counters;
+    typedef std::chrono::steady_clock Clock;
+
+    static constexpr int COLUMNS          = GameType::BOARD_COLUMNS;
+    static constexpr bool NEIGHBOURS_ONLY = SPOT_COUNT > 64;
+    static constexpr int VIRTUAL_LOSS     = 1;
+    static constexpr int EXPAND_VISITS    = 2;     // Visits before a position's moves are added.
+    static constexpr int CLOCK_INTERVAL   = 16;    // Playouts between looks at the clock.
+    static constexpr int DRAW             = 2;     // A game's outcome: 0 or 1 for the winning side.
+
+    enum Expansion : uint8_t { UNEXPANDED, EXPANDING, EXPANDED };
+
+    /* What a position is proven to be worth, for the side that moved into it. */
+    enum Proof : uint8_t { UNPROVEN, PROVEN_WIN, PROVEN_DRAW, PROVEN_LOSS };
+
+    /* A position in the tree, reached by a move. Scores are in half points for the side that moved. */
+    struct Node {
+      std::atomic<int> visits;
+      std::atomic<int> score;
+      std::atomic<uint8_t> expansion;
+      std::atomic<uint8_t> proof;
+      int spot;
+      int child_count;  // Written before expansion turns EXPANDED.
+      Node* children;
+    };
+
+    /* The board of one walk and playout. */
+    struct Board {
+      GameType game;
+      Counters counters;
+      int empty_count;
+      int empties[SPOT_COUNT];
+      int where[SPOT_COUNT];  // The index of a spot in empties.
+    };
+
+    /* The nodes one thread may add to a tree. */
+    struct Arena {
+      std::unique_ptr<Node[]> nodes;
+      int size;
+      int used;
+    };
+
+    /* What one thread keeps from one search to the next. */
+    struct Workspace {
+      Arena arena;
+      std::unique_ptr<Board> board;
+      std::vector<Node*> path;
+    };
+
+    /* The search the threads are woken for. */
+    struct Job {
+      Node* roots;
+      const Board* start;
+      int side;
+      Clock::time_point deadline;
+      uint64_t seed;
+    };
+
+    std::chrono::milliseconds time_budget;
+    int thread_count;
+    int tree_count;
+    int arena_size;
+    mutable std::mutex search_lock;  // Held for a whole search.
+    mutable std::unique_ptr<Board> start;
+    mutable std::vector<Arena> root_arenas;
+    mutable std::unique_ptr<Node[]> roots;
+    mutable std::vector<Workspace> workspaces;  // One per thread; the searching thread's is the first.
+    mutable std::atomic<uint64_t> playouts;
+    mutable std::atomic<bool> is_decided;
+    mutable std::mutex pool_lock;
+    mutable std::condition_variable job_ready;
+    mutable std::condition_variable job_done;
+    mutable Job job;
+    mutable uint64_t job_number;
+    mutable int running_count;  // Threads still on the current job.
+    bool is_stopping;
+    std::vector<std::thread> threads;
+
+    void Work(int thread_index) const;
+    void Run(Node* root, const Board& start, int side, Clock::time_point deadline, uint64_t seed,
+             Workspace& workspace) const;
+    void Expand(Node* node, const Board& board, Arena& arena) const;
+    static bool ProveParent(Node* parent, const Node* child);
+    static Node* Select(Node* node);
+    static int Playout(Board& board, int side, uint64_t& random);
+    static bool Play(Board& board, int spot, int side);
+    static void Reset(Node& node, int spot);
+    static uint64_t Next(uint64_t& random);
+};
+
+/* ------------------------------------------------------------------------------------
+ * CONSTRUCTOR NAME: MonteCarloSearch
+ * ------------------------------------------------------------------------------------
+ * @param time_budget  The time to spend on every move.
+ * @param thread_count The number of threads to search with, 0 for one per core.
+ * @param tree_count   The number of independent trees the threads are split between.
+ * @param arena_size   The number of positions each thread may add to a tree.
+ *
+ * @note Starts every thread but the searching one, to wait for the first search.
+ * ------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+MonteCarloSearch<GameType>::MonteCarloSearch(std::chrono::milliseconds time_budget, int thread_count,
+                                             int tree_count, int arena_size)
+    : time_budget(time_budget), thread_count(thread_count), tree_count(tree_count), arena_size(arena_size),
+      start(new Board()), playouts(0), is_decided(false), job(), job_number(0), running_count(0),
+      is_stopping(false) {
+  if (this->thread_count <= 0) {
+    this->thread_count = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+  }
+  this->tree_count = std::min(std::max(tree_count, 1), this->thread_count);
+  root_arenas.resize(this->tree_count);
+  for (Arena& root_arena : root_arenas) {
+    root_arena.nodes.reset(new Node[SPOT_COUNT]);
+    root_arena.size = SPOT_COUNT;
+  }
+  roots.reset(new Node[this->tree_count]);
+  workspaces.resize(this->thread_count);
+  for (int thread_index = 1; thread_index < this->thread_count; ++thread_index) {
+    threads.emplace_back(&MonteCarloSearch::Work, this, thread_index);
+  }
+}
+
+/* Stops the threads once they are done with the search they are on. */
+template <typename GameType>
+MonteCarloSearch<GameType>::~MonteCarloSearch() {
+  {
+    std::lock_guard<std::mutex> guard(pool_lock);
+    is_stopping = true;
+  }
+  job_ready.notify_all();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Search
+ * ------------------------------------------------------------------------------------
+ * @brief Searches the position for the side playing letter until the time budget is
+ *        spent or the position is proven.
+ *
+ * @return A proven win if there is one, else the most visited move that is not a proven
+ *         loss, and how many playouts were run to find it.
+ * ------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+typename MonteCarloSearch<GameType>::Result MonteCarloSearch<GameType>::Search(const GameType& game,
+                                                                               const char letter) const {
+  std::lock_guard<std::mutex> search_guard(search_lock);
+  const Clock::time_point start_time = Clock::now();
+  Result result = { -1, 0, 0.0 };
+  start->counters    = Counters();
+  start->game        = game;
+  start->empty_count = 0;
+  for (int spot = 0; spot < SPOT_COUNT; ++spot) {
+    if (GameType::Masks::Test(game.GetMask('X'), spot)) {
+      start->counters.InsertMove(spot, 0);
+    } else if (GameType::Masks::Test(game.GetMask('O'), spot)) {
+      start->counters.InsertMove(spot, 1);
+    } else {
+      start->where[spot] = start->empty_count;
+      start->empties[start->empty_count++] = spot;
+    }
+  }
+  if (start->counters.IsWinner(0) || start->counters.IsWinner(1) || start->empty_count == 0) {
+    return result;
+  }
+  // The roots are expanded up front, so every tree lists the same moves in the same order.
+  const int side = letter == 'X' ? 0 : 1;
+  for (int tree = 0; tree < tree_count; ++tree) {
+    root_arenas[tree].used = 0;
+    Reset(roots[tree], -1);
+    Expand(&roots[tree], *start, root_arenas[tree]);
+  }
+  if (roots[0].child_count == 1) {
+    result.spot = roots[0].children[0].spot;
+    return result;
+  }
+  playouts.store(0);
+  is_decided.store(false);
+  const Clock::time_point deadline = start_time + time_budget;
+  const uint64_t seed = static_cast<uint64_t>(start_time.time_since_epoch().count());
+  {
+    std::lock_guard<std::mutex> guard(pool_lock);
+    job.roots     = roots.get();
+    job.start     = start.get();
+    job.side      = side;
+    job.deadline  = deadline;
+    job.seed      = seed;
+    running_count = thread_count - 1;
+    ++job_number;
+  }
+  job_ready.notify_all();
+  Run(&roots[0], *start, side, deadline, seed, workspaces[0]);
+  {
+    std::unique_lock<std::mutex> guard(pool_lock);
+    job_done.wait(guard, [this] { return running_count == 0; });
+  }
+  // Proven wins first and proven losses last; a move proven in one tree is proven in all of them.
+  int best_rank   = -1;
+  int most_visits = -1;
+  for (int child = 0; child < roots[0].child_count; ++child) {
+    int visits    = 0;
+    uint8_t proof = UNPROVEN;
+    for (int tree = 0; tree < tree_count; ++tree) {
+      visits += roots[tree].children[child].visits.load(std::memory_order_relaxed);
+      if (proof == UNPROVEN) {
+        proof = roots[tree].children[child].proof.load(std::memory_order_relaxed);
+      }
+    }
+    const int rank = proof == PROVEN_WIN ? 2 : proof == PROVEN_LOSS ? 0 : 1;
+    if (rank > best_rank || (rank == best_rank && visits > most_visits)) {
+      best_rank   = rank;
+      most_visits = visits;
+      result.spot = roots[0].children[child].spot;
+    }
+  }
+  const double seconds = std::chrono::duration<double>(Clock::now() - start_time).count();
+  result.playouts            = playouts.load();
+  result.playouts_per_second = seconds > 0 ? result.playouts / seconds : 0.0;
+  
+  return result;
+}
+
+/* A started thread: runs every search Search hands out until the search is destroyed. */
+template <typename GameType>
+void MonteCarloSearch<GameType>::Work(int thread_index) const {
+  uint64_t done_number = 0;
+  std::unique_lock<std::mutex> guard(pool_lock);
+  while (true) {
+    job_ready.wait(guard, [&] { return is_stopping || job_number != done_number; });
+    if (is_stopping) {
+      return;
+    }
+    done_number = job_number;
+    const Job current = job;
+    guard.unlock();
+    Run(&current.roots[thread_index % tree_count], *current.start, current.side, current.deadline,
+        current.seed + thread_index, workspaces[thread_index]);
+    guard.lock();
+    if (--running_count == 0) {
+      job_done.notify_one();
+    }
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Run
+ * ------------------------------------------------------------------------------------
+ * @brief One thread's search: walk, expand, play out and credit, until the deadline or
+ *        until any tree's root is proven.
+ * ------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+void MonteCarloSearch<GameType>::Run(Node* root, const Board& start, int side, Clock::time_point deadline,
+                                     uint64_t seed, Workspace& workspace) const {
+  // The arena is allocated by the thread that fills it, but outlives its searches: other threads walk its nodes.
+  Arena& arena = workspace.arena;
+  if (!arena.nodes) {
+    arena.nodes.reset(new Node[arena_size]);
+    arena.size = arena_size;
+    workspace.board.reset(new Board());
+    workspace.path.resize(SPOT_COUNT + 1);
+  }
+  arena.used = 0;
+  Board* board             = workspace.board.get();
+  std::vector<Node*>& path = workspace.path;
+  path[0] = root;
+  uint64_t random = seed * 0x9e3779b97f4a7c15ull | 1;
+  uint64_t count  = 0;
+  do {
+    for (int batch = 0; batch < CLOCK_INTERVAL; ++batch) {
+      *board = start;
+      Node* node  = root;
+      int mover   = side;
+      int depth   = 0;
+      int outcome = -1;
+      while (true) {
+        // The node's proof is for the side that moved into it, the one not to move now.
+        const uint8_t proof = node->proof.load(std::memory_order_acquire);
+        if (proof != UNPROVEN) {
+          outcome = proof == PROVEN_DRAW ? DRAW : proof == PROVEN_WIN ? 1 - mover : mover;
+          break;
+        }
+        if (board->empty_count == 0) {
+          outcome = DRAW;
+          node->proof.store(PROVEN_DRAW, std::memory_order_release);
+          break;
+        }
+        uint8_t expansion  = node->expansion.load(std::memory_order_acquire);
+        uint8_t unexpanded = UNEXPANDED;
+        if (expansion == UNEXPANDED && node->visits.load(std::memory_order_relaxed) >= EXPAND_VISITS &&
+            node->expansion.compare_exchange_strong(unexpanded, EXPANDING, std::memory_order_acquire)) {
+          Expand(node, *board, arena);
+          expansion = EXPANDED;
+        }
+        if (expansion != EXPANDED || node->child_count == 0) {
+          break;  // A new position, one another thread is expanding, or an arena out of room.
+        }
+        node = Select(node);
+        node->visits.fetch_add(VIRTUAL_LOSS, std::memory_order_relaxed);
+        path[++depth] = node;
+        if (Play(*board, node->spot, mover)) {
+          outcome = mover;
+          node->proof.store(PROVEN_WIN, std::memory_order_release);
+          break;
+        }
+        mover = 1 - mover;
+      }
+      if (outcome < 0) {
+        outcome = Playout(*board, mover, random);
+      }
+      // The node at an odd depth was reached by a move of the side searching.
+      for (int index = depth; index > 0; --index) {
+        const int moved = index % 2 == 1 ? side : 1 - side;
+        path[index]->visits.fetch_add(1 - VIRTUAL_LOSS, std::memory_order_relaxed);
+        path[index]->score.fetch_add(outcome == DRAW ? 1 : outcome == moved ? 2 : 0, std::memory_order_relaxed);
+      }
+      root->visits.fetch_add(1, std::memory_order_relaxed);
+      for (int index = depth; index > 0 && path[index]->proof.load(std::memory_order_acquire) != UNPROVEN; --index) {
+        if (!ProveParent(path[index - 1], path[index])) {
+          break;
+        }
+      }
+      ++count;
+    }
+    if (root->proof.load(std::memory_order_relaxed) != UNPROVEN) {
+      is_decided.store(true, std::memory_order_relaxed);
+    }
+  } while (!is_decided.load(std::memory_order_relaxed) && Clock::now() < deadline);
+  playouts.fetch_add(count);
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Expand
+ * ------------------------------------------------------------------------------------
+ * @brief Adds a position's moves below it, from the arena, and publishes them.
+ *
+ * @details The calling thread owns the node's EXPANDING state. When the arena is out
+ *          of room, the position is published with no moves and stays a leaf.
+ * ------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+void MonteCarloSearch<GameType>::Expand(Node* node, const Board& board, Arena& arena) const {
+  Node* children  = arena.nodes.get() + arena.used;
+  int child_count = 0;
+  for (int index = 0; index < board.empty_count; ++index) {
+    const int spot = board.empties[index];
+    if (NEIGHBOURS_ONLY && board.empty_count < SPOT_COUNT && !board.game.IsNextToTakenSpot(spot)) {
+      continue;
+    }
+    if (NEIGHBOURS_ONLY && board.empty_count == SPOT_COUNT && spot != SPOT_COUNT / 2) {
+      continue;  // The first move on a large board goes in the middle.
+    }
+    if (arena.used + child_count == arena.size) {
+      child_count = 0;
+      break;
+    }
+    Reset(children[child_count++], spot);
+  }
+  arena.used        += child_count;
+  node->children    = children;
+  node->child_count = child_count;
+  node->expansion.store(EXPANDED, std::memory_order_release);
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: ProveParent
+ * ------------------------------------------------------------------------------------
+ * @brief Proves the position a proven move was played from, if the move decides it.
+ *
+ * @details A parent is a proven loss for the side that moved into it as soon as one
+ *          move from it is a proven win, and otherwise proven once every move from it
+ *          is: a draw if one of them is a draw, else a win. On boards where only the
+ *          spots next to taken spots are in the tree, the moves from a position are not
+ *          all of them, so only the first rule applies.
+ *
+ * @return True if the parent is proven.
+ * ------------------------------------------------------------------------------------
+ */
+template <typename GameType>
+bool MonteCarloSearch<GameType>::ProveParent(Node* parent, const Node* child) {
+  if (child->proof.load(std::memory_order_acquire) == PROVEN_WIN) {
+    parent->proof.store(PROVEN_LOSS, std::memory_order_release);
+    return true;
+  }
+  if (NEIGHBOURS_ONLY) {
+    return false;
+  }
+  bool is_draw = false;
+  for (int index = 0; index < parent->child_count; ++index) {
+    const uint8_t proof = parent->children[index].proof.load(std::memory_order_acquire);
+    if (proof == UNPROVEN) {
+      return false;
+    }
+    if (proof == PROVEN_WIN) {
+      parent->proof.store(PROVEN_LOSS, std::memory_order_release);
+      return true;
+    }
+    is_draw |= proof == PROVEN_DRAW;
+  }
+  parent->proof.store(is_draw ? PROVEN_DRAW : PROVEN_WIN, std::memory_order_release);
+  return true;
+}
+
+/* Picks the unproven move with the highest UCT value; visits under way count as losses.
+   A proven move has nothing left to learn, and is only picked when every move is proven. */
+template <typename GameType>
+typename MonteCarloSearch<GameType>::Node* MonteCarloSearch<GameType>::Select(Node* node) {
+  const double log_visits = std::log(static_cast<double>(node->visits.load(std::memory_order_relaxed) + 1));
+  Node* best      = node->children;
+  double best_uct = -1.0;
+  for (int index = 0; index < node->child_count; ++index) {
+    Node* child = node->children + index;
+    if (child->proof.load(std::memory_order_relaxed) != UNPROVEN) {
+      continue;
+    }
+    const int visits = child->visits.load(std::memory_order_relaxed);
+    if (visits == 0) {
+      return child;
+    }
+    const double uct = child->score.load(std::memory_order_relaxed) / (2.0 * visits) +
+                       std::sqrt(2.0 * log_visits / visits);
+    if (uct > best_uct) {
+      best_uct = uct;
+      best     = child;
+    }
+  }
+  return best;
+}
+
+/* Finishes the game with random moves; returns the winning side, or DRAW. */
+template <typename GameType>
+int MonteCarloSearch<GameType>::Playout(Board& board, int side, uint64_t& random) {
+  while (board.empty_count > 0) {
+    const int spot = board.empties[Next(random) % static_cast<uint64_t>(board.empty_count)];
+    if (Play(board, spot, side)) {
+      return side;
+    }
+    side = 1 - side;
+  }
+  return DRAW;
+}
+
+/* Takes a spot for a side; returns true if the move wins. */
+template <typename GameType>
+bool MonteCarloSearch<GameType>::Play(Board& board, int spot, int side) {
+  const int last = board.empties[--board.empty_count];
+  board.empties[board.where[spot]] = last;
+  board.where[last]                = board.where[spot];
+  board.game.InsertMove(spot / COLUMNS + 1, spot % COLUMNS + 1, side == 0 ? 'X' : 'O');
+  return board.counters.InsertMove(spot, side);
+}
+
+template <typename GameType>
+void MonteCarloSearch<GameType>::Reset(Node& node, int spot) {
+  node.visits.store(0, std::memory_order_relaxed);
+  node.score.store(0, std::memory_order_relaxed);
+  node.expansion.store(UNEXPANDED, std::memory_order_relaxed);
+  node.proof.store(UNPROVEN, std::memory_order_relaxed);
+  node.spot        = spot;
+  node.child_count = 0;
+  node.children    = nullptr;
+}
+
+/* xorshift64*: a thread's own random numbers, with no shared state. */
+template <typename GameType>
+uint64_t MonteCarloSearch<GameType>::Next(uint64_t& random) {
+  random ^= random >> 12;
+  random ^= random << 25;
+  random ^= random >> 27;
+  return random * 0x2545f4914f6cdd1dull;
+}
+#endif /* MonteCarloSearch_h */
@@ -0,0 +1,369 @@
+#include "MoveLog.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+constexpr size_t MoveLog::RECORD_PAYLOAD_SIZE;
+constexpr size_t MoveLog::RECORD_SIZE;
+constexpr int MoveLog::SYNC_EVERY_COMMIT;
+constexpr int MoveLog::SYNC_NEVER;
+constexpr size_t MoveLog::RING_CAPACITY;
+constexpr int MoveLog::COMMIT_INTERVAL;
+constexpr size_t MoveLog::Reader::CHUNK_SIZE;
+const char MoveLog::FILE_MAGIC[8] = { 'T', 'T', 'T', 'M', 'O', 'V', 'E', '1' };
+
+namespace {
+  void PutBigEndian(char* bytes, uint64_t value, int size) {
+    for (int index = size - 1; index >= 0; --index) {
+      bytes[index] = static_cast<char>(value & 0xff);
+      value >>= 8;
+    }
+  }
+
+  uint64_t GetBigEndian(const char* bytes, int size) {
+    uint64_t value = 0;
+    for (int index = 0; index < size; ++index) {
+      value = (value << 8) | static_cast<uint8_t>(bytes[index]);
+    }
+    return value;
+  }
+}
+
+MoveLog::Writer::Writer(size_t capacity, uint8_t shard, const std::atomic<uint64_t>* committed_size)
+    : ring(new char[capacity]), capacity(capacity), shard(shard), committed_size(committed_size), cached_head(0),
+      stall_count(0), tail(0), head(0) {}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Append
+ * ------------------------------------------------------------------------------------
+ * @brief Copies a record into the shard's ring, for the flusher to commit.
+ *
+ * @details The record is timestamped here, from the vDSO clock, so the move path makes
+ *          no system call. When the ring is full the shard yields until the flusher
+ *          has made room; that only happens when the disk falls behind.
+ * ------------------------------------------------------------------------------------
+ */
+void MoveLog::Writer::Append(Kind kind, uint32_t game_id, char letter, int spot, int move_counter, uint8_t status) {
+  Record record;
+  record.kind             = kind;
+  record.shard            = shard;
+  record.letter           = letter;
+  record.status           = status;
+  record.spot             = static_cast<uint16_t>(spot);
+  record.move_counter     = static_cast<uint16_t>(move_counter);
+  record.game_id          = game_id;
+  record.time_nanoseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::system_clock::now().time_since_epoch()).count());
+  char frame[RECORD_SIZE];
+  EncodeRecord(record, frame);
+
+  const uint64_t position = tail.load(std::memory_order_relaxed);
+  while (position + RECORD_SIZE - cached_head > capacity) {
+    cached_head = head.load(std::memory_order_acquire);
+    if (position + RECORD_SIZE - cached_head > capacity) {
+      ++stall_count;
+      std::this_thread::yield();
+    }
+  }
+  const size_t offset = position & (capacity - 1);
+  const size_t first  = std::min(RECORD_SIZE, capacity - offset);
+  memcpy(ring.get() + offset, frame, first);
+  memcpy(ring.get(), frame + first, RECORD_SIZE - first);
+  tail.store(position + RECORD_SIZE, std::memory_order_release);
+}
+
+/* ------------------------------------------------------------------------------------
+ * CONSTRUCTOR NAME: MoveLog
+ * ------------------------------------------------------------------------------------
+ * @brief Opens the log for appending and starts the flusher.
+ *
+ * @param path              The log file, created with FILE_MAGIC if it does not exist.
+ * @param sync_milliseconds SYNC_EVERY_COMMIT, SYNC_NEVER, or the longest to go between syncs.
+ * @param writer_count      The number of shards, one Writer each.
+ *
+ * @throws std::runtime_error if the log cannot be opened or started.
+ * ------------------------------------------------------------------------------------
+ */
+MoveLog::MoveLog(const std::string& path, int sync_milliseconds, int writer_count)
+    : log_file(-1), sync_milliseconds(sync_milliseconds), committed_size(0), is_stopping(false), is_failed(false) {
+  log_file = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (log_file == -1) {
+    throw std::runtime_error("Error! Opening the move log.");
+  }
+  off_t log_size = lseek(log_file, 0, SEEK_END);
+  if (log_size == 0) {
+    struct iovec magic = { const_cast<char*>(FILE_MAGIC), sizeof(FILE_MAGIC) };
+    if (!WriteAll(&magic, 1)) {
+      close(log_file);
+      throw std::runtime_error("Error! Writing the move log.");
+    }
+    log_size = sizeof(FILE_MAGIC);
+  }
+  committed_size.store(static_cast<uint64_t>(log_size), std::memory_order_release);
+  for (int index = 0; index < writer_count; ++index) {
+    writers.emplace_back(new Writer(RING_CAPACITY, static_cast<uint8_t>(index), &committed_size));
+  }
+  flusher = std::thread(&MoveLog::Flush, this);
+}
+
+/* Commits and syncs whatever the shards have appended, unless the policy is SYNC_NEVER. */
+MoveLog::~MoveLog() {
+  is_stopping.store(true, std::memory_order_release);
+  flusher.join();
+  close(log_file);
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: EncodeRecord
+ * ------------------------------------------------------------------------------------
+ * @brief Writes a record as a RECORD_SIZE frame: the length header, then kind, shard,
+ *        letter and status (1 byte each), spot and move counter (2 bytes each), game
+ *        ID (4 bytes) and time (8 bytes), all big-endian.
+ * ------------------------------------------------------------------------------------
+ */
+void MoveLog::EncodeRecord(const Record& record, char* frame) {
+  PutBigEndian(frame, RECORD_PAYLOAD_SIZE, MessageFrame::HEADER_SIZE);
+  char* payload = frame + MessageFrame::HEADER_SIZE;
+  payload[0] = static_cast<char>(record.kind);
+  payload[1] = static_cast<char>(record.shard);
+  payload[2] = record.letter;
+  payload[3] = static_cast<char>(record.status);
+  PutBigEndian(payload + 4, record.spot, 2);
+  PutBigEndian(payload + 6, record.move_counter, 2);
+  PutBigEndian(payload + 8, record.game_id, 4);
+  PutBigEndian(payload + 12, record.time_nanoseconds, 8);
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: DecodeRecord
+ * ------------------------------------------------------------------------------------
+ * @brief Reads a record back from the payload of its frame.
+ *
+ * @return False if the payload is not a record of a known kind.
+ * ------------------------------------------------------------------------------------
+ */
+bool MoveLog::DecodeRecord(const char* payload, size_t payload_size, Record& record) {
+  const uint8_t kind = static_cast<uint8_t>(payload_size == RECORD_PAYLOAD_SIZE ? payload[0] : 0);
+  if (kind < CREATE || kind > SNAPSHOT) {
+    return false;
+  }
+  record.kind             = static_cast<Kind>(kind);
+  record.shard            = static_cast<uint8_t>(payload[1]);
+  record.letter           = payload[2];
+  record.status           = static_cast<uint8_t>(payload[3]);
+  record.spot             = static_cast<uint16_t>(GetBigEndian(payload + 4, 2));
+  record.move_counter     = static_cast<uint16_t>(GetBigEndian(payload + 6, 2));
+  record.game_id          = static_cast<uint32_t>(GetBigEndian(payload + 8, 4));
+  record.time_nanoseconds = GetBigEndian(payload + 12, 8);
+  return true;
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Flush
+ * ------------------------------------------------------------------------------------
+ * @brief The flusher: commits every COMMIT_INTERVAL, and syncs the file as the policy
+ *        asks, until the log is destroyed.
+ * ------------------------------------------------------------------------------------
+ */
+void MoveLog::Flush() {
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point last_sync = Clock::now();
+  bool is_dirty = false;
+  while (1) {
+    const bool is_last = is_stopping.load(std::memory_order_acquire);
+    is_dirty = Commit() > 0 || is_dirty;
+    if (is_dirty && sync_milliseconds != SYNC_NEVER && !is_failed &&
+        (is_last || sync_milliseconds == SYNC_EVERY_COMMIT ||
+         Clock::now() - last_sync >= std::chrono::milliseconds(sync_milliseconds))) {
+      if (fdatasync(log_file) == -1) {
+        std::cerr << "Error! Syncing the move log." << std::endl;
+      }
+      last_sync = Clock::now();
+      is_dirty  = false;
+    }
+    if (is_last) {
+      return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(COMMIT_INTERVAL));
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Commit
+ * ------------------------------------------------------------------------------------
+ * @brief Writes everything appended to every ring so far with one writev, then hands the
+ *        space back to the shards.
+ *
+ * @details A ring's bytes are written in place, in at most two pieces where they wrap
+ *          around. Records of different shards interleave in the file, each shard's in
+ *          the order they were appended. After a write error the log is reported once
+ *          and records are dropped, so the shards never stall on a broken disk.
+ *
+ * @return The number of bytes committed.
+ * ------------------------------------------------------------------------------------
+ */
+size_t MoveLog::Commit() {
+  std::vector<struct iovec> iovecs;
+  std::vector<uint64_t> tails(writers.size());
+  size_t byte_count = 0;
+  for (size_t index = 0; index < writers.size(); ++index) {
+    Writer& writer       = *writers[index];
+    const uint64_t start = writer.head.load(std::memory_order_relaxed);
+    tails[index]         = writer.tail.load(std::memory_order_acquire);
+    if (tails[index] == start) {
+      continue;
+    }
+    const size_t offset = start & (writer.capacity - 1);
+    const size_t size   = static_cast<size_t>(tails[index] - start);
+    const size_t first  = std::min(size, writer.capacity - offset);
+    iovecs.push_back({ writer.ring.get() + offset, first });
+    if (first < size) {
+      iovecs.push_back({ writer.ring.get(), size - first });
+    }
+    byte_count += size;
+  }
+  if (byte_count == 0) {
+    return 0;
+  }
+  if (!is_failed && !WriteAll(iovecs.data(), static_cast<int>(iovecs.size()))) {
+    std::cerr << "Error! Writing the move log; moves are no longer logged." << std::endl;
+    is_failed = true;
+  }
+  if (!is_failed) {
+    committed_size.store(committed_size.load(std::memory_order_relaxed) + byte_count, std::memory_order_release);
+  }
+  for (size_t index = 0; index < writers.size(); ++index) {
+    writers[index]->head.store(tails[index], std::memory_order_release);
+  }
+  return byte_count;
+}
+
+/* Writes every byte of the iovecs, picking up after a partial write. */
+bool MoveLog::WriteAll(struct iovec* iovecs, int iovec_count) {
+  while (iovec_count > 0) {
+    ssize_t written = writev(log_file, iovecs, std::min(iovec_count, IOV_MAX));
+    if (written == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    while (iovec_count > 0 && static_cast<size_t>(written) >= iovecs->iov_len) {
+      written -= static_cast<ssize_t>(iovecs->iov_len);
+      ++iovecs;
+      --iovec_count;
+    }
+    if (iovec_count > 0) {
+      iovecs->iov_base = static_cast<char*>(iovecs->iov_base) + written;
+      iovecs->iov_len -= static_cast<size_t>(written);
+    }
+  }
+  return true;
+}
+
+/* ------------------------------------------------------------------------------------
+ * CONSTRUCTOR NAME: Reader
+ * ------------------------------------------------------------------------------------
+ * @brief Opens a log for reading from its first record.
+ *
+ * @throws std::runtime_error if the log exists but cannot be opened; a log that does not
+ *                            exist leaves the Reader closed, see IsOpen.
+ * ------------------------------------------------------------------------------------
+ */
+MoveLog::Reader::Reader(const std::string& path)
+    : log_file(-1), path(path), offset(0), size(0), complete_size(0), is_checked(false) {
+  log_file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (log_file == -1 && errno != ENOENT) {
+    throw std::runtime_error("Error! Opening the move log.");
+  }
+}
+
+MoveLog::Reader::~Reader() {
+  if (log_file != -1) {
+    close(log_file);
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Seek
+ * ------------------------------------------------------------------------------------
+ * @brief Skips the log up to position, a record boundary such as a snapshot's log
+ *        offset, so Next starts there. Call before the first Next; a position inside
+ *        FILE_MAGIC reads the log from its first record.
+ *
+ * @throws std::runtime_error if the log cannot be read or does not start with FILE_MAGIC.
+ * ------------------------------------------------------------------------------------
+ */
+void MoveLog::Reader::Seek(uint64_t position) {
+  if (log_file == -1 || position <= sizeof(FILE_MAGIC)) {
+    return;
+  }
+  char magic[sizeof(FILE_MAGIC)];
+  if (pread(log_file, magic, sizeof(magic), 0) != static_cast<ssize_t>(sizeof(magic)) ||
+      memcmp(magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+    throw std::runtime_error("Error! " + path + " is not a move log.");
+  }
+  if (lseek(log_file, static_cast<off_t>(position), SEEK_SET) == -1) {
+    throw std::runtime_error("Error! Reading " + path + ".");
+  }
+  size          = position;
+  complete_size = position;
+  is_checked    = true;
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Next
+ * ------------------------------------------------------------------------------------
+ * @brief Reads the next record. Every record is a RECORD_SIZE frame, so the frames are
+ *        taken straight out of the chunks of CHUNK_SIZE bytes read from the log.
+ *
+ * @throws std::runtime_error if the log cannot be read, does not start with FILE_MAGIC,
+ *                            or holds something other than records.
+ *
+ * @return False at the end of the log, or of its last whole record.
+ * ------------------------------------------------------------------------------------
+ */
+bool MoveLog::Reader::Next(Record& record) {
+  char chunk[CHUNK_SIZE];
+  while (log_file != -1) {
+    if (is_checked && buffer.size() - offset >= RECORD_SIZE) {
+      const char* frame = buffer.data() + offset;
+      if (GetBigEndian(frame, MessageFrame::HEADER_SIZE) != RECORD_PAYLOAD_SIZE ||
+          !DecodeRecord(frame + MessageFrame::HEADER_SIZE, RECORD_PAYLOAD_SIZE, record)) {
+        throw std::runtime_error("Error! " + path + " is corrupt.");
+      }
+      offset        += RECORD_SIZE;
+      complete_size += RECORD_SIZE;
+      return true;
+    }
+    buffer.erase(0, offset);
+    offset = 0;
+    ssize_t bytes_read = read(log_file, chunk, sizeof(chunk));
+    if (bytes_read == -1 && errno == EINTR) {
+      continue;
+    }
+    if (bytes_read == -1) {
+      throw std::runtime_error("Error! Reading " + path + ".");
+    }
+    if (bytes_read == 0) {
+      return false;
+    }
+    buffer.append(chunk, static_cast<size_t>(bytes_read));
+    size += static_cast<uint64_t>(bytes_read);
+    if (!is_checked && buffer.size() >= sizeof(FILE_MAGIC)) {
+      if (memcmp(buffer.data(), FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        throw std::runtime_error("Error! " + path + " is not a move log.");
+      }
+      offset        = sizeof(FILE_MAGIC);
+      complete_size = sizeof(FILE_MAGIC);
+      is_checked    = true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,150 @@
+#ifndef MoveLog_h
+#define MoveLog_h
+#include "MessageFrame.h"
+#include <sys/uio.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* -------------------------------------------------------------------------------------
+ * CLASS NAME: MoveLog
+ * -------------------------------------------------------------------------------------
+ * @brief An append-only binary log of every game the server hosts: its creation, every
+ *        move played on it, and its retirement.
+ *
+ * Each record is framed like a message (see MessageFrame): a 4-byte big-endian length,
+ * then a RECORD_PAYLOAD_SIZE payload of big-endian fields, see EncodeRecord. The file
+ * starts with FILE_MAGIC, and a server started on an existing log appends to it.
+ *
+ * Every shard appends through its own Writer, a single-producer single-consumer ring
+ * of bytes: Append copies the record into the ring and publishes it with one release
+ * store, so logging a move takes no lock and no system call. A background thread
+ * drains every ring about once per COMMIT_INTERVAL into one writev (group commit), and
+ * syncs the file according to the sync policy: after every commit, at most every so
+ * many milliseconds, or never, leaving it to the kernel. A shard whose ring fills up
+ * faster than the disk takes it waits for room, and counts the stall.
+ *
+ * Game IDs are per shard, so every record carries the index of its shard. A shard that
+ * takes a snapshot of its games (see GameSnapshots) appends a SNAPSHOT record at that
+ * moment, so recovery knows which of the shard's records came after the snapshot. The
+ * snapshot also keeps the size the log was committed to when it was taken, a record
+ * boundary before its SNAPSHOT record, for recovery to seek to (see Reader::Seek).
+ * -------------------------------------------------------------------------------------
+ */
+class MoveLog {
+  public:
+    enum Kind : uint8_t {
+      CREATE   = 1,
+      MOVE     = 2,
+      RETIRE   = 3,
+      SNAPSHOT = 4,
+    };
+
+    /* A decoded record. letter, status, spot and move_counter are only set on a MOVE; a
+       SNAPSHOT record carries the sequence of the shard's snapshot in game_id. */
+    struct Record {
+      Kind kind;
+      uint8_t shard;
+      char letter;
+      uint8_t status;            // The StatusCode of the move.
+      uint16_t spot;             // 0-based, as Game::Spot.
+      uint16_t move_counter;
+      uint32_t game_id;
+      uint64_t time_nanoseconds;  // Since the Unix epoch.
+    };
+
+    static constexpr size_t RECORD_PAYLOAD_SIZE = 20;
+    static constexpr size_t RECORD_SIZE         = MessageFrame::HEADER_SIZE + RECORD_PAYLOAD_SIZE;
+    static constexpr int SYNC_EVERY_COMMIT      = 0;
+    static constexpr int SYNC_NEVER             = -1;
+    static const char FILE_MAGIC[8];
+
+    /* ------------------------------------------------------------------------------------
+     * CLASS NAME: Writer
+     * ------------------------------------------------------------------------------------
+     * @brief One shard's ring of records waiting to be committed. Only the shard's thread
+     *        may Append.
+     * ------------------------------------------------------------------------------------
+     */
+    class Writer {
+      public:
+        Writer(size_t capacity, uint8_t shard, const std::atomic<uint64_t>* committed_size);
+        void Append(Kind kind, uint32_t game_id, char letter = 0, int spot = 0, int move_counter = 0,
+                    uint8_t status = 0);
+        uint64_t GetStallCount() const { return stall_count; }
+        uint64_t GetCommittedSize() const { return committed_size->load(std::memory_order_acquire); }
+
+      private:
+        friend class MoveLog;
+
+        std::unique_ptr<char[]> ring;
+        size_t capacity;  // A power of two.
+        uint8_t shard;
+        const std::atomic<uint64_t>* committed_size;  // The log's, see MoveLog::committed_size.
+        uint64_t cached_head;  // The last head the shard read, so it rarely reads the flusher's line.
+        uint64_t stall_count;
+        char padding[64];  // Keeps the shard's and the flusher's counters off one cache line.
+        std::atomic<uint64_t> tail;  // Bytes appended, written by the shard.
+        char padding_after_tail[64];
+        std::atomic<uint64_t> head;  // Bytes committed, written by the flusher.
+    };
+
+    /* ------------------------------------------------------------------------------------
+     * CLASS NAME: Reader
+     * ------------------------------------------------------------------------------------
+     * @brief Reads the records of a log back in order, from any thread and while the log
+     *        is still being appended to.
+     *
+     * A record torn by a crash at the end of the log is not returned; GetCompleteSize
+     * tells where the last whole record ends, for the log to be cut back to.
+     * ------------------------------------------------------------------------------------
+     */
+    class Reader {
+      public:
+        explicit Reader(const std::string& path);
+        ~Reader();
+        bool IsOpen() const { return log_file != -1; }
+        void Seek(uint64_t position);
+        bool Next(Record& record);
+        uint64_t GetSize() const { return size; }
+        uint64_t GetCompleteSize() const { return complete_size; }
+
+      private:
+        static constexpr size_t CHUNK_SIZE = 1 << 16;
+
+        int log_file;
+        std::string path;
+        std::string buffer;
+        size_t offset;           // The next frame in buffer.
+        uint64_t size;           // The bytes read so far.
+        uint64_t complete_size;  // The end of the last whole record read.
+        bool is_checked;         // Set once FILE_MAGIC has been read.
+    };
+
+    MoveLog(const std::string& path, int sync_milliseconds, int writer_count);
+    ~MoveLog();
+    Writer* GetWriter(int index) { return writers[index].get(); }
+    static void EncodeRecord(const Record& record, char* frame);
+    static bool DecodeRecord(const char* payload, size_t payload_size, Record& record);
+
+  private:
+    static constexpr size_t RING_CAPACITY = 1 << 22;  // 4 MiB, about 175k moves, per shard.
+    static constexpr int COMMIT_INTERVAL  = 1;        // Milliseconds.
+
+    int log_file;
+    int sync_milliseconds;
+    std::atomic<uint64_t> committed_size;  // The bytes in the file, always a record boundary.
+    std::vector<std::unique_ptr<Writer>> writers;
+    std::atomic<bool> is_stopping;
+    bool is_failed;
+    std::thread flusher;
+
+    void Flush();
+    size_t Commit();
+    bool WriteAll(struct iovec* iovecs, int iovec_count);
+};
+#endif /* MoveLog_h */
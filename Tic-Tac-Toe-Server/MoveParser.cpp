@@ -0,0 +1,215 @@
+#include "MoveParser.h"
+#include <nlohmann/json.hpp>
+#include <cstring>
+
+namespace MoveParser {
+  namespace {
+    const unsigned MAXIMUM_NUMBER = 0xffff;
+    
+    enum Field {
+      NO_FIELD = 0,
+      ROW      = 1,
+      COLUMN   = 2
+    };
+    
+    Field FindField(const char* name, size_t size) {
+      if (size == 3 && std::memcmp(name, "row", 3) == 0) {
+        return ROW;
+      }
+      if (size == 6 && std::memcmp(name, "column", 6) == 0) {
+        return COLUMN;
+      }
+      return NO_FIELD;
+    }
+    
+    /* ----------------------------------------------------------------------------------
+     * CLASS NAME: MoveHandler
+     * ----------------------------------------------------------------------------------
+     * @brief SAX handler that accepts a single flat object of "row" and "column" and
+     *        stores the two numbers as they are read.
+     *
+     * Every callback that cannot be part of a move returns false, which stops
+     * sax_parse straight away. Keys reach key() as a std::string, but "row" and
+     * "column" fit in its small-string buffer, so nothing is allocated.
+     * ----------------------------------------------------------------------------------
+     */
+    class MoveHandler {
+      public:
+        typedef nlohmann::json::number_integer_t  number_integer_t;
+        typedef nlohmann::json::number_unsigned_t number_unsigned_t;
+        typedef nlohmann::json::number_float_t    number_float_t;
+        typedef nlohmann::json::string_t          string_t;
+        typedef nlohmann::json::binary_t          binary_t;
+        
+        MoveHandler(int& row, int& column)
+          : row(row), column(column), field(NO_FIELD), seen(0), is_in_object(false), is_done(false) {}
+        
+        bool null() { return false; }
+        bool boolean(bool) { return false; }
+        bool number_float(number_float_t, const string_t&) { return false; }
+        bool string(string_t&) { return false; }
+        bool binary(binary_t&) { return false; }
+        bool start_array(std::size_t) { return false; }
+        bool end_array() { return false; }
+        
+        bool number_integer(number_integer_t value) {
+          return value >= 0 && number_unsigned(static_cast<number_unsigned_t>(value));
+        }
+        
+        bool number_unsigned(number_unsigned_t value) {
+          if (field == NO_FIELD || value > MAXIMUM_NUMBER) {
+            return false;
+          }
+          (field == ROW ? row : column) = static_cast<int>(value);
+          seen |= field;
+          field = NO_FIELD;
+          return true;
+        }
+        
+        bool start_object(std::size_t) {
+          if (is_in_object || is_done) {
+            return false;
+          }
+          is_in_object = true;
+          return true;
+        }
+        
+        bool key(string_t& name) {
+          field = FindField(name.data(), name.size());
+          return field != NO_FIELD && (seen & field) == 0;
+        }
+        
+        bool end_object() {
+          is_in_object = false;
+          is_done = true;
+          return seen == (ROW | COLUMN);
+        }
+        
+        bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) {
+          return false;
+        }
+        
+        bool IsComplete() const { return is_done; }
+        
+      private:
+        int& row;
+        int& column;
+        Field field;
+        int seen;
+        bool is_in_object;
+        bool is_done;
+    };
+    
+    void SkipWhitespace(const char*& cursor, const char* end) {
+      while (cursor != end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r')) {
+        ++cursor;
+      }
+    }
+    
+    bool ScanNumber(const char*& cursor, const char* end, int& value) {
+      const char* start = cursor;
+      unsigned number = 0;
+      while (cursor != end && *cursor >= '0' && *cursor <= '9') {
+        number = number * 10 + static_cast<unsigned>(*cursor - '0');
+        ++cursor;
+        if (number > MAXIMUM_NUMBER) {
+          return false;
+        }
+      }
+      // Reject an empty number and JSON-invalid leading zeros such as 012.
+      if (cursor == start || (*start == '0' && cursor - start > 1)) {
+        return false;
+      }
+      value = static_cast<int>(number);
+      return true;
+    }
+  }
+  
+  /* ------------------------------------------------------------------------------------
+   * FUNCTION NAME: ParseJsonMove
+   * ------------------------------------------------------------------------------------
+   * @brief Scans a JSON move in place.
+   *
+   * @details Accepts whitespace between tokens and the two keys in either order, and
+   *          nothing else: no escapes, signs, fractions, exponents, extra or repeated
+   *          keys, or bytes after the closing brace.
+   *
+   * @return True if the payload is a move object, false otherwise.
+   * ------------------------------------------------------------------------------------
+   */
+  bool ParseJsonMove(const char* payload, size_t payload_size, int& row, int& column) {
+    const char* cursor = payload;
+    const char* end    = payload + payload_size;
+    int seen = 0;
+    
+    SkipWhitespace(cursor, end);
+    if (cursor == end || *cursor++ != '{') {
+      return false;
+    }
+    for (;;) {
+      SkipWhitespace(cursor, end);
+      if (cursor == end || *cursor++ != '"') {
+        return false;
+      }
+      const char* name = cursor;
+      while (cursor != end && *cursor != '"' && *cursor != '\\') {
+        ++cursor;
+      }
+      if (cursor == end || *cursor != '"') {
+        return false;
+      }
+      Field field = FindField(name, static_cast<size_t>(cursor - name));
+      ++cursor;
+      if (field == NO_FIELD || (seen & field) != 0) {
+        return false;
+      }
+      SkipWhitespace(cursor, end);
+      if (cursor == end || *cursor++ != ':') {
+        return false;
+      }
+      SkipWhitespace(cursor, end);
+      if (!ScanNumber(cursor, end, field == ROW ? row : column)) {
+        return false;
+      }
+      seen |= field;
+      SkipWhitespace(cursor, end);
+      if (cursor == end) {
+        return false;
+      }
+      if (*cursor == '}') {
+        ++cursor;
+        break;
+      }
+      if (*cursor++ != ',') {
+        return false;
+      }
+    }
+    SkipWhitespace(cursor, end);
+    
+    return cursor == end && seen == (ROW | COLUMN);
+  }
+  
+  /* ------------------------------------------------------------------------------------
+   * FUNCTION NAME: ParseEncodedMove
+   * ------------------------------------------------------------------------------------
+   * @brief Reads a move in the given protocol; CBOR and MessagePack through sax_parse.
+   *
+   * @return True if the payload is a move object, false otherwise.
+   * ------------------------------------------------------------------------------------
+   */
+  bool ParseEncodedMove(WireProtocol::Protocol protocol, const char* payload, size_t payload_size,
+                        int& row, int& column) {
+    nlohmann::json::input_format_t format;
+    if (protocol == WireProtocol::CBOR) {
+      format = nlohmann::json::input_format_t::cbor;
+    } else if (protocol == WireProtocol::MSGPACK) {
+      format = nlohmann::json::input_format_t::msgpack;
+    } else {
+      return ParseJsonMove(payload, payload_size, row, column);
+    }
+    MoveHandler handler(row, column);
+    
+    return nlohmann::json::sax_parse(payload, payload + payload_size, &handler, format) &&
+           handler.IsComplete();
+  }
+}
@@ -0,0 +1,24 @@
+#ifndef MoveParser_h
+#define MoveParser_h
+#include "WireProtocol.h"
+#include <cstddef>
+
+/* -------------------------------------------------------------------------------------
+ * NAMESPACE NAME: MoveParser
+ * -------------------------------------------------------------------------------------
+ * @brief Reads the row and column number out of a JSON, CBOR or MessagePack move
+ *        without building a json document.
+ *
+ * A move is always the object {"row":..,"column":..} holding two unsigned integers
+ * (in Network-Byte-Order, as the client sends them). JSON moves are read by a
+ * hand-rolled scanner; CBOR and MessagePack moves are walked with nlohmann's
+ * sax_parse. Neither allocates on the heap, and anything other than exactly those
+ * two keys is rejected at the first unexpected byte.
+ * -------------------------------------------------------------------------------------
+ */
+namespace MoveParser {
+  bool ParseJsonMove(const char* payload, size_t payload_size, int& row, int& column);
+  bool ParseEncodedMove(WireProtocol::Protocol protocol, const char* payload, size_t payload_size,
+                        int& row, int& column);
+}
+#endif /* MoveParser_h */
@@ -0,0 +1,140 @@
+#include "PerfectPlayRequestManager.h"
+#include "BoardSymmetry.h"
+#include <algorithm>
+
+namespace Request_Manager {
+  namespace {
+    const int SPOT_COUNT     = 9;
+    const int NOT_SOLVED     = 127;
+    const int8_t NO_MOVE     = -1;
+    
+    /* ----------------------------------------------------------------------
+     * STRUCT NAME: PerfectPlayTable
+     * ----------------------------------------------------------------------
+     * @brief The best spot of the player to move, for every board by its
+     *        PositionIndex::BoardCode, or NO_MOVE once the game is over.
+     * ----------------------------------------------------------------------
+     */
+    struct PerfectPlayTable {
+      int8_t best_spot[PositionIndex::BOARD_CODE_COUNT];
+      
+      PerfectPlayTable() {
+        int8_t values[PositionIndex::POSITION_COUNT];
+        int8_t canonical_spots[PositionIndex::POSITION_COUNT] = {};  // Left 0 for the full boards Solve skips.
+        std::fill(values, values + PositionIndex::POSITION_COUNT, static_cast<int8_t>(NOT_SOLVED));
+        std::fill(best_spot, best_spot + PositionIndex::BOARD_CODE_COUNT, NO_MOVE);
+        Game game;
+        Solve(game, 'X', 0, values, canonical_spots);
+        Spread(game, 'X', 0, canonical_spots);
+      }
+      
+      /* ------------------------------------------------------------------
+       * FUNCTION NAME: Solve
+       * ------------------------------------------------------------------
+       * @brief Negamax over the canonical positions, memoized by their index.
+       *
+       * @details A win is worth 10 minus the number of spots taken when it
+       *          happens, so quicker wins and slower losses score better.
+       *          The best spot is kept in the canonical position's frame.
+       *
+       * @return The value of the position for the player to move.
+       * ------------------------------------------------------------------
+       */
+      static int Solve(Game& game, char letter, int taken, int8_t* values, int8_t* canonical_spots) {
+        const char other = letter == 'X' ? 'O' : 'X';
+        if (game.IsWinner(other)) {
+          return -(10 - taken);
+        }
+        if (taken == SPOT_COUNT) {
+          return 0;
+        }
+        BoardSymmetry::CanonicalPosition position = BoardSymmetry::Canonicalize(game);
+        int index = PositionIndex::IndexOf(game);
+        if (values[index] != NOT_SOLVED) {
+          return values[index];
+        }
+        int best_value = -100;
+        int best_move  = 0;
+        for (int spot = 0; spot < SPOT_COUNT; ++spot) {
+          int row    = spot / 3 + 1;
+          int column = spot % 3 + 1;
+          if (!game.IsMoveValid(row, column)) {
+            continue;
+          }
+          game.InsertMove(row, column, letter);
+          int value = -Solve(game, other, taken + 1, values, canonical_spots);
+          game.RemoveMove(row, column);
+          if (value > best_value) {
+            best_value = value;
+            best_move  = spot;
+          }
+        }
+        values[index]          = static_cast<int8_t>(best_value);
+        canonical_spots[index] = static_cast<int8_t>(BoardSymmetry::TransformSpot(best_move, position.transform));
+        
+        return best_value;
+      }
+      
+      /* Fills best_spot for every board reachable from a position; won and full boards keep NO_MOVE. */
+      void Spread(Game& game, char letter, int taken, const int8_t* canonical_spots) {
+        int code = PositionIndex::BoardCode(game.GetMask('X'), game.GetMask('O'));
+        if (best_spot[code] != NO_MOVE || taken == SPOT_COUNT || game.IsWinner('X') || game.IsWinner('O')) {
+          return;
+        }
+        BoardSymmetry::CanonicalPosition position = BoardSymmetry::Canonicalize(game);
+        int canonical_spot = canonical_spots[PositionIndex::IndexOf(game)];
+        best_spot[code] = static_cast<int8_t>(
+            BoardSymmetry::TransformSpot(canonical_spot, BoardSymmetry::InverseTransform(position.transform)));
+        for (int spot = 0; spot < SPOT_COUNT; ++spot) {
+          int row    = spot / 3 + 1;
+          int column = spot % 3 + 1;
+          if (game.IsMoveValid(row, column)) {
+            game.InsertMove(row, column, letter);
+            Spread(game, letter == 'X' ? 'O' : 'X', taken + 1, canonical_spots);
+            game.RemoveMove(row, column);
+          }
+        }
+      }
+    };
+    
+    const PerfectPlayTable& GetTable() {
+      static const PerfectPlayTable table;
+      return table;
+    }
+  }
+  
+  /* ----------------------------------------------------------------------
+   * CONSTRUCTOR NAME: PerfectPlayRequestManager
+   * ----------------------------------------------------------------------
+   * @brief Builds the table, shared by every instance, if it is not built yet,
+   *        so that no game pays for it on its first move.
+   * ----------------------------------------------------------------------
+   */
+  PerfectPlayRequestManager::PerfectPlayRequestManager() {
+    GetTable();
+  }
+  
+  /* ----------------------------------------------------------------------
+   * FUNCTION NAME: GetMove
+   * ----------------------------------------------------------------------
+   * @brief Looks up the best spot for the player to move.
+   *
+   * @param game    [in] The game the move is made on.
+   * @param letter  [in] The player's symbol ('X' or 'O'); X moves first,
+   *                     so the table knows whose turn it is from the board.
+   *
+   * @return Returns the row and column number of the best spot, or row and
+   *         column 0 if the game is over.
+   * ----------------------------------------------------------------------
+   */
+  Player PerfectPlayRequestManager::GetMove(const Game& game, const char letter) {
+    Player player = { 0, 0 };
+    int spot = GetTable().best_spot[PositionIndex::BoardCode(game.GetMask('X'), game.GetMask('O'))];
+    if (spot != NO_MOVE) {
+      player.row    = spot / 3 + 1;
+      player.column = spot % 3 + 1;
+    }
+    
+    return player;
+  }
+}
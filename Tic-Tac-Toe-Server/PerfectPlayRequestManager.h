@@ -0,0 +1,27 @@
+#ifndef PerfectPlayRequestManager_h
+#define PerfectPlayRequestManager_h
+#include "IRequestManager.h"
+
+namespace Request_Manager {
+/* ------------------------------------------------------------------
+ * CLASS NAME: PerfectPlayRequestManager
+ * ------------------------------------------------------------------
+ * @brief Plays the server's side of a game perfectly, from a table.
+ *
+ * The PerfectPlayRequestManager class implements the IRequestManager
+ * interface with a table of the best spot for every board that can
+ * come up in a game, so a move is a single array lookup and never a
+ * search. The table is solved once, on the 765 canonical positions of
+ * PositionIndex, and spread to all their symmetric boards.
+ *
+ * A perfect player never loses: it wins whenever the other side
+ * blunders, as quickly as it can, and holds the tie otherwise.
+ * ------------------------------------------------------------------
+ */
+  class PerfectPlayRequestManager : public IRequestManager {
+    public:
+      PerfectPlayRequestManager();
+      Player GetMove(const Game& game, const char letter);
+  };
+}
+#endif /* PerfectPlayRequestManager_h */
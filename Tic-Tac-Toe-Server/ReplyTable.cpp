@@ -0,0 +1,290 @@
+#include "ReplyTable.h"
+#include "MessageFrame.h"
+#include <arpa/inet.h>
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace ReplyTable {
+  namespace {
+    const int BOARD_SIZE      = 3;
+    const int SPOT_COUNT      = 9;
+    const char EMPTY_BOARD[]  = "***\n***\n***\n";
+    const char ESCAPED_BOARD[] = "***\\n***\\n***\\n";  // EMPTY_BOARD as it appears in JSON text.
+    
+    /* A framed reply, and where its board (the first spot, or the binary bitboard) is. */
+    struct ReplyTemplate {
+      std::string framed_data;
+      size_t board_offset;
+      size_t line_end_size;  // Bytes between the last spot of a row and the first of the next.
+    };
+    
+    struct Templates {
+      ReplyTemplate replies[WireProtocol::PROTOCOL_COUNT][WireProtocol::REPLY_COUNT];
+      
+      Templates() {
+        for (int protocol = 0; protocol < WireProtocol::PROTOCOL_COUNT; ++protocol) {
+          for (int reply = 0; reply < WireProtocol::REPLY_COUNT; ++reply) {
+            Build(static_cast<WireProtocol::Protocol>(protocol), static_cast<WireProtocol::Reply>(reply),
+                  replies[protocol][reply]);
+          }
+        }
+      }
+      
+      /* ------------------------------------------------------------------------------
+       * FUNCTION NAME: Build
+       * ------------------------------------------------------------------------------
+       * @brief Encodes a reply with an empty board and finds the board in the result.
+       *
+       * @throws std::runtime_error if the encoded board cannot be found.
+       * ------------------------------------------------------------------------------
+       */
+      static void Build(WireProtocol::Protocol protocol, WireProtocol::Reply reply, ReplyTemplate& entry) {
+        std::string payload;
+        std::string board = EMPTY_BOARD;
+        entry.line_end_size = 1;
+        if (protocol == WireProtocol::BINARY) {
+          WireProtocol::AppendReply(payload, reply, 0);
+          MessageFrame::AppendFrame(entry.framed_data, payload.data(), payload.size());
+          entry.board_offset = MessageFrame::HEADER_SIZE + 1;  // After the reply code.
+          return;
+        }
+        nlohmann::json json_data;
+        json_data["status_message"] = WireProtocol::ReplyMessage(reply);
+        json_data["game_board"]     = EMPTY_BOARD;
+        if (protocol == WireProtocol::CBOR) {
+          nlohmann::json::to_cbor(json_data, payload);
+        } else if (protocol == WireProtocol::MSGPACK) {
+          nlohmann::json::to_msgpack(json_data, payload);
+        } else {
+          payload = json_data.dump();
+          board = ESCAPED_BOARD;
+          entry.line_end_size = 2;
+        }
+        size_t position = payload.find(board);
+        if (position == std::string::npos) {
+          throw std::runtime_error("Error! Game board not found in encoded reply.");
+        }
+        MessageFrame::AppendFrame(entry.framed_data, payload.data(), payload.size());
+        entry.board_offset = MessageFrame::HEADER_SIZE + position;
+      }
+    };
+    
+    const Templates& GetTemplates() {
+      static const Templates templates;
+      return templates;
+    }
+    
+    /* Runs an operation run_count times and returns the nanoseconds each run took. */
+    template <typename Operation>
+    double TimePerRun(size_t run_count, Operation operation) {
+      auto start = std::chrono::steady_clock::now();
+      for (size_t run = 0; run < run_count; ++run) {
+        operation();
+      }
+      return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / run_count;
+    }
+    
+    /* The client's side of the JSON, CBOR and MessagePack protocols: nlohmann json documents. */
+    void EncodeDocument(WireProtocol::Protocol protocol, const nlohmann::json& json_data, std::string& payload) {
+      payload.clear();
+      if (protocol == WireProtocol::CBOR) {
+        nlohmann::json::to_cbor(json_data, payload);
+      } else if (protocol == WireProtocol::MSGPACK) {
+        nlohmann::json::to_msgpack(json_data, payload);
+      } else {
+        payload = json_data.dump();
+      }
+    }
+    
+    nlohmann::json DecodeDocument(WireProtocol::Protocol protocol, const std::string& payload) {
+      if (protocol == WireProtocol::CBOR) {
+        return nlohmann::json::from_cbor(payload);
+      }
+      if (protocol == WireProtocol::MSGPACK) {
+        return nlohmann::json::from_msgpack(payload);
+      }
+      return nlohmann::json::parse(payload);
+    }
+    
+    /* What a message costs in one protocol. */
+    struct MessageCost {
+      size_t size;
+      double encode_nanoseconds;
+      double decode_nanoseconds;
+    };
+    
+    void PrintCost(const char* name, const MessageCost& cost) {
+      std::cout << " " << name << " " << std::setw(2) << cost.size << "B enc " << std::setw(4)
+                << cost.encode_nanoseconds << "ns dec " << std::setw(4) << cost.decode_nanoseconds << "ns";
+    }
+  }
+  
+  /* ------------------------------------------------------------------------------------
+   * FUNCTION NAME: AppendReply
+   * ------------------------------------------------------------------------------------
+   * @brief Appends a framed reply, encoded in the given protocol, to a send buffer.
+   *
+   * @param buffer       [out] The buffer the framed reply is appended to.
+   * @param protocol     [in]  The protocol the client asked for in its hello.
+   * @param reply        [in]  The reply to send.
+   * @param packed_board [in]  The game board, packed as by Game::PackBoard.
+   * ------------------------------------------------------------------------------------
+   */
+  void AppendReply(std::string& buffer, WireProtocol::Protocol protocol, WireProtocol::Reply reply,
+                   uint32_t packed_board) {
+    const ReplyTemplate& entry = GetTemplates().replies[protocol][reply];
+    size_t start = buffer.size();
+    buffer += entry.framed_data;
+    char* data = &buffer[start];
+    if (protocol == WireProtocol::BINARY) {
+      char* board = data + entry.board_offset;
+      board[0] = static_cast<char>((packed_board >> 16) & 0xff);
+      board[1] = static_cast<char>((packed_board >> 8) & 0xff);
+      board[2] = static_cast<char>(packed_board & 0xff);
+      return;
+    }
+    char* spot_data = data + entry.board_offset;
+    for (int spot = 0; spot < SPOT_COUNT; ++spot) {
+      if (packed_board & (1u << (SPOT_COUNT + spot))) {
+        *spot_data = 'X';
+      } else if (packed_board & (1u << spot)) {
+        *spot_data = 'O';
+      }
+      spot_data += (spot % BOARD_SIZE == BOARD_SIZE - 1) ? 1 + entry.line_end_size : 1;
+    }
+  }
+  
+  /* ------------------------------------------------------------------------------------
+   * FUNCTION NAME: AppendSeat
+   * ------------------------------------------------------------------------------------
+   * @brief Appends a framed seat message, encoded in the given protocol, to a send buffer.
+   *
+   * @param buffer     [out] The buffer the framed message is appended to.
+   * @param protocol   [in]  The protocol the client asked for in its hello.
+   * @param game_id    [in]  The ID of the player's game.
+   * @param seat_token [in]  The token that takes the player's seat back, see SeatTokens.
+   * ------------------------------------------------------------------------------------
+   */
+  void AppendSeat(std::string& buffer, WireProtocol::Protocol protocol, uint32_t game_id, uint64_t seat_token) {
+    std::string payload;
+    if (protocol == WireProtocol::BINARY) {
+      WireProtocol::AppendSeat(payload, game_id, seat_token);
+    } else {
+      char token_digits[17];
+      snprintf(token_digits, sizeof(token_digits), "%016llx", static_cast<unsigned long long>(seat_token));
+      nlohmann::json json_data;
+      json_data["status_message"] = WireProtocol::ReplyMessage(WireProtocol::SEAT);
+      json_data["game_id"]        = game_id;
+      json_data["seat_token"]     = token_digits;
+      EncodeDocument(protocol, json_data, payload);
+    }
+    MessageFrame::AppendFrame(buffer, payload.data(), payload.size());
+  }
+  
+  /* ------------------------------------------------------------------------------------
+   * FUNCTION NAME: RunBenchmark
+   * ------------------------------------------------------------------------------------
+   * @brief Prints the size of a move and a reply in every protocol, and how long each
+   *        takes to encode and decode, over message_count messages.
+   *
+   * @details Moves and replies of the JSON, CBOR and MessagePack protocols are built and
+   *          read as nlohmann json documents, the way the client does; the binary ones
+   *          through WireProtocol. The last column is what the server pays to send the
+   *          reply, frame included, through AppendReply.
+   *
+   * @throws std::runtime_error if a move or reply does not decode to what was encoded.
+   * ------------------------------------------------------------------------------------
+   */
+  void RunBenchmark(size_t message_count) {
+    const WireProtocol::Protocol protocols[] = {
+      WireProtocol::JSON, WireProtocol::CBOR, WireProtocol::MSGPACK, WireProtocol::BINARY
+    };
+    const char* const protocol_names[] = { "json   ", "cbor   ", "msgpack", "binary " };
+    const int row                      = 2;
+    const int column                   = 3;
+    const WireProtocol::Reply reply    = WireProtocol::MOVE_ACCEPTED;
+    const uint32_t packed_board        = (1u << (SPOT_COUNT + 4)) | (1u << 5);  // X in the centre, O next to it.
+    std::string payload;
+    std::string buffer;
+    volatile int sink = 0;
+    
+    std::cout << "Encoding cost per message, " << message_count << " messages:" << std::endl;
+    std::cout << std::fixed << std::setprecision(0);
+    for (int index = 0; index < WireProtocol::PROTOCOL_COUNT; ++index) {
+      const WireProtocol::Protocol protocol = protocols[index];
+      MessageCost move_cost;
+      MessageCost reply_cost;
+      bool is_round_trip;
+      if (protocol == WireProtocol::BINARY) {
+        move_cost.encode_nanoseconds = TimePerRun(message_count, [&] {
+          payload.clear();
+          WireProtocol::AppendMove(payload, row, column);
+        });
+        move_cost.size = payload.size();
+        int parsed_row    = 0;
+        int parsed_column = 0;
+        move_cost.decode_nanoseconds = TimePerRun(message_count, [&] {
+          sink = WireProtocol::ParseMove(payload.data(), payload.size(), parsed_row, parsed_column);
+        });
+        is_round_trip = parsed_row == row && parsed_column == column;
+        
+        reply_cost.encode_nanoseconds = TimePerRun(message_count, [&] {
+          payload.clear();
+          WireProtocol::AppendReply(payload, reply, packed_board);
+        });
+        reply_cost.size = payload.size();
+        WireProtocol::Reply parsed_reply = WireProtocol::PLAYER_X_MOVED;
+        uint32_t parsed_board            = 0;
+        reply_cost.decode_nanoseconds = TimePerRun(message_count, [&] {
+          sink = WireProtocol::ParseReply(payload.data(), payload.size(), parsed_reply, parsed_board);
+        });
+        is_round_trip = is_round_trip && parsed_reply == reply && parsed_board == packed_board;
+      } else {
+        move_cost.encode_nanoseconds = TimePerRun(message_count, [&] {
+          nlohmann::json move_data;
+          move_data["row"]    = htons(row);
+          move_data["column"] = htons(column);
+          EncodeDocument(protocol, move_data, payload);
+        });
+        move_cost.size = payload.size();
+        move_cost.decode_nanoseconds = TimePerRun(message_count, [&] {
+          sink = DecodeDocument(protocol, payload)["row"].get<int>();
+        });
+        nlohmann::json move_data = DecodeDocument(protocol, payload);
+        is_round_trip = move_data["row"].get<int>() == htons(row) && move_data["column"].get<int>() == htons(column);
+        
+        const std::string board = WireProtocol::UnpackBoard(packed_board);
+        reply_cost.encode_nanoseconds = TimePerRun(message_count, [&] {
+          nlohmann::json reply_data;
+          reply_data["status_message"] = WireProtocol::ReplyMessage(reply);
+          reply_data["game_board"]     = board;
+          EncodeDocument(protocol, reply_data, payload);
+        });
+        reply_cost.size = payload.size();
+        reply_cost.decode_nanoseconds = TimePerRun(message_count, [&] {
+          sink = static_cast<int>(DecodeDocument(protocol, payload)["game_board"].get_ref<const std::string&>().size());
+        });
+        nlohmann::json reply_data = DecodeDocument(protocol, payload);
+        is_round_trip = is_round_trip && reply_data["game_board"] == board &&
+                        reply_data["status_message"] == WireProtocol::ReplyMessage(reply);
+      }
+      if (!is_round_trip) {
+        throw std::runtime_error("Error! A message does not decode to what was encoded.");
+      }
+      double table_nanoseconds = TimePerRun(message_count, [&] {
+        buffer.clear();
+        AppendReply(buffer, protocol, reply, packed_board);
+      });
+      
+      std::cout << "  " << protocol_names[index];
+      PrintCost("move", move_cost);
+      std::cout << " |";
+      PrintCost("reply", reply_cost);
+      std::cout << " | server reply " << std::setw(3) << table_nanoseconds << "ns" << std::endl;
+    }
+  }
+}
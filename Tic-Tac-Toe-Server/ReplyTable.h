@@ -0,0 +1,31 @@
+#ifndef ReplyTable_h
+#define ReplyTable_h
+#include "WireProtocol.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/* -------------------------------------------------------------------------------------
+ * NAMESPACE NAME: ReplyTable
+ * -------------------------------------------------------------------------------------
+ * @brief Pre-encoded replies of the server, one per protocol and Reply.
+ *
+ * A reply only ever differs in its nine board spots, so every (protocol, Reply) pair
+ * is encoded once, frame header included, around a placeholder board. Sending a reply
+ * appends that template to the send buffer and writes the spots over the placeholder:
+ * no json object, no temporary string and no English message is built per move.
+ *
+ * The JSON, CBOR and MessagePack templates are produced by nlohmann json itself, so
+ * they are byte-for-byte what serializing {"status_message":..,"game_board":..} gives.
+ * RunBenchmark compares the size and cost of a move and a reply in every protocol.
+ * The seat message, sent once per player and game, has no board and no template:
+ * AppendSeat encodes it on the spot.
+ * -------------------------------------------------------------------------------------
+ */
+namespace ReplyTable {
+  void AppendReply(std::string& buffer, WireProtocol::Protocol protocol, WireProtocol::Reply reply,
+                   uint32_t packed_board);
+  void AppendSeat(std::string& buffer, WireProtocol::Protocol protocol, uint32_t game_id, uint64_t seat_token);
+  void RunBenchmark(size_t message_count);
+}
+#endif /* ReplyTable_h */
@@ -1,6 +1,30 @@
 #include <iostream>
 #include "RequestManager.h"
+#include <limits>
 namespace Request_Manager {
+  /* ----------------------------------------------------------------------
+   * FUNCTION NAME: GetMove
+   * ----------------------------------------------------------------------
+   * @brief Prompts the person at the server's terminal for a move.
+   *
+   * @param game    [in] The game the move is made on.
+   * @param letter  [in] The player's symbol ('X' or 'O').
+   *
+   * @return Returns the validated row and column number.
+   * ----------------------------------------------------------------------
+   */
+  Player RequestManager::GetMove(const Game& game, const char letter) {
+    PromptingUser prompting;
+    Player player;
+    prompting.PlayerTurn(letter);
+    prompting.UserForRowNumber();
+    player.row    = GetValidatedUserInput(player.row, 1, 3, 'R');
+    prompting.UserForColumnNumber();
+    player.column = GetValidatedUserInput(player.column, 1, 3, 'C');
+    
+    return player;
+  }
+  
   /* ----------------------------------------------------------------------
    * FUNCTION NAME: GetValidatedUserInput
    * ----------------------------------------------------------------------
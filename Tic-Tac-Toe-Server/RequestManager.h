@@ -1,7 +1,7 @@
 #ifndef RequestManager_h
 #define RequestManager_h
-#include "GameManager.h"
 #include "Player.h"
+#include "PromptingUser.h"
 #include "IRequestManager.h"
 #include "Game.h"
 
@@ -14,17 +14,17 @@ namespace Request_Manager {
  * The Request Manager class implements the IRequestManager interface
  * to create an interface with IRequestManager. It is responsible for
  * getting a validated user input for row and column number during a
- * Tic-Tac-Toe game.
+ * Tic-Tac-Toe game from the person at the server's terminal.
  * ------------------------------------------------------------------
  */
   class RequestManager : public IRequestManager {
     public:
       RequestManager() = default;
+      Player GetMove(const Game& game, const char letter);
       int GetValidatedUserInput(int& user_input, const int row, const int column, const char letter);
       ~RequestManager();
     
     private:
-      GameManager game_manager;
       IRequestManager *ptr;
   };
 }
@@ -0,0 +1,21 @@
+#include "SearchRequestManager.h"
+
+namespace Request_Manager {
+  SearchRequestManager::SearchRequestManager(std::chrono::milliseconds time_budget) : search(time_budget) {}
+  
+  /* ----------------------------------------------------------------------
+   * FUNCTION NAME: GetMove
+   * ----------------------------------------------------------------------
+   * @brief Searches for the best spot for the player to move.
+   *
+   * @param game    [in] The game the move is made on.
+   * @param letter  [in] The player's symbol ('X' or 'O').
+   *
+   * @return Returns the row and column number of the best spot found in
+   *         the time budget, or row and column 0 if the game is over.
+   * ----------------------------------------------------------------------
+   */
+  Player SearchRequestManager::GetMove(const Game& game, const char letter) {
+    return search.GetMove(game, letter);
+  }
+}
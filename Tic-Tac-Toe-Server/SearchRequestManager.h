@@ -0,0 +1,27 @@
+#ifndef SearchRequestManager_h
+#define SearchRequestManager_h
+#include "AlphaBetaSearch.h"
+#include "IRequestManager.h"
+
+namespace Request_Manager {
+/* ------------------------------------------------------------------
+ * CLASS NAME: SearchRequestManager
+ * ------------------------------------------------------------------
+ * @brief Plays the server's side of a game by searching for a move.
+ *
+ * The SearchRequestManager class implements the IRequestManager
+ * interface with an AlphaBetaSearch of the game, answering every move
+ * within a fixed time budget. The engine itself works on any board
+ * variant of BasicGame; this is its player for the server's board.
+ * ------------------------------------------------------------------
+ */
+  class SearchRequestManager : public IRequestManager {
+    public:
+      explicit SearchRequestManager(std::chrono::milliseconds time_budget);
+      Player GetMove(const Game& game, const char letter);
+    
+    private:
+      AlphaBetaSearch<Game> search;
+  };
+}
+#endif /* SearchRequestManager_h */
@@ -0,0 +1,138 @@
+#include "SeatTokens.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <random>
+#include <stdexcept>
+
+namespace {
+  uint64_t RotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+  }
+
+  void SipRound(uint64_t state[4]) {
+    state[0] += state[1];
+    state[1]  = RotateLeft(state[1], 13) ^ state[0];
+    state[0]  = RotateLeft(state[0], 32);
+    state[2] += state[3];
+    state[3]  = RotateLeft(state[3], 16) ^ state[2];
+    state[0] += state[3];
+    state[3]  = RotateLeft(state[3], 21) ^ state[0];
+    state[2] += state[1];
+    state[1]  = RotateLeft(state[1], 17) ^ state[2];
+    state[2]  = RotateLeft(state[2], 32);
+  }
+
+  /* SipHash-2-4 of a message of one 64-bit word, as its 8 little-endian bytes. */
+  uint64_t SipHash(const uint64_t key[2], uint64_t word) {
+    uint64_t state[4] = {
+      key[0] ^ 0x736f6d6570736575ull, key[1] ^ 0x646f72616e646f6dull,
+      key[0] ^ 0x6c7967656e657261ull, key[1] ^ 0x7465646279746573ull
+    };
+    const uint64_t blocks[] = { word, 8ull << 56 };  // The word, then the message length.
+    for (uint64_t block : blocks) {
+      state[3] ^= block;
+      SipRound(state);
+      SipRound(state);
+      state[0] ^= block;
+    }
+    state[2] ^= 0xff;
+    for (int round = 0; round < 4; ++round) {
+      SipRound(state);
+    }
+    return state[0] ^ state[1] ^ state[2] ^ state[3];
+  }
+
+  bool ReadAll(int file, unsigned char* bytes, size_t size) {
+    while (size > 0) {
+      ssize_t bytes_read = read(file, bytes, size);
+      if (bytes_read == -1 && errno == EINTR) {
+        continue;
+      }
+      if (bytes_read <= 0) {
+        return false;
+      }
+      bytes += bytes_read;
+      size  -= static_cast<size_t>(bytes_read);
+    }
+    return true;
+  }
+
+  bool WriteAll(int file, const unsigned char* bytes, size_t size) {
+    while (size > 0) {
+      ssize_t written = write(file, bytes, size);
+      if (written == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return false;
+      }
+      bytes += written;
+      size  -= static_cast<size_t>(written);
+    }
+    return true;
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * CONSTRUCTOR NAME: SeatTokens
+ * ------------------------------------------------------------------------------------
+ * @brief Loads the secret key kept next to the move log at log_path, or creates it with
+ *        fresh random bytes, synced to disk before any token is issued under it.
+ *
+ * @throws std::runtime_error if the key file cannot be read or created, or is not a key.
+ * ------------------------------------------------------------------------------------
+ */
+SeatTokens::SeatTokens(const std::string& log_path) {
+  const std::string key_path = log_path + ".seat-key";
+  unsigned char bytes[KEY_SIZE];
+  int file = open(key_path.c_str(), O_RDONLY);
+  if (file != -1) {
+    const bool is_read = ReadAll(file, bytes, KEY_SIZE);
+    close(file);
+    if (!is_read) {
+      throw std::runtime_error("Error! Reading the seat key " + key_path + ".");
+    }
+  } else {
+    std::random_device random;
+    for (int index = 0; index < KEY_SIZE; index += 4) {
+      const uint32_t value = random();
+      for (int byte = 0; byte < 4; ++byte) {
+        bytes[index + byte] = static_cast<unsigned char>(value >> (8 * byte));
+      }
+    }
+    file = open(key_path.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0600);
+    if (file == -1) {
+      throw std::runtime_error("Error! Creating the seat key " + key_path + ".");
+    }
+    const bool is_written = WriteAll(file, bytes, KEY_SIZE) && fsync(file) == 0;
+    close(file);
+    if (!is_written) {
+      throw std::runtime_error("Error! Writing the seat key " + key_path + ".");
+    }
+  }
+  key[0] = 0;
+  key[1] = 0;
+  for (int index = 0; index < KEY_SIZE / 2; ++index) {
+    key[0] |= static_cast<uint64_t>(bytes[index]) << (8 * index);
+    key[1] |= static_cast<uint64_t>(bytes[KEY_SIZE / 2 + index]) << (8 * index);
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Issue
+ * ------------------------------------------------------------------------------------
+ * @brief The token of a seat: a player that brings it back is given that seat.
+ *
+ * @param shard_index   The shard that hosts the game.
+ * @param game_id       The game's ID in the shard's GameStore.
+ * @param letter        The seat, 'X' or 'O'.
+ * @param is_house_game True if the game is against the house player.
+ * ------------------------------------------------------------------------------------
+ */
+uint64_t SeatTokens::Issue(int shard_index, uint32_t game_id, char letter, bool is_house_game) const {
+  const uint64_t seat = (static_cast<uint64_t>(shard_index & 0xffff) << 48) |
+                        (static_cast<uint64_t>(letter == 'X') << 41) | (static_cast<uint64_t>(is_house_game) << 40) |
+                        game_id;
+  return SipHash(key, seat);
+}
@@ -0,0 +1,30 @@
+#ifndef SeatTokens_h
+#define SeatTokens_h
+#include <cstdint>
+#include <string>
+
+/* -------------------------------------------------------------------------------------
+ * CLASS NAME: SeatTokens
+ * -------------------------------------------------------------------------------------
+ * @brief Issues the seat tokens that let the players of a recovered game take their
+ *        seats back, and checks the tokens they bring.
+ *
+ * A seat token is the SipHash-2-4 of the seat (the shard, the game ID, the letter and
+ * whether the game is against the house player) under the server's secret key, so
+ * the server keeps no table of tokens: it checks a token by issuing it again. The key
+ * is KEY_SIZE random bytes in a file next to the move log, "<log>.seat-key", created
+ * the first time the server runs with that log, so tokens outlive the server just as
+ * the games they name do.
+ * -------------------------------------------------------------------------------------
+ */
+class SeatTokens {
+  public:
+    static const int KEY_SIZE = 16;
+
+    explicit SeatTokens(const std::string& log_path);
+    uint64_t Issue(int shard_index, uint32_t game_id, char letter, bool is_house_game) const;
+
+  private:
+    uint64_t key[2];
+};
+#endif /* SeatTokens_h */
@@ -0,0 +1,152 @@
+#include "ServerOptions.h"
+#include "MoveLog.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: ParseServerOptions
+ * ------------------------------------------------------------------------------------
+ * @brief Reads the server's startup options from the command line.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
+ *
+ * @throws std::runtime_error if an option is unknown, is missing its value, or needs another
+ *                            option that is missing.
+ *
+ * @return The parsed ServerOptions.
+ * ------------------------------------------------------------------------------------
+ */
+ServerOptions ParseServerOptions(int argc, const char* argv[]) {
+  ServerOptions options;
+  options.event_loop                  = false;
+  options.shard_count                 = 1;
+  options.io_uring                    = false;
+  options.matchmaking_milliseconds    = 0;
+  options.perfect_play                = false;
+  options.search_milliseconds         = 0;
+  options.mcts_milliseconds           = 0;
+  options.mcts_thread_count           = 0;
+  options.move_milliseconds           = 0;
+  options.idle_milliseconds           = 0;
+  options.move_log_path               = nullptr;
+  options.move_log_sync_milliseconds  = MoveLog::SYNC_EVERY_COMMIT;
+  options.snapshot_milliseconds       = 0;
+  options.archive_path                = nullptr;
+  options.replay_game_id              = -1;
+  options.replay_record_number        = -1;
+  options.archive_scan                = false;
+  options.benchmark_board_count       = 0;
+  options.benchmark_message_count     = 0;
+  options.benchmark_mcts_milliseconds = 0;
+  for (int index = 1; index < argc; ++index) {
+    if (strcmp(argv[index], "--event-loop") == 0) {
+      options.event_loop = true;
+    } else if (strcmp(argv[index], "--shards") == 0 && index + 1 < argc) {
+      options.event_loop  = true;
+      options.shard_count = atoi(argv[++index]);
+      if (options.shard_count < 0) {
+        throw std::runtime_error("Error! Number of shards must not be negative.");
+      }
+    } else if (strcmp(argv[index], "--io-uring") == 0) {
+      options.event_loop = true;
+      options.io_uring   = true;
+    } else if (strcmp(argv[index], "--matchmaking") == 0 && index + 1 < argc) {
+      options.event_loop               = true;
+      options.matchmaking_milliseconds = atoi(argv[++index]);
+      if (options.matchmaking_milliseconds <= 0) {
+        throw std::runtime_error("Error! Matchmaking wait must be positive.");
+      }
+    } else if (strcmp(argv[index], "--perfect-play") == 0) {
+      options.perfect_play = true;
+    } else if (strcmp(argv[index], "--search") == 0 && index + 1 < argc) {
+      options.search_milliseconds = atoi(argv[++index]);
+      if (options.search_milliseconds <= 0) {
+        throw std::runtime_error("Error! Search time must be positive.");
+      }
+    } else if (strcmp(argv[index], "--mcts") == 0 && index + 1 < argc) {
+      options.mcts_milliseconds = atoi(argv[++index]);
+      if (options.mcts_milliseconds <= 0) {
+        throw std::runtime_error("Error! Search time must be positive.");
+      }
+    } else if (strcmp(argv[index], "--mcts-threads") == 0 && index + 1 < argc) {
+      options.mcts_thread_count = atoi(argv[++index]);
+      if (options.mcts_thread_count < 0) {
+        throw std::runtime_error("Error! Number of threads must not be negative.");
+      }
+    } else if (strcmp(argv[index], "--move-time") == 0 && index + 1 < argc) {
+      options.move_milliseconds = atoi(argv[++index]);
+      if (options.move_milliseconds <= 0) {
+        throw std::runtime_error("Error! Move time must be positive.");
+      }
+    } else if (strcmp(argv[index], "--idle-timeout") == 0 && index + 1 < argc) {
+      options.idle_milliseconds = atoi(argv[++index]);
+      if (options.idle_milliseconds <= 0) {
+        throw std::runtime_error("Error! Idle timeout must be positive.");
+      }
+    } else if (strcmp(argv[index], "--move-log") == 0 && index + 1 < argc) {
+      options.move_log_path = argv[++index];
+    } else if (strcmp(argv[index], "--move-log-sync") == 0 && index + 1 < argc) {
+      ++index;
+      options.move_log_sync_milliseconds = strcmp(argv[index], "never") == 0 ? MoveLog::SYNC_NEVER
+                                                                              : atoi(argv[index]);
+      if (options.move_log_sync_milliseconds < 0 && options.move_log_sync_milliseconds != MoveLog::SYNC_NEVER) {
+        throw std::runtime_error("Error! Move log sync interval must not be negative.");
+      }
+    } else if (strcmp(argv[index], "--snapshot-interval") == 0 && index + 1 < argc) {
+      options.snapshot_milliseconds = atoi(argv[++index]);
+      if (options.snapshot_milliseconds <= 0) {
+        throw std::runtime_error("Error! Snapshot interval must be positive.");
+      }
+    } else if (strcmp(argv[index], "--archive") == 0 && index + 1 < argc) {
+      options.archive_path = argv[++index];
+    } else if (strcmp(argv[index], "--replay") == 0 && index + 2 < argc) {
+      options.archive_path   = argv[++index];
+      options.replay_game_id = atoll(argv[++index]);
+      if (options.replay_game_id < 0 || options.replay_game_id > UINT32_MAX) {
+        throw std::runtime_error("Error! Game ID must be between 0 and 4294967295.");
+      }
+    } else if (strcmp(argv[index], "--replay-record") == 0 && index + 2 < argc) {
+      options.archive_path         = argv[++index];
+      options.replay_record_number = atoll(argv[++index]);
+      if (options.replay_record_number < 0) {
+        throw std::runtime_error("Error! Record number must not be negative.");
+      }
+    } else if (strcmp(argv[index], "--archive-scan") == 0 && index + 1 < argc) {
+      options.archive_path = argv[++index];
+      options.archive_scan = true;
+    } else if (strcmp(argv[index], "--win-benchmark") == 0 && index + 1 < argc) {
+      options.benchmark_board_count = atoi(argv[++index]);
+      if (options.benchmark_board_count <= 0) {
+        throw std::runtime_error("Error! Number of boards must be positive.");
+      }
+    } else if (strcmp(argv[index], "--encoding-benchmark") == 0 && index + 1 < argc) {
+      options.benchmark_message_count = atoi(argv[++index]);
+      if (options.benchmark_message_count <= 0) {
+        throw std::runtime_error("Error! Number of messages must be positive.");
+      }
+    } else if (strcmp(argv[index], "--mcts-benchmark") == 0 && index + 1 < argc) {
+      options.benchmark_mcts_milliseconds = atoi(argv[++index]);
+      if (options.benchmark_mcts_milliseconds <= 0) {
+        throw std::runtime_error("Error! Search time must be positive.");
+      }
+    } else {
+      throw std::runtime_error(std::string("Error! Unknown option ") + argv[index]);
+    }
+  }
+  if (options.mcts_milliseconds > 0 && options.event_loop) {
+    throw std::runtime_error("Error! Monte Carlo tree search would hold up the event loops; use --search instead.");
+  }
+  if (options.snapshot_milliseconds > 0 && !options.move_log_path) {
+    throw std::runtime_error("Error! Snapshots need a move log.");
+  }
+  if (options.archive_path && options.replay_game_id == -1 && options.replay_record_number == -1 &&
+      !options.archive_scan && !options.move_log_path) {
+    throw std::runtime_error("Error! Archiving needs a move log.");
+  }
+  
+  return options;
+}
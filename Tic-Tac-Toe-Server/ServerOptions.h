@@ -0,0 +1,93 @@
+#ifndef ServerOptions_h
+#define ServerOptions_h
+
+/* -------------------------------------------------------------------------------------
+ * STRUCT NAME: ServerOptions
+ * -------------------------------------------------------------------------------------
+ * @brief Holds the startup options of the game server.
+ *
+ * The ServerOptions struct is filled from the command line by ParseServerOptions.
+ *
+ *   --event-loop        Host one game per connection off an epoll event loop.
+ *   --shards <n>        Run n event loops on n threads, one per core (0 = every
+ *                       core). Implies --event-loop.
+ *   --io-uring          Serve the event loops off io_uring instead of epoll, falling
+ *                       back to epoll when io_uring is unavailable. Implies
+ *                       --event-loop.
+ *   --matchmaking <ms>  Pair clients into games with each other; a client nobody
+ *                       joins within ms milliseconds plays the server's side
+ *                       instead. Implies --event-loop.
+ *   --perfect-play      Play the server's side with the perfect-play table instead
+ *                       of the person at the terminal or the house player.
+ *   --search <ms>       Play the server's side with an alpha-beta search, given ms
+ *                       milliseconds per move.
+ *   --mcts <ms>         Play the server's side with a Monte Carlo tree search, given
+ *                       at most ms milliseconds per move. Only at the terminal: it
+ *                       searches on every core, so the event loops refuse it.
+ *   --mcts-threads <n>  Run the Monte Carlo tree search on n threads (0 = every
+ *                       core, the default).
+ *   --move-time <ms>    Give a client ms milliseconds for each move; a client that
+ *                       runs out of time loses the game.
+ *   --idle-timeout <ms> Close a connection nothing has been sent or received on
+ *                       for ms milliseconds.
+ *   --move-log <path>   Append every game created and retired and every move
+ *                       played to the MoveLog at path.
+ *   --move-log-sync <ms|never>
+ *                       Sync the move log at most every ms milliseconds (0, the
+ *                       default, syncs after every group commit), or never.
+ *   --snapshot-interval <ms>
+ *                       Snapshot the games of every shard every ms milliseconds, next
+ *                       to the move log. With a move log, the event loops recover
+ *                       their games from the snapshots and the log at startup.
+ *   --archive <path>    Compact the games the move log holds from start to end into
+ *                       the GameArchive at path, adding those finished since the
+ *                       archive's last compaction, and exit. Needs --move-log.
+ *   --replay <path> <id>
+ *                       Print the board after every move of the archived game with
+ *                       the game ID id, or list the records of the games with that
+ *                       ID if there are several, and exit.
+ *   --replay-record <path> <n>
+ *                       Print the board after every move of the archived game of
+ *                       record n, and exit.
+ *   --archive-scan <path>
+ *                       Print the results of every archived game, and how fast the
+ *                       archive was read, and exit.
+ *   --win-benchmark <n> Print how fast WinBatch finds the winners of n random
+ *                       boards with every instruction set, and exit.
+ *   --encoding-benchmark <n>
+ *                       Print the size of a move and a reply in every protocol, and
+ *                       how long n of each take to encode and decode, and exit.
+ *   --mcts-benchmark <ms>
+ *                       Print how many playouts per second the Monte Carlo tree
+ *                       search runs on a Gomoku board, given ms milliseconds per
+ *                       search, on 1, 2, 4, ... threads up to one per core, and exit.
+ *
+ * @note Without options, the server hosts a single game against the person at
+ *       the server's terminal.
+ * -------------------------------------------------------------------------------------
+ */
+struct ServerOptions {
+  bool event_loop;
+  int shard_count;
+  bool io_uring;
+  int matchmaking_milliseconds;     // 0 when clients only play the server's side.
+  bool perfect_play;
+  int search_milliseconds;          // 0 when the server's side is not searched.
+  int mcts_milliseconds;            // 0 when the server's side is not played by Monte Carlo tree search.
+  int mcts_thread_count;
+  int move_milliseconds;            // 0 when moves are not timed.
+  int idle_milliseconds;            // 0 when idle connections are kept.
+  const char* move_log_path;        // nullptr when moves are not logged.
+  int move_log_sync_milliseconds;   // MoveLog::SYNC_EVERY_COMMIT, MoveLog::SYNC_NEVER or a sync interval.
+  int snapshot_milliseconds;        // 0 when the games are not snapshotted.
+  const char* archive_path;         // nullptr when no archive is written or read.
+  long long replay_game_id;         // -1 when no game is replayed by its ID.
+  long long replay_record_number;   // -1 when no game is replayed by its record.
+  bool archive_scan;
+  int benchmark_board_count;        // 0 when the server is not benchmarked.
+  int benchmark_message_count;      // 0 when the encodings are not benchmarked.
+  int benchmark_mcts_milliseconds;  // 0 when the Monte Carlo tree search is not benchmarked.
+};
+
+ServerOptions ParseServerOptions(int argc, const char* argv[]);
+#endif /* ServerOptions_h */
@@ -0,0 +1,107 @@
+#include "ServerShards.h"
+#include "GameServer.h"
+#include <pthread.h>
+#include <sched.h>
+#include <iostream>
+
+/* ------------------------------------------------------------------------------------
+ * CONSTRUCTOR NAME: ServerShards
+ * ------------------------------------------------------------------------------------
+ * @brief Sets the number of shards to run and the event loop they run.
+ *
+ * @param options The server's startup options; a shard_count of 0 runs one shard per core.
+ * ------------------------------------------------------------------------------------
+ */
+ServerShards::ServerShards(const ServerOptions& options)
+    : options(options), shard_count(options.shard_count) {
+  if (this->shard_count == 0) {
+    this->shard_count = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  if (this->shard_count == 0) {
+    this->shard_count = 1;
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Run
+ * ------------------------------------------------------------------------------------
+ * @brief Recovers the shards' games, opens the move log and loads the seat key, if there
+ *        is a log, then starts every shard on its own thread and waits for them.
+ *
+ * @throws std::runtime_error if the games cannot be recovered or the move log or seat key
+ *                            cannot be opened.
+ * ------------------------------------------------------------------------------------
+ */
+void ServerShards::Run() {
+  std::cout << "Starting " << shard_count << " server shards..." << std::endl;
+  std::vector<GameStore> recovered_games(shard_count);
+  if (options.move_log_path) {
+    snapshots.reset(new GameSnapshots(options.move_log_path, shard_count));
+    GameSnapshots::Recovery recovery = snapshots->Recover(recovered_games);
+    std::cout << "Recovered " << recovery.game_count << " games from " << recovery.snapshot_row_count
+              << " snapshot rows and " << recovery.record_count << " move log records (" << recovery.log_bytes_read
+              << " bytes of the log read) in " << recovery.seconds * 1000 << " ms" << std::endl;
+    move_log.reset(new MoveLog(options.move_log_path, options.move_log_sync_milliseconds, shard_count));
+    seat_tokens.reset(new SeatTokens(options.move_log_path));
+  }
+  for (int shard_index = 0; shard_index < shard_count; ++shard_index) {
+    shards.emplace_back(RunShard, shard_index, shard_count > 1, options,
+                        move_log ? move_log->GetWriter(shard_index) : nullptr, snapshots.get(), seat_tokens.get(),
+                        &recovered_games[shard_index]);
+  }
+  for (std::thread& shard : shards) {
+    shard.join();
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: RunShard
+ * ------------------------------------------------------------------------------------
+ * @brief Pins the calling thread to a core and runs a GameServer event loop on it.
+ *
+ * @param shard_index     The index of the shard, used to pick its core.
+ * @param is_port_shared  True if more than one shard binds the port.
+ * @param options         The server's startup options: the event loop to run, its matchmaking,
+ *                        its time limits and its snapshot interval.
+ * @param move_log        The shard's writer of the move log, or nullptr.
+ * @param snapshots       The writer of the shards' snapshots, or nullptr.
+ * @param seat_tokens     The issuer of the players' seat tokens, or nullptr.
+ * @param recovered_games The games the shard starts with.
+ *
+ * @note A shard that fails to start reports the error and stops; the other shards
+ *       keep serving the port.
+ * ------------------------------------------------------------------------------------
+ */
+void ServerShards::RunShard(int shard_index, bool is_port_shared, ServerOptions options, MoveLog::Writer* move_log,
+                            GameSnapshots* snapshots, const SeatTokens* seat_tokens, GameStore* recovered_games) {
+  int core_count = static_cast<int>(std::thread::hardware_concurrency());
+  if (core_count > 0) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(shard_index % core_count, &cpu_set);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+  }
+  try {
+    GameServer game_server(is_port_shared);
+    if (options.matchmaking_milliseconds > 0) {
+      game_server.EnableMatchmaking(std::chrono::milliseconds(options.matchmaking_milliseconds));
+    }
+    game_server.EnableTimeouts(std::chrono::milliseconds(options.move_milliseconds),
+                               std::chrono::milliseconds(options.idle_milliseconds));
+    game_server.RecoverGames(*recovered_games);
+    game_server.EnableMoveLog(move_log);
+    if (seat_tokens) {
+      game_server.EnableRejoin(seat_tokens, shard_index);
+    }
+    if (snapshots && options.snapshot_milliseconds > 0) {
+      game_server.EnableSnapshots(snapshots, shard_index, std::chrono::milliseconds(options.snapshot_milliseconds));
+    }
+    if (options.io_uring) {
+      game_server.StartUringLoop();
+    } else {
+      game_server.StartEventLoop();
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Shard " << shard_index << ": " << e.what() << std::endl;
+  }
+}
@@ -0,0 +1,44 @@
+#ifndef ServerShards_h
+#define ServerShards_h
+#include "GameSnapshots.h"
+#include "MoveLog.h"
+#include "SeatTokens.h"
+#include "ServerOptions.h"
+#include <memory>
+#include <thread>
+#include <vector>
+
+/* -------------------------------------------------------------------------------------
+ * CLASS NAME: ServerShards
+ * -------------------------------------------------------------------------------------
+ * @brief Runs one GameServer event loop per core, sharing nothing between them.
+ *
+ * Every shard is a thread pinned to its own core that owns a GameServer: its own
+ * listening socket (bound to the same port through SO_REUSEPORT when there is more
+ * than one shard), its own epoll instance and its own table of sessions. The kernel
+ * spreads incoming connections over the listening sockets, and a game stays on the
+ * shard that accepted it for its whole life, so MakeMove and the send path never take
+ * a lock. Each shard runs either the epoll or the io_uring event loop. With a move
+ * log, every shard appends to it through its own MoveLog::Writer, and starts with the
+ * games it held when the server last stopped, recovered by GameSnapshots from its
+ * snapshot and the log; the time the recovery took is reported. The players of those
+ * games take their seats back with the seat tokens every shard issues under the one
+ * key kept next to the log.
+ * -------------------------------------------------------------------------------------
+ */
+class ServerShards {
+  public:
+    explicit ServerShards(const ServerOptions& options);
+    void Run();
+  
+  private:
+    ServerOptions options;
+    int shard_count;
+    std::vector<std::thread> shards;
+    std::unique_ptr<MoveLog> move_log;
+    std::unique_ptr<GameSnapshots> snapshots;
+    std::unique_ptr<SeatTokens> seat_tokens;
+    static void RunShard(int shard_index, bool is_port_shared, ServerOptions options, MoveLog::Writer* move_log,
+                         GameSnapshots* snapshots, const SeatTokens* seat_tokens, GameStore* recovered_games);
+};
+#endif /* ServerShards_h */
@@ -0,0 +1,63 @@
+#ifndef Session_h
+#define Session_h
+#include "GameStore.h"
+#include "TimerWheel.h"
+#include "UpdateQueue.h"
+#include "WireProtocol.h"
+#include <string>
+
+/* -------------------------------------------------------------------------------------
+ * STRUCT NAME: Session
+ * -------------------------------------------------------------------------------------
+ * @brief Holds the state of one client connection hosted by the event loop.
+ *
+ * The Session struct is used to keep each client's game independent from every other
+ * game on the server. It holds the client socket, the ID of the client's own game in
+ * the server's GameStore (GameStore::NO_GAME until the game starts), the move counter of
+ * that game, and the bytes that are waiting to be parsed (inbound) or sent (outbound) on
+ * the non-blocking socket. protocol is the protocol the client named in its hello;
+ * is_greeted is set once the hello has been received.
+ *
+ * With matchmaking, is_waiting is set while the client waits in the MatchQueue, and
+ * in a recovered game while the client waits for its opponent to rejoin. A
+ * client paired with another client plays letter ('X' or 'O') against the session of
+ * opponent_socket, both sessions holding the same game ID; against the house player,
+ * letter is 'O' and opponent_socket is -1.
+ *
+ * A spectator's session has is_spectator set and game_id naming the game it watches,
+ * which it does not own. The board updates of that game are queued in updates, shared
+ * with every other spectator, instead of being copied into outbound.
+ *
+ * move_timer is the client's move clock, running while the server waits for its move,
+ * and idle_timer evicts it once nothing has been sent or received for a while; both
+ * are TimerWheel::NO_TIMER when they are not running.
+ *
+ * With the io_uring backend, sending holds the bytes of the send request that is in
+ * flight, and recv_armed/send_in_flight track the requests the kernel still owns.
+ *
+ * @note is_closing is set when the game is over; the session is closed as soon as
+ *       the outbound bytes are sent. is_closed is set once the socket is shut down.
+ * -------------------------------------------------------------------------------------
+ */
+struct Session {
+  int client_socket;
+  GameStore::GameId game_id;
+  int move_counter;
+  char letter;
+  int opponent_socket;
+  bool is_waiting;
+  bool is_spectator;
+  TimerWheel::TimerId move_timer;
+  TimerWheel::TimerId idle_timer;
+  WireProtocol::Protocol protocol;
+  bool is_greeted;
+  bool is_closing;
+  bool is_closed;
+  bool recv_armed;
+  bool send_in_flight;
+  std::string inbound;
+  std::string outbound;
+  std::string sending;
+  UpdateQueue updates;
+};
+#endif /* Session_h */
@@ -1,6 +1,20 @@
 #ifndef Status_h
 #define Status_h
-#include <iostream>
+#include <cstdint>
+
+/* -------------------------------------------------------------------------------------
+ * ENUM NAME: StatusCode
+ * -------------------------------------------------------------------------------------
+ * @brief The outcome of a move: the game goes on, the mover won, the board filled up
+ *        without a winner, or the spot was not available.
+ * -------------------------------------------------------------------------------------
+ */
+enum class StatusCode : uint8_t {
+  UPDATE,
+  WIN,
+  TIE,
+  ERROR
+};
 
 /* -------------------------------------------------------------------------------------
  * STRUCT NAME: Status
@@ -9,11 +23,13 @@
  *
  * The Status struct is used to keep track of the status of the game, including
  * the status code, current state of the game board, and the player symbol ('X' or 'O').
+ * The game board is kept packed (see Game::PackBoard), the layout the replies carry,
+ * so that reporting a move does not build a string.
  * -------------------------------------------------------------------------------------
  */
 struct Status {
-  std::string status_code;
-  std::string game_board;
+  StatusCode status_code;
+  uint32_t packed_board;
   char letter;
 };
 #endif /* Status_h */
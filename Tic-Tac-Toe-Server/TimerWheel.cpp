@@ -0,0 +1,252 @@
+#include "TimerWheel.h"
+#include <algorithm>
+#include <stdexcept>
+
+constexpr TimerWheel::TimerId TimerWheel::NO_TIMER;
+constexpr uint32_t TimerWheel::NO_INDEX;
+
+TimerWheel::TimerWheel(Clock::time_point start)
+    : start(start), current_tick(0), free_timer(NO_INDEX), timer_count(0), occupied() {
+  std::fill(heads, heads + EXPIRED_LIST + 1, NO_INDEX);
+}
+
+/* The first tick at or after a time point, so that no timer expires early. */
+uint64_t TimerWheel::TickOf(Clock::time_point time) const {
+  if (time <= start) {
+    return 0;
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(time - start).count();
+  return static_cast<uint64_t>((elapsed + 999999) / 1000000);
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Schedule
+ * ------------------------------------------------------------------------------------
+ * @brief Starts a timer.
+ *
+ * @param deadline The time the timer expires at; a time already passed expires it on
+ *                 the next PopExpired.
+ * @param payload  What PopExpired hands back for the timer.
+ *
+ * @throws std::runtime_error if the wheel already holds 2^24 - 1 timers.
+ *
+ * @return The ID that cancels the timer.
+ * ------------------------------------------------------------------------------------
+ */
+TimerWheel::TimerId TimerWheel::Schedule(Clock::time_point deadline, uint64_t payload) {
+  uint32_t index = free_timer;
+  if (index != NO_INDEX) {
+    free_timer = timers[index].next;
+  } else {
+    if (timers.size() >= NO_INDEX) {
+      throw std::runtime_error("Error! Too many timers.");
+    }
+    index = static_cast<uint32_t>(timers.size());
+    Timer timer = {};
+    timers.push_back(timer);
+  }
+  Timer& timer  = timers[index];
+  timer.tick    = TickOf(deadline);
+  timer.payload = payload;
+  Insert(index);
+  ++timer_count;
+
+  return (static_cast<uint32_t>(timer.generation) << INDEX_BITS) | index;
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Cancel
+ * ------------------------------------------------------------------------------------
+ * @brief Stops a timer. A timer that has expired, or NO_TIMER, is left alone.
+ * ------------------------------------------------------------------------------------
+ */
+void TimerWheel::Cancel(TimerId timer_id) {
+  uint32_t index = timer_id & INDEX_MASK;
+  if (index >= timers.size() || timers[index].list == NO_LIST ||
+      timers[index].generation != static_cast<uint8_t>(timer_id >> INDEX_BITS)) {
+    return;
+  }
+  Unlink(index);
+  Timer& timer = timers[index];
+  timer.list   = NO_LIST;
+  ++timer.generation;
+  timer.next   = free_timer;
+  free_timer   = index;
+  --timer_count;
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: PopExpired
+ * ------------------------------------------------------------------------------------
+ * @brief Takes the next timer that has expired by now off the wheel.
+ *
+ * @return True, with the timer's payload, if a timer has expired.
+ * ------------------------------------------------------------------------------------
+ */
+bool TimerWheel::PopExpired(Clock::time_point now, uint64_t& payload) {
+  if (heads[EXPIRED_LIST] == NO_INDEX) {
+    Advance(now);
+    if (heads[EXPIRED_LIST] == NO_INDEX) {
+      return false;
+    }
+  }
+  uint32_t index = heads[EXPIRED_LIST];
+  payload = timers[index].payload;
+  Cancel((static_cast<uint32_t>(timers[index].generation) << INDEX_BITS) | index);
+
+  return true;
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: MillisecondsToNextTimer
+ * ------------------------------------------------------------------------------------
+ * @brief The time until the next timer may expire, rounded up, as an epoll_wait timeout.
+ *
+ * @details Exact for a timer due within the current turn of level 0; for later timers
+ *          it is the time to the end of that turn, when the next level is cascaded.
+ *
+ * @return The milliseconds to wait, or -1 when the wheel holds no timer.
+ * ------------------------------------------------------------------------------------
+ */
+int TimerWheel::MillisecondsToNextTimer(Clock::time_point now) const {
+  if (timer_count == 0) {
+    return -1;
+  }
+  if (heads[EXPIRED_LIST] != NO_INDEX) {
+    return 0;
+  }
+  const int current_slot = static_cast<int>(current_tick & (SLOT_COUNT - 1));
+  uint64_t next_tick = current_tick + (SLOT_COUNT - current_slot);  // The next cascade.
+  int slot = NextOccupiedSlot(current_slot + 1);
+  if (slot != -1) {
+    next_tick = current_tick + (slot - current_slot);
+  }
+  Clock::time_point due = start + std::chrono::milliseconds(next_tick);
+  if (due <= now) {
+    return 0;
+  }
+  return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(due - now).count()) + 1;
+}
+
+/* Puts a timer on the list its tick belongs to, counted from the current tick. */
+void TimerWheel::Insert(uint32_t index) {
+  uint64_t tick = timers[index].tick;
+  if (tick <= current_tick) {
+    Link(index, EXPIRED_LIST);
+    return;
+  }
+  uint64_t delta = tick - current_tick;
+  int level = 0;
+  while (level < LEVEL_COUNT - 1 && delta >= (1ull << (SLOT_BITS * (level + 1)))) {
+    ++level;
+  }
+  if (delta >= (1ull << (SLOT_BITS * LEVEL_COUNT))) {
+    tick = current_tick + (1ull << (SLOT_BITS * LEVEL_COUNT)) - 1;
+    timers[index].tick = tick;
+  }
+  int slot = static_cast<int>((tick >> (SLOT_BITS * level)) & (SLOT_COUNT - 1));
+  Link(index, level * SLOT_COUNT + slot);
+}
+
+void TimerWheel::Link(uint32_t index, int list) {
+  Timer& timer   = timers[index];
+  timer.list     = static_cast<uint16_t>(list);
+  timer.previous = NO_INDEX;
+  timer.next     = heads[list];
+  if (timer.next != NO_INDEX) {
+    timers[timer.next].previous = index;
+  }
+  heads[list] = index;
+  if (list != EXPIRED_LIST) {
+    occupied[list / SLOT_COUNT][(list % SLOT_COUNT) / 64] |= 1ull << (list % 64);
+  }
+}
+
+void TimerWheel::Unlink(uint32_t index) {
+  Timer& timer = timers[index];
+  if (timer.previous != NO_INDEX) {
+    timers[timer.previous].next = timer.next;
+  } else {
+    heads[timer.list] = timer.next;
+  }
+  if (timer.next != NO_INDEX) {
+    timers[timer.next].previous = timer.previous;
+  }
+  if (heads[timer.list] == NO_INDEX && timer.list != EXPIRED_LIST) {
+    occupied[timer.list / SLOT_COUNT][(timer.list % SLOT_COUNT) / 64] &= ~(1ull << (timer.list % 64));
+  }
+}
+
+/* Moves the timers of a level's current slot down to the levels below. */
+void TimerWheel::Cascade(int level) {
+  int list = level * SLOT_COUNT + static_cast<int>((current_tick >> (SLOT_BITS * level)) & (SLOT_COUNT - 1));
+  uint32_t index = heads[list];
+  heads[list] = NO_INDEX;
+  occupied[level][(list % SLOT_COUNT) / 64] &= ~(1ull << (list % 64));
+  while (index != NO_INDEX) {
+    uint32_t next = timers[index].next;
+    Insert(index);
+    index = next;
+  }
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Advance
+ * ------------------------------------------------------------------------------------
+ * @brief Turns the wheel tick by tick up to now, moving the timers due onto the expired
+ *        list. A stretch of level 0 without timers is crossed in one step.
+ * ------------------------------------------------------------------------------------
+ */
+void TimerWheel::Advance(Clock::time_point now) {
+  if (now <= start) {
+    return;
+  }
+  // Only ticks that have fully passed; Schedule rounds deadlines up, so no timer fires early.
+  uint64_t target_tick = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count());
+  if (timer_count == 0) {
+    current_tick = std::max(current_tick, target_tick);
+    return;
+  }
+  while (current_tick < target_tick) {
+    int current_slot = static_cast<int>(current_tick & (SLOT_COUNT - 1));
+    if (NextOccupiedSlot(current_slot + 1) == -1) {
+      // Nothing on level 0 until it wraps around: go straight to the end of the turn.
+      uint64_t turn_end = current_tick + (SLOT_COUNT - 1 - current_slot);
+      if (turn_end >= target_tick) {
+        current_tick = target_tick;
+        break;
+      }
+      current_tick = turn_end;
+    }
+    ++current_tick;
+    for (int level = 1; level < LEVEL_COUNT; ++level) {
+      if ((current_tick & ((1ull << (SLOT_BITS * level)) - 1)) != 0) {
+        break;
+      }
+      Cascade(level);
+    }
+    int list = static_cast<int>(current_tick & (SLOT_COUNT - 1));
+    uint32_t index = heads[list];
+    heads[list] = NO_INDEX;
+    occupied[0][list / 64] &= ~(1ull << (list % 64));
+    while (index != NO_INDEX) {
+      uint32_t next = timers[index].next;
+      Link(index, EXPIRED_LIST);
+      index = next;
+    }
+  }
+}
+
+/* The first occupied level 0 slot from a slot to the end of the turn, or -1. */
+int TimerWheel::NextOccupiedSlot(int from) const {
+  for (int word = from / 64; word < WORD_COUNT; ++word) {
+    uint64_t bits = occupied[0][word];
+    if (word == from / 64) {
+      bits &= ~0ull << (from % 64);
+    }
+    if (bits != 0) {
+      return word * 64 + __builtin_ctzll(bits);
+    }
+  }
+  return -1;
+}
@@ -0,0 +1,78 @@
+#ifndef TimerWheel_h
+#define TimerWheel_h
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+/* -------------------------------------------------------------------------------------
+ * CLASS NAME: TimerWheel
+ * -------------------------------------------------------------------------------------
+ * @brief Keeps the timers of one event loop, such as move clocks and idle timeouts, on a
+ *        hierarchical timing wheel of 1 ms ticks.
+ *
+ * The wheel has LEVEL_COUNT levels of SLOT_COUNT slots. A timer due within 256 ticks sits
+ * in the level 0 slot of its tick; one due later sits in the slot of a higher level that
+ * covers its tick, and is moved down a level each time the level below wraps around.
+ * Every slot is an intrusive doubly linked list of timers, so scheduling and cancelling
+ * a timer are O(1) whatever the number of timers, and each timer is moved at most
+ * LEVEL_COUNT - 1 times before it expires. The four levels reach 2^32 ticks (about 49
+ * days) ahead; later deadlines are clamped to that.
+ *
+ * Timers live in one array that grows to the loop's busiest moment and is reused through
+ * a free list. A timer ID is the timer's index under a generation, as a GameStore game
+ * ID: cancelling a timer that has already expired, or whose slot was reused, does nothing.
+ *
+ * The wheel belongs to one shard's event loop, which calls PopExpired when it wakes up and
+ * sleeps for MillisecondsToNextTimer; it needs no lock.
+ * -------------------------------------------------------------------------------------
+ */
+class TimerWheel {
+  public:
+    typedef std::chrono::steady_clock Clock;
+    typedef uint32_t TimerId;
+    static constexpr TimerId NO_TIMER = 0xffffffffu;
+
+    explicit TimerWheel(Clock::time_point start);
+    TimerId Schedule(Clock::time_point deadline, uint64_t payload);
+    void Cancel(TimerId timer_id);
+    bool PopExpired(Clock::time_point now, uint64_t& payload);
+    int MillisecondsToNextTimer(Clock::time_point now) const;
+    uint32_t GetCount() const { return timer_count; }
+
+  private:
+    static constexpr int LEVEL_COUNT      = 4;
+    static constexpr int SLOT_BITS        = 8;
+    static constexpr int SLOT_COUNT       = 1 << SLOT_BITS;
+    static constexpr int WORD_COUNT       = SLOT_COUNT / 64;
+    static constexpr int EXPIRED_LIST     = LEVEL_COUNT * SLOT_COUNT;  // The list after every slot.
+    static constexpr int INDEX_BITS       = 24;
+    static constexpr uint32_t INDEX_MASK  = (1u << INDEX_BITS) - 1;
+    static constexpr uint32_t NO_INDEX    = INDEX_MASK;  // Also keeps NO_TIMER from being a timer's ID.
+    static constexpr uint16_t NO_LIST     = 0xffff;
+
+    struct Timer {
+      uint64_t tick;       // The tick the timer expires on.
+      uint64_t payload;
+      uint32_t next;       // The next timer of its list, or the next free timer.
+      uint32_t previous;
+      uint16_t list;       // Its slot (level * SLOT_COUNT + slot), EXPIRED_LIST, or NO_LIST while free.
+      uint8_t generation;
+    };
+
+    Clock::time_point start;
+    uint64_t current_tick;  // Every tick up to this one has been expired.
+    std::vector<Timer> timers;
+    uint32_t free_timer;
+    uint32_t timer_count;
+    uint32_t heads[EXPIRED_LIST + 1];
+    uint64_t occupied[LEVEL_COUNT][WORD_COUNT];  // A bit per slot that holds a timer.
+
+    uint64_t TickOf(Clock::time_point time) const;
+    void Insert(uint32_t index);
+    void Link(uint32_t index, int list);
+    void Unlink(uint32_t index);
+    void Cascade(int level);
+    void Advance(Clock::time_point now);
+    int NextOccupiedSlot(int from) const;
+};
+#endif /* TimerWheel_h */
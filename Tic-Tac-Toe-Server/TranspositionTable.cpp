@@ -0,0 +1,68 @@
+#include "TranspositionTable.h"
+#include <stdexcept>
+
+/* ------------------------------------------------------------------------------------
+ * CONSTRUCTOR NAME: TranspositionTable
+ * ------------------------------------------------------------------------------------
+ * @brief Allocates 2^size_bits empty slots of 16 bytes.
+ *
+ * @throws std::runtime_error if the size is out of range.
+ * ------------------------------------------------------------------------------------
+ */
+TranspositionTable::TranspositionTable(int size_bits) {
+  if (size_bits < 1 || size_bits > 30) {
+    throw std::runtime_error("Error! Transposition table size out of range.");
+  }
+  slots.reset(new Slot[size_t(1) << size_bits]);
+  slot_mask = (uint64_t(1) << size_bits) - 1;
+  Clear();
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Probe
+ * ------------------------------------------------------------------------------------
+ * @brief Looks a position up.
+ *
+ * @details An empty slot unpacks as depth 0 with no best move, which a search never
+ *          trusts, so the empty board's hash of 0 matching an empty slot is harmless.
+ *
+ * @return True, with the entry filled in, if the position's slot holds it.
+ * ------------------------------------------------------------------------------------
+ */
+bool TranspositionTable::Probe(uint64_t key, Entry& entry) const {
+  const Slot& slot = slots[key & slot_mask];
+  uint64_t data  = slot.data.load(std::memory_order_relaxed);
+  uint64_t check = slot.check.load(std::memory_order_relaxed);
+  if ((check ^ data) != key) {
+    return false;
+  }
+  entry.score     = static_cast<int32_t>(static_cast<uint32_t>(data));
+  entry.depth     = static_cast<int>((data >> 32) & 0xff);
+  entry.bound     = static_cast<Bound>((data >> 40) & 0x3);
+  entry.best_spot = static_cast<int>((data >> 48) & 0xffff) - 1;
+  return true;
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Store
+ * ------------------------------------------------------------------------------------
+ * @brief Packs an entry (32-bit score, 8-bit depth, 2-bit bound, 16-bit best spot + 1)
+ *        into the position's slot, over whatever was there.
+ * ------------------------------------------------------------------------------------
+ */
+void TranspositionTable::Store(uint64_t key, const Entry& entry) {
+  uint64_t data = static_cast<uint32_t>(entry.score) |
+                  (static_cast<uint64_t>(entry.depth & 0xff) << 32) |
+                  (static_cast<uint64_t>(entry.bound & 0x3) << 40) |
+                  (static_cast<uint64_t>((entry.best_spot + 1) & 0xffff) << 48);
+  Slot& slot = slots[key & slot_mask];
+  slot.data.store(data, std::memory_order_relaxed);
+  slot.check.store(key ^ data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::Clear() {
+  for (uint64_t index = 0; index <= slot_mask; ++index) {
+    slots[index].data.store(0, std::memory_order_relaxed);
+    slots[index].check.store(0, std::memory_order_relaxed);
+  }
+}
@@ -0,0 +1,44 @@
+#ifndef TranspositionTable_h
+#define TranspositionTable_h
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/* -------------------------------------------------------------------------------------
+ * CLASS NAME: TranspositionTable
+ * -------------------------------------------------------------------------------------
+ * @brief A fixed-size cache of searched positions, keyed by a game's Zobrist hash and
+ *        shared without locks by every thread that searches.
+ *
+ * Each slot holds two 64-bit words: the packed result, and the key XOR-ed with it. A
+ * slot is valid when the two words XOR back to the key being probed, so a slot torn by
+ * two threads writing at once reads as a miss instead of as a wrong result, and no
+ * lock or compare-and-swap is needed. Slots are always replaced; the table never grows.
+ * -------------------------------------------------------------------------------------
+ */
+class TranspositionTable {
+  public:
+    enum Bound : uint8_t { EXACT, LOWER, UPPER };  // The score is exact, at least or at most.
+
+    struct Entry {
+      int score;
+      int depth;
+      Bound bound;
+      int best_spot;  // -1 when the position has no best move yet.
+    };
+
+    explicit TranspositionTable(int size_bits);
+    bool Probe(uint64_t key, Entry& entry) const;
+    void Store(uint64_t key, const Entry& entry);
+    void Clear();
+
+  private:
+    struct Slot {
+      std::atomic<uint64_t> check;  // key ^ data
+      std::atomic<uint64_t> data;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    uint64_t slot_mask;
+};
+#endif /* TranspositionTable_h */
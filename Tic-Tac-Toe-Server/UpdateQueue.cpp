@@ -0,0 +1,63 @@
+#include "UpdateQueue.h"
+#include <cstring>
+
+UpdateQueue::UpdateQueue() : sent_bytes(0), dropped_count(0) {
+  memset(&message, 0, sizeof(message));
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: Push
+ * ------------------------------------------------------------------------------------
+ * @brief Queues an update, dropping the pending ones for it when too many wait.
+ * ------------------------------------------------------------------------------------
+ */
+void UpdateQueue::Push(const Update& update) {
+  if (pending.size() >= MAXIMUM_PENDING) {
+    dropped_count += pending.size();
+    pending.clear();
+  }
+  pending.push_back(update);
+}
+
+/* ------------------------------------------------------------------------------------
+ * FUNCTION NAME: PrepareWrite
+ * ------------------------------------------------------------------------------------
+ * @brief Hands the pending updates over to the kernel, if none are in flight, and points
+ *        the message's iovecs at the bytes still to send.
+ *
+ * @return True if there is something to send, false otherwise.
+ * ------------------------------------------------------------------------------------
+ */
+bool UpdateQueue::PrepareWrite() {
+  if (in_flight.empty()) {
+    in_flight.swap(pending);
+    sent_bytes = 0;
+  }
+  int iovec_count = 0;
+  for (const Update& update : in_flight) {
+    if (iovec_count == MAXIMUM_IOVECS) {
+      break;
+    }
+    size_t skipped = iovec_count == 0 ? sent_bytes : 0;
+    iovecs[iovec_count].iov_base = const_cast<char*>(update->data()) + skipped;
+    iovecs[iovec_count].iov_len  = update->size() - skipped;
+    ++iovec_count;
+  }
+  message.msg_iov    = iovecs;
+  message.msg_iovlen = iovec_count;
+  return iovec_count > 0;
+}
+
+/* Drops the in-flight updates, and the part of one, that a write has sent. */
+void UpdateQueue::Consume(size_t byte_count) {
+  while (byte_count > 0 && !in_flight.empty()) {
+    size_t left = in_flight.front()->size() - sent_bytes;
+    if (byte_count < left) {
+      sent_bytes += byte_count;
+      return;
+    }
+    byte_count -= left;
+    sent_bytes  = 0;
+    in_flight.pop_front();
+  }
+}
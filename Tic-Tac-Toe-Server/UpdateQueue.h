@@ -0,0 +1,53 @@
+#ifndef UpdateQueue_h
+#define UpdateQueue_h
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+
+/* -------------------------------------------------------------------------------------
+ * CLASS NAME: UpdateQueue
+ * -------------------------------------------------------------------------------------
+ * @brief The board updates waiting to be sent to one spectator.
+ *
+ * An update is a complete reply frame, encoded once for every spectator of the game
+ * that uses its protocol and shared by all of them: the queue holds a reference to it,
+ * never a copy. The queued updates are sent with one scatter-gather write (sendmsg, or
+ * IORING_OP_SENDMSG) straight out of the shared buffers.
+ *
+ * Every update carries the whole board, so a spectator that has fallen behind only
+ * needs the newest one. Once more than MAXIMUM_PENDING updates wait, the ones not yet
+ * handed to the kernel are dropped for the newest, and a slow spectator costs a bounded
+ * amount of memory instead of holding back the game.
+ *
+ * @note Updates handed to the kernel (in flight) are never dropped, so frames are never
+ *       cut short; Consume tells the queue how many of their bytes went out.
+ * -------------------------------------------------------------------------------------
+ */
+class UpdateQueue {
+  public:
+    typedef std::shared_ptr<const std::string> Update;
+
+    static const size_t MAXIMUM_PENDING = 4;
+    static const int MAXIMUM_IOVECS     = 8;
+
+    UpdateQueue();
+    void Push(const Update& update);
+    bool PrepareWrite();
+    const struct msghdr* GetMessage() const { return &message; }
+    void Consume(size_t byte_count);
+    bool IsEmpty() const { return pending.empty() && in_flight.empty(); }
+    uint64_t GetDroppedCount() const { return dropped_count; }
+
+  private:
+    std::deque<Update> pending;
+    std::deque<Update> in_flight;
+    size_t sent_bytes;  // The bytes of the first in-flight update already sent.
+    uint64_t dropped_count;
+    struct iovec iovecs[MAXIMUM_IOVECS];
+    struct msghdr message;  // Points at iovecs; stays put while the kernel owns it.
+};
+#endif /* UpdateQueue_h */
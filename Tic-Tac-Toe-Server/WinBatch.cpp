@@ -0,0 +1,231 @@
+#include "WinBatch.h"
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define WIN_BATCH_X86 1
+#endif
+
+namespace WinBatch {
+  namespace {
+    typedef WinLines<3, 3, 3> Lines;
+    static_assert(sizeof(Lines::Mask) == sizeof(uint16_t), "A 3x3 mask fits 16 bits.");
+
+    /* Game::IsWinner for both letters, one board at a time. */
+    void FindWinnersScalar(const uint16_t* x_masks, const uint16_t* o_masks, size_t count, uint8_t* winners) {
+      for (size_t board = 0; board < count; ++board) {
+        bool is_x_winner = false;
+        bool is_o_winner = false;
+        for (int line = 0; line < Lines::LINE_COUNT; ++line) {
+          const uint16_t mask = Lines::TABLE.lines[line];
+          is_x_winner |= (x_masks[board] & mask) == mask;
+          is_o_winner |= (o_masks[board] & mask) == mask;
+        }
+        winners[board] = static_cast<uint8_t>(is_x_winner * X_WON | is_o_winner * O_WON);
+      }
+    }
+
+#ifdef WIN_BATCH_X86
+    /* ------------------------------------------------------------------------------------
+     * FUNCTION NAME: FindWinnersSse2
+     * ------------------------------------------------------------------------------------
+     * @brief Tests 8 boards per step: every line is ANDed with 8 masks and compared with
+     *        itself, and the 16-bit results are packed down to one winners byte per board.
+     *
+     * @return The number of boards done, a multiple of 8; the rest is left to the caller.
+     * ------------------------------------------------------------------------------------
+     */
+    size_t FindWinnersSse2(const uint16_t* x_masks, const uint16_t* o_masks, size_t count, uint8_t* winners) {
+      const __m128i x_won = _mm_set1_epi16(X_WON);
+      const __m128i o_won = _mm_set1_epi16(O_WON);
+      size_t board = 0;
+      for (; board + 8 <= count; board += 8) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x_masks + board));
+        const __m128i o = _mm_loadu_si128(reinterpret_cast<const __m128i*>(o_masks + board));
+        __m128i is_x_winner = _mm_setzero_si128();
+        __m128i is_o_winner = _mm_setzero_si128();
+        for (int line = 0; line < Lines::LINE_COUNT; ++line) {
+          const __m128i mask = _mm_set1_epi16(static_cast<short>(Lines::TABLE.lines[line]));
+          is_x_winner = _mm_or_si128(is_x_winner, _mm_cmpeq_epi16(_mm_and_si128(x, mask), mask));
+          is_o_winner = _mm_or_si128(is_o_winner, _mm_cmpeq_epi16(_mm_and_si128(o, mask), mask));
+        }
+        const __m128i result = _mm_or_si128(_mm_and_si128(is_x_winner, x_won), _mm_and_si128(is_o_winner, o_won));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(winners + board), _mm_packus_epi16(result, result));
+      }
+      return board;
+    }
+
+    /* The winners of 16 boards, one per 16-bit lane. */
+    __attribute__((target("avx2")))
+    inline __m256i WinnersAvx2(const uint16_t* x_masks, const uint16_t* o_masks) {
+      const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x_masks));
+      const __m256i o = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(o_masks));
+      __m256i is_x_winner = _mm256_setzero_si256();
+      __m256i is_o_winner = _mm256_setzero_si256();
+      for (int line = 0; line < Lines::LINE_COUNT; ++line) {
+        const __m256i mask = _mm256_set1_epi16(static_cast<short>(Lines::TABLE.lines[line]));
+        is_x_winner = _mm256_or_si256(is_x_winner, _mm256_cmpeq_epi16(_mm256_and_si256(x, mask), mask));
+        is_o_winner = _mm256_or_si256(is_o_winner, _mm256_cmpeq_epi16(_mm256_and_si256(o, mask), mask));
+      }
+      return _mm256_or_si256(_mm256_and_si256(is_x_winner, _mm256_set1_epi16(X_WON)),
+                             _mm256_and_si256(is_o_winner, _mm256_set1_epi16(O_WON)));
+    }
+
+    /* ------------------------------------------------------------------------------------
+     * FUNCTION NAME: FindWinnersAvx2
+     * ------------------------------------------------------------------------------------
+     * @brief Tests 32 boards per step, as two vectors of 16, whose results pack into one
+     *        32-byte store.
+     *
+     * @details _mm256_packus_epi16 packs within 128-bit halves, leaving the boards in the
+     *          order 0-7, 16-23, 8-15, 24-31; one permute of 64-bit quarters restores it.
+     *
+     * @return The number of boards done, a multiple of 32; the rest is left to the caller.
+     * ------------------------------------------------------------------------------------
+     */
+    __attribute__((target("avx2")))
+    size_t FindWinnersAvx2(const uint16_t* x_masks, const uint16_t* o_masks, size_t count, uint8_t* winners) {
+      size_t board = 0;
+      for (; board + 32 <= count; board += 32) {
+        const __m256i low  = WinnersAvx2(x_masks + board, o_masks + board);
+        const __m256i high = WinnersAvx2(x_masks + board + 16, o_masks + board + 16);
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xd8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(winners + board), packed);
+      }
+      return board;
+    }
+#endif
+
+    /* xorshift64*, for the benchmark's boards. */
+    uint64_t Next(uint64_t& random) {
+      random ^= random >> 12;
+      random ^= random << 25;
+      random ^= random >> 27;
+      return random * 0x2545f4914f6cdd1dull;
+    }
+  }
+
+  InstructionSet BestInstructionSet() {
+#ifdef WIN_BATCH_X86
+    static const InstructionSet best = __builtin_cpu_supports("avx2") ? AVX2
+                                     : __builtin_cpu_supports("sse2") ? SSE2 : SCALAR;
+    return best;
+#else
+    return SCALAR;
+#endif
+  }
+
+  const char* InstructionSetName(InstructionSet instruction_set) {
+    switch (instruction_set) {
+      case AVX2:
+        return "AVX2";
+      case SSE2:
+        return "SSE2";
+      default:
+        return "scalar";
+    }
+  }
+
+  /* ------------------------------------------------------------------------------------
+   * FUNCTION NAME: FindWinners
+   * ------------------------------------------------------------------------------------
+   * @brief Finds the winners of a block of boards with the best instruction set the CPU
+   *        has.
+   *
+   * @param x_masks The X mask of every board.
+   * @param o_masks The O mask of every board.
+   * @param count   The number of boards.
+   * @param winners [out] X_WON, O_WON, both or neither, for every board.
+   * ------------------------------------------------------------------------------------
+   */
+  void FindWinners(const uint16_t* x_masks, const uint16_t* o_masks, size_t count, uint8_t* winners) {
+    FindWinners(x_masks, o_masks, count, winners, BestInstructionSet());
+  }
+
+  /* ------------------------------------------------------------------------------------
+   * FUNCTION NAME: FindWinners
+   * ------------------------------------------------------------------------------------
+   * @brief Finds the winners of a block of boards with a given instruction set.
+   *
+   * @throws std::runtime_error if the CPU does not have the instruction set.
+   * ------------------------------------------------------------------------------------
+   */
+  void FindWinners(const uint16_t* x_masks, const uint16_t* o_masks, size_t count, uint8_t* winners,
+                   InstructionSet instruction_set) {
+    if (instruction_set > BestInstructionSet()) {
+      throw std::runtime_error(std::string("Error! The CPU does not support ") +
+                               InstructionSetName(instruction_set) + ".");
+    }
+    size_t done = 0;
+#ifdef WIN_BATCH_X86
+    if (instruction_set == AVX2) {
+      done = FindWinnersAvx2(x_masks, o_masks, count, winners);
+    }
+    if (instruction_set >= SSE2) {
+      done += FindWinnersSse2(x_masks + done, o_masks + done, count - done, winners + done);
+    }
+#endif
+    FindWinnersScalar(x_masks + done, o_masks + done, count - done, winners + done);
+  }
+
+  void FindWinners(const BoardBlock& block, std::vector<uint8_t>& winners) {
+    winners.resize(block.Size());
+    FindWinners(block.x_masks.data(), block.o_masks.data(), block.Size(), winners.data());
+  }
+
+  /* ------------------------------------------------------------------------------------
+   * FUNCTION NAME: RunBenchmark
+   * ------------------------------------------------------------------------------------
+   * @brief Prints how many boards per second every instruction set the CPU has gets
+   *        through, on a block of random boards.
+   *
+   * @details Each instruction set gets the best of several rounds over the block, and its
+   *          results are checked against the scalar loop.
+   *
+   * @throws std::runtime_error if an instruction set finds other winners than the scalar loop.
+   * ------------------------------------------------------------------------------------
+   */
+  void RunBenchmark(size_t board_count) {
+    const int round_count = 20;
+    BoardBlock block;
+    uint64_t random = 0x9e3779b97f4a7c15ull;
+    for (size_t board = 0; board < board_count; ++board) {
+      uint16_t x_mask = 0;
+      uint16_t o_mask = 0;
+      for (int spot = 0; spot < 9; ++spot) {
+        switch (Next(random) % 3) {
+          case 1:
+            x_mask |= static_cast<uint16_t>(1 << spot);
+            break;
+          case 2:
+            o_mask |= static_cast<uint16_t>(1 << spot);
+            break;
+        }
+      }
+      block.Add(x_mask, o_mask);
+    }
+    std::vector<uint8_t> expected(board_count);
+    std::vector<uint8_t> winners(board_count);
+    FindWinners(block.x_masks.data(), block.o_masks.data(), board_count, expected.data(), SCALAR);
+    std::cout << "Win evaluation of " << board_count << " boards:" << std::endl;
+    for (int instruction_set = SCALAR; instruction_set <= BestInstructionSet(); ++instruction_set) {
+      double best_seconds = 0;
+      for (int round = 0; round < round_count; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        FindWinners(block.x_masks.data(), block.o_masks.data(), board_count, winners.data(),
+                    static_cast<InstructionSet>(instruction_set));
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (round == 0 || seconds < best_seconds) {
+          best_seconds = seconds;
+        }
+      }
+      if (winners != expected) {
+        throw std::runtime_error("Error! Batched win evaluation disagrees with the scalar loop.");
+      }
+      std::cout << "  " << InstructionSetName(static_cast<InstructionSet>(instruction_set)) << ": "
+                << board_count / best_seconds / 1e6 << " million boards/s" << std::endl;
+    }
+  }
+}
@@ -0,0 +1,222 @@
+#include "WireProtocol.h"
+#include <cstring>
+
+namespace WireProtocol {
+  namespace {
+    // The English messages of the JSON protocol, indexed by Reply.
+    const char* const REPLY_MESSAGES[REPLY_COUNT] = {
+      "Player X move:",
+      "Your move was a success.",
+      "Spot unavailable. Please try again.",
+      "Server won",
+      "You win",
+      "TIE GAME",
+      "Player O move:",
+      "You play X. Make the first move.",
+      "You are watching a game.",
+      "Player X won",
+      "Player O won",
+      "You ran out of time",
+      "Your seat:",
+      "You are back in your game as X.",
+      "You are back in your game as O."
+    };
+    const int BOARD_SIZE = 3;
+    const int SPOT_COUNT = 9;
+    
+    void AppendBigEndian(std::string& buffer, uint64_t value, int size) {
+      for (int shift = 8 * (size - 1); shift >= 0; shift -= 8) {
+        buffer += static_cast<char>((value >> shift) & 0xff);
+      }
+    }
+    
+    uint64_t GetBigEndian(const unsigned char* bytes, int size) {
+      uint64_t value = 0;
+      for (int index = 0; index < size; ++index) {
+        value = (value << 8) | bytes[index];
+      }
+      return value;
+    }
+  }
+  
+  bool IsProtocol(uint8_t value) {
+    return value == JSON || value == BINARY || value == CBOR || value == MSGPACK;
+  }
+  
+  void AppendWatchHello(std::string& buffer, Protocol protocol, uint32_t game_id) {
+    buffer += static_cast<char>(protocol);
+    for (int shift = 24; shift >= 0; shift -= 8) {
+      buffer += static_cast<char>((game_id >> shift) & 0xff);
+    }
+  }
+  
+  /* ------------------------------------------------------------------------------------
+   * FUNCTION NAME: ParseWatchHello
+   * ------------------------------------------------------------------------------------
+   * @brief Reads the protocol and game ID of a spectator's hello.
+   *
+   * @return True if the payload is a watch hello naming a known protocol, false otherwise.
+   * ------------------------------------------------------------------------------------
+   */
+  bool ParseWatchHello(const char* payload, size_t payload_size, Protocol& protocol, uint32_t& game_id) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(payload);
+    if (payload_size != WATCH_HELLO_SIZE || !IsProtocol(bytes[0])) {
+      return false;
+    }
+    protocol = static_cast<Protocol>(bytes[0]);
+    game_id  = (static_cast<uint32_t>(bytes[1]) << 24) | (static_cast<uint32_t>(bytes[2]) << 16) |
+               (static_cast<uint32_t>(bytes[3]) << 8) | bytes[4];
+    
+    return true;
+  }
+  
+  void AppendRejoinHello(std::string& buffer, Protocol protocol, uint32_t game_id, uint64_t seat_token) {
+    buffer += static_cast<char>(protocol);
+    AppendBigEndian(buffer, game_id, 4);
+    AppendBigEndian(buffer, seat_token, 8);
+  }
+  
+  /* ------------------------------------------------------------------------------------
+   * FUNCTION NAME: ParseRejoinHello
+   * ------------------------------------------------------------------------------------
+   * @brief Reads the protocol, game ID and seat token of a player's rejoin hello.
+   *
+   * @return True if the payload is a rejoin hello naming a known protocol, false otherwise.
+   * ------------------------------------------------------------------------------------
+   */
+  bool ParseRejoinHello(const char* payload, size_t payload_size, Protocol& protocol, uint32_t& game_id,
+                        uint64_t& seat_token) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(payload);
+    if (payload_size != REJOIN_HELLO_SIZE || !IsProtocol(bytes[0])) {
+      return false;
+    }
+    protocol   = static_cast<Protocol>(bytes[0]);
+    game_id    = static_cast<uint32_t>(GetBigEndian(bytes + 1, 4));
+    seat_token = GetBigEndian(bytes + 5, 8);
+    
+    return true;
+  }
+  
+  void AppendSeat(std::string& buffer, uint32_t game_id, uint64_t seat_token) {
+    buffer += static_cast<char>(SEAT);
+    AppendBigEndian(buffer, game_id, 4);
+    AppendBigEndian(buffer, seat_token, 8);
+  }
+  
+  /* ------------------------------------------------------------------------------------
+   * FUNCTION NAME: ParseSeat
+   * ------------------------------------------------------------------------------------
+   * @brief Reads a binary protocol seat message.
+   *
+   * @return True if the payload is a seat message, false otherwise.
+   * ------------------------------------------------------------------------------------
+   */
+  bool ParseSeat(const char* payload, size_t payload_size, uint32_t& game_id, uint64_t& seat_token) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(payload);
+    if (payload_size != SEAT_SIZE || bytes[0] != SEAT) {
+      return false;
+    }
+    game_id    = static_cast<uint32_t>(GetBigEndian(bytes + 1, 4));
+    seat_token = GetBigEndian(bytes + 5, 8);
+    
+    return true;
+  }
+  
+  const char* ReplyMessage(Reply reply) {
+    return REPLY_MESSAGES[reply];
+  }
+  
+  /* ------------------------------------------------------------------------------------
+   * FUNCTION NAME: FindReply
+   * ------------------------------------------------------------------------------------
+   * @brief Looks up the Reply of a JSON protocol status message.
+   *
+   * @return True if the status message is known, false otherwise.
+   * ------------------------------------------------------------------------------------
+   */
+  bool FindReply(const char* status_message, Reply& reply) {
+    for (int index = 0; index < REPLY_COUNT; ++index) {
+      if (strcmp(status_message, REPLY_MESSAGES[index]) == 0) {
+        reply = static_cast<Reply>(index);
+        return true;
+      }
+    }
+    
+    return false;
+  }
+  
+  /* ------------------------------------------------------------------------------------
+   * FUNCTION NAME: UnpackBoard
+   * ------------------------------------------------------------------------------------
+   * @brief Turns a bitboard back into the displayed game board ("X*O\n...").
+   * ------------------------------------------------------------------------------------
+   */
+  std::string UnpackBoard(uint32_t packed_board) {
+    std::string game_board;
+    for (int spot = 0; spot < SPOT_COUNT; ++spot) {
+      if (packed_board & (1u << (SPOT_COUNT + spot))) {
+        game_board += 'X';
+      } else if (packed_board & (1u << spot)) {
+        game_board += 'O';
+      } else {
+        game_board += '*';
+      }
+      if (spot % BOARD_SIZE == BOARD_SIZE - 1) {
+        game_board += '\n';
+      }
+    }
+    
+    return game_board;
+  }
+  
+  void AppendMove(std::string& buffer, int row, int column) {
+    buffer += static_cast<char>((row - 1) * BOARD_SIZE + (column - 1));
+  }
+  
+  /* ------------------------------------------------------------------------------------
+   * FUNCTION NAME: ParseMove
+   * ------------------------------------------------------------------------------------
+   * @brief Reads a binary protocol move into a 1-based row and column number.
+   *
+   * @return True if the payload is a single byte naming a spot, false otherwise.
+   * ------------------------------------------------------------------------------------
+   */
+  bool ParseMove(const char* payload, size_t payload_size, int& row, int& column) {
+    if (payload_size != MOVE_SIZE || static_cast<unsigned char>(payload[0]) >= SPOT_COUNT) {
+      return false;
+    }
+    int spot = static_cast<unsigned char>(payload[0]);
+    row    = spot / BOARD_SIZE + 1;
+    column = spot % BOARD_SIZE + 1;
+    
+    return true;
+  }
+  
+  void AppendReply(std::string& buffer, Reply reply, uint32_t packed_board) {
+    char payload[REPLY_SIZE];
+    payload[0] = static_cast<char>(reply);
+    payload[1] = static_cast<char>((packed_board >> 16) & 0xff);
+    payload[2] = static_cast<char>((packed_board >> 8) & 0xff);
+    payload[3] = static_cast<char>(packed_board & 0xff);
+    buffer.append(payload, REPLY_SIZE);
+  }
+  
+  /* ------------------------------------------------------------------------------------
+   * FUNCTION NAME: ParseReply
+   * ------------------------------------------------------------------------------------
+   * @brief Reads a binary protocol reply.
+   *
+   * @return True if the payload is a well-formed reply, false otherwise.
+   * ------------------------------------------------------------------------------------
+   */
+  bool ParseReply(const char* payload, size_t payload_size, Reply& reply, uint32_t& packed_board) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(payload);
+    if (payload_size != REPLY_SIZE || bytes[0] >= REPLY_COUNT) {
+      return false;
+    }
+    reply        = static_cast<Reply>(bytes[0]);
+    packed_board = (static_cast<uint32_t>(bytes[1]) << 16) | (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+    
+    return true;
+  }
+}
@@ -1,8 +1,67 @@
+#include "GameArchive.h"
 #include "GameServer.h"
+#include "MonteCarloRequestManager.h"
+#include "MoveLog.h"
+#include "PerfectPlayRequestManager.h"
+#include "ReplyTable.h"
+#include "SearchRequestManager.h"
+#include "ServerOptions.h"
+#include "ServerShards.h"
+#include "WinBatch.h"
 #include <iostream>
+#include <memory>
 
 int main(int argc, const char * argv[]) {
+  ServerOptions options = ParseServerOptions(argc, argv);
+  if (options.benchmark_board_count > 0) {
+    WinBatch::RunBenchmark(static_cast<size_t>(options.benchmark_board_count));
+    return EXIT_SUCCESS;
+  }
+  if (options.benchmark_message_count > 0) {
+    ReplyTable::RunBenchmark(static_cast<size_t>(options.benchmark_message_count));
+    return EXIT_SUCCESS;
+  }
+  if (options.benchmark_mcts_milliseconds > 0) {
+    std::chrono::milliseconds search_time(options.benchmark_mcts_milliseconds);
+    Request_Manager::MonteCarloRequestManager::RunBenchmark(search_time);
+    return EXIT_SUCCESS;
+  }
+  if (options.archive_path) {
+    if (options.archive_scan) {
+      GameArchive::RunScan(options.archive_path);
+    } else if (options.replay_game_id >= 0) {
+      GameArchive::RunReplay(options.archive_path, static_cast<uint32_t>(options.replay_game_id));
+    } else if (options.replay_record_number >= 0) {
+      GameArchive::RunReplayRecord(options.archive_path, static_cast<uint64_t>(options.replay_record_number));
+    } else {
+      GameArchive::RunCompact(options.move_log_path, options.archive_path);
+    }
+    return EXIT_SUCCESS;
+  }
+  if (options.perfect_play) {
+    static Request_Manager::PerfectPlayRequestManager perfect_player;
+    GameServer::UseServerPlayer(&perfect_player);
+  } else if (options.search_milliseconds > 0) {
+    static Request_Manager::SearchRequestManager search_player(std::chrono::milliseconds(options.search_milliseconds));
+    GameServer::UseServerPlayer(&search_player);
+  } else if (options.mcts_milliseconds > 0) {
+    static Request_Manager::MonteCarloRequestManager mcts_player(std::chrono::milliseconds(options.mcts_milliseconds),
+                                                                 options.mcts_thread_count);
+    GameServer::UseServerPlayer(&mcts_player);
+  }
+  if (options.event_loop) {
+    ServerShards server_shards(options);
+    server_shards.Run();
+    return EXIT_SUCCESS;
+  }
+  std::unique_ptr<MoveLog> move_log;
   GameServer game_server;
+  if (options.move_log_path) {
+    move_log.reset(new MoveLog(options.move_log_path, options.move_log_sync_milliseconds, 1));
+    game_server.EnableMoveLog(move_log->GetWriter(0));
+  }
+  game_server.EnableTimeouts(std::chrono::milliseconds(options.move_milliseconds),
+                             std::chrono::milliseconds(options.idle_milliseconds));
   game_server.StartListen();
   game_server.LaunchGame();
 